@@ -18,6 +18,7 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include "config.h"
@@ -43,6 +44,7 @@
 #include "modules/video/cga.h"
 #include "modules/video/vga.h"
 #include "debuglog.h"
+#include "fleet.h"
 
 double speedarg = 0;
 
@@ -78,9 +80,10 @@ void args_showHelp() {
 	printf("  -machine <id>          Emulate machine definition defined by <id>. (Default is generic_xt)\r\n");
 	printf("                         Use -machine list to display <id> options.\r\n");
 	printf("  -speed <mhz>           Run the emulated CPU at approximately <mhz> MHz. (Default is as fast as possible)\r\n");
-	printf("                         There is currently no clock ticks counted per instruction, so the emulator is just going\r\n");
-	printf("                         to estimate how many instructions would come out to approximately the desired speed.\r\n");
-	printf("                         There will be more accurate speed-throttling at some point in the future.\r\n\r\n");
+	printf("                         Speed is paced by the clock cycles each instruction takes on the emulated CPU.\r\n");
+	printf("  -cpucore <type>        Use <type> (threaded, switch or jit) CPU core. (Default is threaded)\r\n");
+	printf("                         The threaded core is only available in GCC/Clang builds, others always use switch.\r\n");
+	printf("                         The jit core translates hot code to native x86-64 code and needs an x86-64 build.\r\n\r\n");
 
 	printf("Disk options:\r\n");
 	printf("  -fd0 <file>            Insert <file> disk image as floppy 0.\r\n");
@@ -128,12 +131,21 @@ void args_showHelp() {
 	printf("                         available to guest system at base port 0x300, IRQ 2.\r\n\r\n");
 #endif
 
+	printf("Fleet options:\r\n");
+	printf("  -fleet <count>         Boot a template machine, then fork <count> worker processes from it when the\r\n");
+	printf("                         guest writes to the fleet port. Workers share guest memory copy-on-write, run\r\n");
+	printf("                         without a window and write disk changes to <image>.fleet<n> overlay files.\r\n");
+	printf("                         A worker exits when the guest writes to the fleet port again, the value\r\n");
+	printf("                         written being the exit code. (Needs fork(), not available on Windows)\r\n");
+	printf("  -fleetport <port>      Use I/O <port> as the fleet port. (Default is 0xE9)\r\n");
+	printf("  -fleetjobs <file>      Type line <n> of <file> followed by Enter into worker <n>'s keyboard buffer.\r\n\r\n");
+
 	printf("Miscellaneous options:\r\n");
 	printf("  -mem <size>            Initialize emulator with only <size> KB of base memory. (Default is 640)\r\n");
 	printf("                         The maximum size is 736 KB, but this can only work with CGA video and a\r\n");
 	printf("                         system BIOS that will test beyond 640 KB.\r\n");
 	printf("  -debug <level>         <level> can be: NONE, ERROR, INFO, DETAIL. (Default is INFO)\r\n");
-	printf("  -mips                  Display live MIPS being emulated.\r\n");
+	printf("  -mips                  Display live MIPS and clock speed being emulated.\r\n");
 	printf("  -h                     Show this help screen.\r\n");
 }
 
@@ -171,43 +183,64 @@ int args_parse(MACHINE_t* machine, int argc, char* argv[]) {
 			}
 			speedarg = atof(argv[++i]);
 		}
+		else if (args_isMatch(argv[i], "-cpucore")) {
+			if ((i + 1) == argc) {
+				printf("Parameter required for -cpucore. Use -h for help.\r\n");
+				return -1;
+			}
+			if (args_isMatch(argv[i + 1], "threaded")) machine->CPU.core = CPU_CORE_THREADED;
+			else if (args_isMatch(argv[i + 1], "switch")) machine->CPU.core = CPU_CORE_SWITCH;
+			else if (args_isMatch(argv[i + 1], "jit")) {
+#ifdef CPU_JIT
+				machine->CPU.core = CPU_CORE_JIT;
+#else
+				printf("The jit CPU core isn't available in this build, using threaded\r\n");
+				machine->CPU.core = CPU_CORE_THREADED;
+#endif
+			}
+			else {
+				printf("%s is an invalid CPU core option\r\n", argv[i + 1]);
+				return -1;
+			}
+			i++;
+		}
 		else if (args_isMatch(argv[i], "-fd0")) {
 			if ((i + 1) == argc) {
 				printf("Parameter required for -fd0. Use -h for help.\r\n");
 				return -1;
 			}
-			biosdisk_insert(&machine->CPU, 0, argv[++i]);
+			biosdisk_insert(&machine->biosdisk, &machine->CPU, 0, argv[++i]);
 		}
 		else if (args_isMatch(argv[i], "-fd1")) {
 			if ((i + 1) == argc) {
 				printf("Parameter required for -fd1. Use -h for help.\r\n");
 				return -1;
 			}
-			biosdisk_insert(&machine->CPU, 1, argv[++i]);
+			biosdisk_insert(&machine->biosdisk, &machine->CPU, 1, argv[++i]);
 		}
 		else if (args_isMatch(argv[i], "-hd0")) {
 			if ((i + 1) == argc) {
 				printf("Parameter required for -hd0. Use -h for help.\r\n");
 				return -1;
 			}
-			biosdisk_insert(&machine->CPU, 2, argv[++i]);
+			biosdisk_insert(&machine->biosdisk, &machine->CPU, 2, argv[++i]);
 		}
 		else if (args_isMatch(argv[i], "-hd1")) {
 			if ((i + 1) == argc) {
 				printf("Parameter required for -hd1. Use -h for help.\r\n");
 				return -1;
 			}
-			biosdisk_insert(&machine->CPU, 3, argv[++i]);
+			biosdisk_insert(&machine->biosdisk, &machine->CPU, 3, argv[++i]);
 		}
 		else if (args_isMatch(argv[i], "-boot")) {
 			if ((i + 1) == argc) {
 				printf("Parameter required for -boot. Use -h for help.\r\n");
 				return -1;
 			}
-			if (args_isMatch(argv[i + 1], "fd0")) bootdrive = 0x00;
-			else if (args_isMatch(argv[i + 1], "fd1")) bootdrive = 0x01;
-			else if (args_isMatch(argv[i + 1], "hd0")) bootdrive = 0x80;
-			else if (args_isMatch(argv[i + 1], "hd1")) bootdrive = 0x81;
+			if (args_isMatch(argv[i + 1], "fd0")) machine->biosdisk.bootdrive = 0x00;
+			else if (args_isMatch(argv[i + 1], "fd1")) machine->biosdisk.bootdrive = 0x01;
+			else if (args_isMatch(argv[i + 1], "hd0")) machine->biosdisk.bootdrive = 0x80;
+			else if (args_isMatch(argv[i + 1], "hd1")) machine->biosdisk.bootdrive = 0x81;
 			else {
 				printf("%s is an invalid boot option\r\n", argv[i + 1]);
 				return -1;
@@ -264,6 +297,27 @@ int args_parse(MACHINE_t* machine, int argc, char* argv[]) {
 			}
 			i++;
 		}
+		else if (args_isMatch(argv[i], "-fleet")) {
+			if ((i + 1) == argc) {
+				printf("Parameter required for -fleet. Use -h for help.\r\n");
+				return -1;
+			}
+			fleet_workers = atol(argv[++i]);
+		}
+		else if (args_isMatch(argv[i], "-fleetport")) {
+			if ((i + 1) == argc) {
+				printf("Parameter required for -fleetport. Use -h for help.\r\n");
+				return -1;
+			}
+			fleet_port = (uint16_t)strtol(argv[++i], NULL, 0);
+		}
+		else if (args_isMatch(argv[i], "-fleetjobs")) {
+			if ((i + 1) == argc) {
+				printf("Parameter required for -fleetjobs. Use -h for help.\r\n");
+				return -1;
+			}
+			fleet_jobfile = argv[++i];
+		}
 		else if (args_isMatch(argv[i], "-mips")) {
 			showMIPS = 1;
 		}
@@ -306,20 +360,20 @@ int args_parse(MACHINE_t* machine, int argc, char* argv[]) {
 				else {
 					port = (uint16_t)atol(argv[++i]);
 				}
-				uart_init(&machine->UART[uartnum], &machine->i8259, base, irq, (void*)tcpmodem_tx, &machine->tcpmodem[uartnum], NULL, NULL);
-				tcpmodem_init(&machine->tcpmodem[uartnum], &machine->UART[uartnum], port);
-				timing_addTimer(tcpmodem_rxpoll, &machine->tcpmodem[uartnum], baudrate / 9, TIMING_ENABLED);
+				uart_init(&machine->UART[uartnum], &machine->i8259, &machine->ports, base, irq, (void*)tcpmodem_tx, &machine->tcpmodem[uartnum], NULL, NULL);
+				tcpmodem_init(&machine->tcpmodem[uartnum], &machine->UART[uartnum], &machine->timing, port);
+				timing_addTimer(&machine->timing, tcpmodem_rxpoll, &machine->tcpmodem[uartnum], baudrate / 9, TIMING_ENABLED);
 			} else
 #endif
 				if (args_isMatch(argv[i + 1], "mouse")) {
 				i++;
-				uart_init(&machine->UART[uartnum], &machine->i8259, base, irq, NULL, NULL, (void*)mouse_togglereset, NULL);
-				mouse_init(&machine->UART[uartnum]);
-				timing_addTimer(mouse_rxpoll, NULL, baudrate / 9, TIMING_ENABLED);
+				uart_init(&machine->UART[uartnum], &machine->i8259, &machine->ports, base, irq, NULL, NULL, (void*)mouse_togglereset, &machine->mouse);
+				mouse_init(&machine->mouse, &machine->UART[uartnum]);
+				timing_addTimer(&machine->timing, mouse_rxpoll, &machine->mouse, baudrate / 9, TIMING_ENABLED);
 			}
 			else if (args_isMatch(argv[i + 1], "none")) {
 				i++;
-				uart_init(&machine->UART[uartnum], &machine->i8259, base, irq, NULL, NULL, NULL, NULL);
+				uart_init(&machine->UART[uartnum], &machine->i8259, &machine->ports, base, irq, NULL, NULL, NULL, NULL);
 			}
 			else {
 				printf("%s is not a valid parameter for -uart%u. Use -h for help.\r\n", argv[i + 1], uartnum);
@@ -227,9 +227,9 @@ void i8237_write(I8237_t* i8237, uint8_t ch, uint8_t value) {
 	}
 }
 
-void i8237_init(I8237_t* i8237, CPU_t* cpu) {
+void i8237_init(I8237_t* i8237, CPU_t* cpu, PORTS_t* ports) {
 	i8237_reset(i8237);
 
-	ports_cbRegister(0x00, 16, (void*)i8237_readport, NULL, (void*)i8237_writeport, NULL, i8237);
-	ports_cbRegister(0x80, 16, (void*)i8237_readpage, NULL, (void*)i8237_writepage, NULL, i8237);
+	ports_cbRegister(ports, 0x00, 16, (void*)i8237_readport, NULL, (void*)i8237_writeport, NULL, i8237);
+	ports_cbRegister(ports, 0x80, 16, (void*)i8237_readpage, NULL, (void*)i8237_writepage, NULL, i8237);
 }
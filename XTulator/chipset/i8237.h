@@ -39,6 +39,6 @@ void i8237_writeport(I8237_t* i8237, uint16_t addr, uint8_t value);
 uint8_t i8237_readport(I8237_t* i8237, uint16_t addr);
 uint8_t i8237_read(I8237_t* i8237, uint8_t ch);
 void i8237_write(I8237_t* i8237, uint8_t ch, uint8_t value);
-void i8237_init(I8237_t* i8237, CPU_t* cpu);
+void i8237_init(I8237_t* i8237, CPU_t* cpu, PORTS_t* ports);
 
 #endif
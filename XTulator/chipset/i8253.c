@@ -32,8 +32,6 @@
 #include "../ports.h"
 #include "../debuglog.h"
 
-uint32_t i8253_timers[3];
-
 void i8253_write(I8253_t* i8253, uint16_t portnum, uint8_t value) {
 	uint8_t sel, rl, loaded;
 	portnum &= 3;
@@ -189,14 +187,14 @@ void i8253_tickCallback(I8253CB_t* i8253cb) {
 	}
 }
 
-void i8253_init(I8253_t* i8253, I8259_t* i8259, PCSPEAKER_t* pcspeaker) {
+void i8253_init(I8253_t* i8253, I8259_t* i8259, PCSPEAKER_t* pcspeaker, PORTS_t* ports, TIMING_t* timing) {
 	memset(i8253, 0, sizeof(I8253_t));
 
 	i8253->cbdata.i8253 = i8253;
 	i8253->cbdata.i8259 = i8259;
 	i8253->cbdata.pcspeaker = pcspeaker;
 
-	timing_addTimer(i8253_tickCallback, (void*)(&i8253->cbdata), 48000, TIMING_ENABLED); //79545.47
+	timing_addTimer(timing, i8253_tickCallback, (void*)(&i8253->cbdata), 48000, TIMING_ENABLED); //79545.47
 
-	ports_cbRegister(0x40, 4, (void*)i8253_read, NULL, (void*)i8253_write, NULL, i8253);
+	ports_cbRegister(ports, 0x40, 4, (void*)i8253_read, NULL, (void*)i8253_write, NULL, i8253);
 }
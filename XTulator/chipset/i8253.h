@@ -22,6 +22,8 @@
 
 #include <stdint.h>
 #include "i8259.h"
+#include "../ports.h"
+#include "../timing.h"
 #include "../modules/audio/pcspeaker.h"
 
 #define PIT_MODE_LATCHCOUNT	0
@@ -56,6 +58,6 @@ typedef struct {
 
 void i8253_write(I8253_t* i8253, uint16_t portnum, uint8_t value);
 uint8_t i8253_read(I8253_t* i8253, uint16_t portnum);
-void i8253_init(I8253_t* i8253, I8259_t* i8259, PCSPEAKER_t* pcspeaker);
+void i8253_init(I8253_t* i8253, I8259_t* i8259, PCSPEAKER_t* pcspeaker, PORTS_t* ports, TIMING_t* timing);
 
 #endif
@@ -94,7 +94,7 @@ void i8255_refreshToggle(I8255_t* i8255) {
 	i8255->portB ^= 0x10; //simulate DRAM refresh toggle, many BIOSes require this...
 }
 
-void i8255_init(I8255_t* i8255, KEYSTATE_t* keystate, PCSPEAKER_t* pcspeaker) {
+void i8255_init(I8255_t* i8255, KEYSTATE_t* keystate, PCSPEAKER_t* pcspeaker, PORTS_t* ports, TIMING_t* timing) {
 	memset(i8255, 0, sizeof(I8255_t));
 	i8255->keystate = keystate;
 	i8255->pcspeaker = pcspeaker;
@@ -106,6 +106,6 @@ void i8255_init(I8255_t* i8255, KEYSTATE_t* keystate, PCSPEAKER_t* pcspeaker) {
 		i8255->sw2 = 0x66;
 	}
 
-	ports_cbRegister(0x60, 6, (void*)i8255_readport, NULL, (void*)i8255_writeport, NULL, i8255);
-	timing_addTimer(i8255_refreshToggle, i8255, 66667, TIMING_ENABLED);
+	ports_cbRegister(ports, 0x60, 6, (void*)i8255_readport, NULL, (void*)i8255_writeport, NULL, i8255);
+	timing_addTimer(timing, i8255_refreshToggle, i8255, 66667, TIMING_ENABLED);
 }
@@ -2,6 +2,8 @@
 #define _I8255_H_
 
 #include <stdint.h>
+#include "../ports.h"
+#include "../timing.h"
 #include "../modules/audio/pcspeaker.h"
 #include "../modules/input/input.h"
 
@@ -16,6 +18,6 @@ typedef struct {
 
 uint8_t i8255_readport(I8255_t* i8255, uint16_t portnum);
 void i8255_writeport(I8255_t* i8255, uint16_t portnum, uint8_t value);
-void i8255_init(I8255_t* i8255, KEYSTATE_t* keystate, PCSPEAKER_t* pcspeaker);
+void i8255_init(I8255_t* i8255, KEYSTATE_t* keystate, PCSPEAKER_t* pcspeaker, PORTS_t* ports, TIMING_t* timing);
 
 #endif
@@ -28,6 +28,13 @@
 #include "i8259.h"
 #include "../ports.h"
 
+//drive the CPU's INTR line from the request and mask registers
+void i8259_update(I8259_t* i8259) {
+	if (i8259->intr != NULL) {
+		*i8259->intr = (i8259->irr & (~i8259->imr)) ? 1 : 0;
+	}
+}
+
 uint8_t i8259_read(I8259_t* i8259, uint16_t portnum) {
 #ifdef DEBUG_PIC
 	debug_log(DEBUG_DETAIL, "[I8259] Read port 0x%X\n", portnum);
@@ -128,6 +135,7 @@ void i8259_write(I8259_t* i8259, uint16_t portnum, uint8_t value) {
 		}
 		break;
 	}
+	i8259_update(i8259);
 }
 
 uint8_t i8259_nextintr(I8259_t* i8259) {
@@ -137,6 +145,7 @@ uint8_t i8259_nextintr(I8259_t* i8259) {
 		if ((tmpirr >> i) & 1) {
 			i8259->irr &= ~(1 << i);
 			i8259->isr |= (1 << i);
+			i8259_update(i8259);
 			return(i8259->icw[2] + i);
 		}
 	return 0;
@@ -147,10 +156,16 @@ void i8259_doirq(I8259_t* i8259, uint8_t irqnum) {
 	debug_log(DEBUG_DETAIL, "[I8259] IRQ %u raised\r\n", irqnum);
 #endif
 	i8259->irr |= (1 << irqnum) & (~i8259->imr);
+	i8259_update(i8259);
 }
 
-void i8259_init(I8259_t* i8259) {
+void i8259_init(I8259_t* i8259, PORTS_t* ports) {
 	memset(i8259, 0, sizeof(I8259_t));
 	i8259->intoffset = 8;
-	ports_cbRegister(0x20, 2, (void*)i8259_read, NULL, (void*)i8259_write, NULL, i8259);
+	ports_cbRegister(ports, 0x20, 2, (void*)i8259_read, NULL, (void*)i8259_write, NULL, i8259);
+}
+
+void i8259_connect(I8259_t* i8259, uint8_t* intr) {
+	i8259->intr = intr;
+	i8259_update(i8259);
 }
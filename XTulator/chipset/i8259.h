@@ -21,6 +21,7 @@
 #define _I8259_H_
 
 #include <stdint.h>
+#include "../ports.h"
 
 typedef struct {
 	uint8_t imr; //mask register
@@ -36,9 +37,11 @@ typedef struct {
 	uint8_t vector;
 	uint8_t lastintr;
 	uint8_t enabled;
+	uint8_t* intr; //INTR input of the CPU, held high while an unmasked request is waiting
 } I8259_t;
 
-void i8259_init(I8259_t* i8259);
+void i8259_init(I8259_t* i8259, PORTS_t* ports);
+void i8259_connect(I8259_t* i8259, uint8_t* intr);
 void i8259_doirq(I8259_t* i8259, uint8_t irqnum);
 uint8_t i8259_nextintr(I8259_t* i8259);
 void i8259_write(I8259_t* i8259, uint16_t portnum, uint8_t value);
@@ -170,7 +170,7 @@ void uart_rxdata(UART_t* uart, uint8_t value) {
 	}
 }
 
-void uart_init(UART_t* uart, I8259_t* i8259, uint16_t base, uint8_t irq, void (*tx)(void*, uint8_t), void* udata, void (*mcr)(void*, uint8_t), void* udata2) {
+void uart_init(UART_t* uart, I8259_t* i8259, PORTS_t* ports, uint16_t base, uint8_t irq, void (*tx)(void*, uint8_t), void* udata, void (*mcr)(void*, uint8_t), void* udata2) {
 	debug_log(DEBUG_INFO, "[UART] Initializing 8250 UART at base port 0x%03X, IRQ %u\r\n", base, irq);
 	memset(uart, 0, sizeof(UART_t));
 	uart->i8259 = i8259;
@@ -180,5 +180,5 @@ void uart_init(UART_t* uart, I8259_t* i8259, uint16_t base, uint8_t irq, void (*
 	uart->udata2 = udata2;
 	uart->mcrCb = mcr;
 	uart->msr = 0x30;
-	ports_cbRegister(base, 8, (void*)uart_readport, NULL, (void*)uart_writeport, NULL, uart);
+	ports_cbRegister(ports, base, 8, (void*)uart_readport, NULL, (void*)uart_writeport, NULL, uart);
 }
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "i8259.h"
+#include "../ports.h"
 
 #define UART_IRQ_MSR_ENABLE			0x08
 #define UART_IRQ_LSR_ENABLE			0x04
@@ -40,6 +41,6 @@ typedef struct {
 void uart_writeport(UART_t* uart, uint16_t addr, uint8_t value);
 uint8_t uart_readport(UART_t* uart, uint16_t addr);
 void uart_rxdata(UART_t* uart, uint8_t value);
-void uart_init(UART_t* uart, I8259_t* i8259, uint16_t base, uint8_t irq, void (*tx)(void*, uint8_t), void* udata, void (*mcr)(void*, uint8_t), void* udata2);
+void uart_init(UART_t* uart, I8259_t* i8259, PORTS_t* ports, uint16_t base, uint8_t irq, void (*tx)(void*, uint8_t), void* udata, void (*mcr)(void*, uint8_t), void* udata2);
 
 #endif
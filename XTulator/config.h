@@ -56,7 +56,6 @@ extern double speedarg;
 extern volatile double speed;
 extern uint32_t baudrate, ramsize;
 extern char* usemachine;
-extern uint8_t bootdrive;
 
 void setspeed(double mhz);
 
@@ -19,9 +19,13 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include "cpu.h"
+#include "cpujit.h"
 #include "../config.h"
 #include "../debuglog.h"
+#include "../memory.h"
 
 const uint8_t byteregtable[8] = { regal, regcl, regdl, regbl, regah, regch, regdh, regbh };
 
@@ -36,12 +40,39 @@ const uint8_t parity[0x100] = {
 	0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1
 };
 
+/*
+	Words that don't straddle a 256 byte code page, and so also not a memory map page, are
+	accessed through the page's host pointer in one go when it's plain memory. Anything else,
+	MMIO and words at the end of a page or of the address space, goes a byte at a time.
+*/
 FUNC_INLINE void cpu_writew(CPU_t* cpu, uint32_t addr32, uint16_t value) {
+	uint8_t* host;
+
+	addr32 &= MEMORY_MASK;
+	if (((addr32 & ((1 << MEMORY_CODE_SHIFT) - 1)) != ((1 << MEMORY_CODE_SHIFT) - 1)) && !cpu->memory->codePage[addr32 >> MEMORY_CODE_SHIFT]) {
+		host = cpu->memory->pageWrite[addr32 >> MEMORY_PAGE_SHIFT];
+		if (host != NULL) {
+			host += addr32 & MEMORY_PAGE_MASK;
+			host[0] = (uint8_t)value;
+			host[1] = (uint8_t)(value >> 8);
+			return;
+		}
+	}
 	cpu_write(cpu, addr32, (uint8_t)value);
 	cpu_write(cpu, addr32 + 1, (uint8_t)(value >> 8));
 }
 
 FUNC_INLINE uint16_t cpu_readw(CPU_t* cpu, uint32_t addr32) {
+	uint8_t* host;
+
+	addr32 &= MEMORY_MASK;
+	if ((addr32 & MEMORY_PAGE_MASK) != MEMORY_PAGE_MASK) {
+		host = cpu->memory->pageRead[addr32 >> MEMORY_PAGE_SHIFT];
+		if (host != NULL) {
+			host += addr32 & MEMORY_PAGE_MASK;
+			return (uint16_t)host[0] | ((uint16_t)host[1] << 8);
+		}
+	}
 	return ((uint16_t)cpu_read(cpu, addr32) | (uint16_t)(cpu_read(cpu, addr32 + 1) << 8));
 }
 
@@ -81,257 +112,188 @@ FUNC_INLINE void flag_szp16(CPU_t* cpu, uint16_t value) {
 	cpu->pf = parity[value & 255];	/* retrieve parity state from lookup table */
 }
 
-FUNC_INLINE void flag_log8(CPU_t* cpu, uint8_t value) {
-	flag_szp8(cpu, value);
-	cpu->cf = 0;
-	cpu->of = 0; /* bitwise logic ops always clear carry and overflow */
-}
-
-FUNC_INLINE void flag_log16(CPU_t* cpu, uint16_t value) {
-	flag_szp16(cpu, value);
-	cpu->cf = 0;
-	cpu->of = 0; /* bitwise logic ops always clear carry and overflow */
+/*
+	The arithmetic flags are lazy: ALU ops only record what they did in flagop, flagop1, flagop2
+	and flagres, and each flag is worked out from those when something reads it. Anything that
+	reads or writes cf, pf, af, zf, sf or of directly has to call flag_sync first.
+*/
+FUNC_INLINE uint8_t flag_getcf(CPU_t* cpu) {
+	switch (cpu->flagop) {
+	case CPU_FLAGS_ADD8:
+	case CPU_FLAGS_SUB8:
+		return (cpu->flagres >> 8) & 1;
+	case CPU_FLAGS_ADD16:
+	case CPU_FLAGS_SUB16:
+		return (cpu->flagres >> 16) & 1;
+	case CPU_FLAGS_LOG8:
+	case CPU_FLAGS_LOG16:
+		return 0;
+	default:
+		return cpu->cf;
+	}
 }
 
-FUNC_INLINE void flag_adc8(CPU_t* cpu, uint8_t v1, uint8_t v2, uint8_t v3) {
-
-	/* v1 = destination operand, v2 = source operand, v3 = carry flag */
-	uint16_t	dst;
-
-	dst = (uint16_t)v1 + (uint16_t)v2 + (uint16_t)v3;
-	flag_szp8(cpu, (uint8_t)dst);
-	if (((dst ^ v1) & (dst ^ v2) & 0x80) == 0x80) {
-		cpu->of = 1;
-	}
-	else {
-		cpu->of = 0; /* set or clear overflow flag */
+FUNC_INLINE uint8_t flag_getzf(CPU_t* cpu) {
+	if (cpu->flagop == CPU_FLAGS_NONE) {
+		return cpu->zf;
 	}
+	return (cpu->flagop & 1) ? ((cpu->flagres & 0xFF) == 0) : ((cpu->flagres & 0xFFFF) == 0);
+}
 
-	if (dst & 0xFF00) {
-		cpu->cf = 1;
-	}
-	else {
-		cpu->cf = 0; /* set or clear carry flag */
+FUNC_INLINE uint8_t flag_getsf(CPU_t* cpu) {
+	if (cpu->flagop == CPU_FLAGS_NONE) {
+		return cpu->sf;
 	}
+	return (cpu->flagres >> ((cpu->flagop & 1) ? 7 : 15)) & 1;
+}
 
-	if (((v1 ^ v2 ^ dst) & 0x10) == 0x10) {
-		cpu->af = 1;
-	}
-	else {
-		cpu->af = 0; /* set or clear auxilliary flag */
+FUNC_INLINE uint8_t flag_getpf(CPU_t* cpu) {
+	if (cpu->flagop == CPU_FLAGS_NONE) {
+		return cpu->pf;
 	}
+	return parity[cpu->flagres & 0xFF];
 }
 
-FUNC_INLINE void flag_adc16(CPU_t* cpu, uint16_t v1, uint16_t v2, uint16_t v3) {
-
-	uint32_t	dst;
-
-	dst = (uint32_t)v1 + (uint32_t)v2 + (uint32_t)v3;
-	flag_szp16(cpu, (uint16_t)dst);
-	if ((((dst ^ v1) & (dst ^ v2)) & 0x8000) == 0x8000) {
-		cpu->of = 1;
-	}
-	else {
-		cpu->of = 0;
+FUNC_INLINE uint8_t flag_getof(CPU_t* cpu) {
+	switch (cpu->flagop) {
+	case CPU_FLAGS_NONE:
+		return cpu->of;
+	case CPU_FLAGS_ADD8:
+	case CPU_FLAGS_INC8:
+		return (((cpu->flagres ^ cpu->flagop1) & (cpu->flagres ^ cpu->flagop2)) >> 7) & 1;
+	case CPU_FLAGS_ADD16:
+	case CPU_FLAGS_INC16:
+		return (((cpu->flagres ^ cpu->flagop1) & (cpu->flagres ^ cpu->flagop2)) >> 15) & 1;
+	case CPU_FLAGS_SUB8:
+	case CPU_FLAGS_DEC8:
+		return (((cpu->flagres ^ cpu->flagop1) & (cpu->flagop1 ^ cpu->flagop2)) >> 7) & 1;
+	case CPU_FLAGS_SUB16:
+	case CPU_FLAGS_DEC16:
+		return (((cpu->flagres ^ cpu->flagop1) & (cpu->flagop1 ^ cpu->flagop2)) >> 15) & 1;
+	default:
+		return 0;
 	}
+}
 
-	if (dst & 0xFFFF0000) {
-		cpu->cf = 1;
-	}
-	else {
-		cpu->cf = 0;
+FUNC_INLINE uint8_t flag_getaf(CPU_t* cpu) {
+	switch (cpu->flagop) {
+	case CPU_FLAGS_NONE:
+	case CPU_FLAGS_LOG8:
+	case CPU_FLAGS_LOG16:
+		return cpu->af;
+	default:
+		return ((cpu->flagop1 ^ cpu->flagop2 ^ cpu->flagres) >> 4) & 1;
 	}
+}
 
-	if (((v1 ^ v2 ^ dst) & 0x10) == 0x10) {
-		cpu->af = 1;
-	}
-	else {
-		cpu->af = 0;
+/* store every flag in its field */
+FUNC_INLINE void flag_sync(CPU_t* cpu) {
+	if (cpu->flagop == CPU_FLAGS_NONE) {
+		return;
 	}
+	cpu->cf = flag_getcf(cpu);
+	cpu->pf = flag_getpf(cpu);
+	cpu->af = flag_getaf(cpu);
+	cpu->zf = flag_getzf(cpu);
+	cpu->sf = flag_getsf(cpu);
+	cpu->of = flag_getof(cpu);
+	cpu->flagop = CPU_FLAGS_NONE;
 }
 
-FUNC_INLINE void flag_add8(CPU_t* cpu, uint8_t v1, uint8_t v2) {
-	/* v1 = destination operand, v2 = source operand */
-	uint16_t	dst;
+void cpu_flagsSync(CPU_t* cpu) {
+	flag_sync(cpu);
+}
 
-	dst = (uint16_t)v1 + (uint16_t)v2;
-	flag_szp8(cpu, (uint8_t)dst);
-	if (dst & 0xFF00) {
-		cpu->cf = 1;
-	}
-	else {
-		cpu->cf = 0;
-	}
+FUNC_INLINE void flag_lazy(CPU_t* cpu, uint8_t op, uint32_t v1, uint32_t v2, uint32_t dst) {
+	cpu->flagop = op;
+	cpu->flagop1 = v1;
+	cpu->flagop2 = v2;
+	cpu->flagres = dst;
+}
 
-	if (((dst ^ v1) & (dst ^ v2) & 0x80) == 0x80) {
-		cpu->of = 1;
-	}
-	else {
-		cpu->of = 0;
-	}
+FUNC_INLINE void flag_log8(CPU_t* cpu, uint8_t value) {
+	cpu->af = flag_getaf(cpu); /* bitwise logic ops always clear carry and overflow, and leave AF alone */
+	flag_lazy(cpu, CPU_FLAGS_LOG8, 0, 0, value);
+}
 
-	if (((v1 ^ v2 ^ dst) & 0x10) == 0x10) {
-		cpu->af = 1;
-	}
-	else {
-		cpu->af = 0;
-	}
+FUNC_INLINE void flag_log16(CPU_t* cpu, uint16_t value) {
+	cpu->af = flag_getaf(cpu);
+	flag_lazy(cpu, CPU_FLAGS_LOG16, 0, 0, value);
 }
 
-FUNC_INLINE void flag_add16(CPU_t* cpu, uint16_t v1, uint16_t v2) {
-	/* v1 = destination operand, v2 = source operand */
-	uint32_t	dst;
+FUNC_INLINE void flag_adc8(CPU_t* cpu, uint8_t v1, uint8_t v2, uint8_t v3) {
+	/* v1 = destination operand, v2 = source operand, v3 = carry flag */
+	flag_lazy(cpu, CPU_FLAGS_ADD8, v1, v2, (uint32_t)v1 + (uint32_t)v2 + (uint32_t)v3);
+}
 
-	dst = (uint32_t)v1 + (uint32_t)v2;
-	flag_szp16(cpu, (uint16_t)dst);
-	if (dst & 0xFFFF0000) {
-		cpu->cf = 1;
-	}
-	else {
-		cpu->cf = 0;
-	}
+FUNC_INLINE void flag_adc16(CPU_t* cpu, uint16_t v1, uint16_t v2, uint16_t v3) {
+	flag_lazy(cpu, CPU_FLAGS_ADD16, v1, v2, (uint32_t)v1 + (uint32_t)v2 + (uint32_t)v3);
+}
 
-	if (((dst ^ v1) & (dst ^ v2) & 0x8000) == 0x8000) {
-		cpu->of = 1;
-	}
-	else {
-		cpu->of = 0;
-	}
+FUNC_INLINE void flag_add8(CPU_t* cpu, uint8_t v1, uint8_t v2) {
+	/* v1 = destination operand, v2 = source operand */
+	flag_lazy(cpu, CPU_FLAGS_ADD8, v1, v2, (uint32_t)v1 + (uint32_t)v2);
+}
 
-	if (((v1 ^ v2 ^ dst) & 0x10) == 0x10) {
-		cpu->af = 1;
-	}
-	else {
-		cpu->af = 0;
-	}
+FUNC_INLINE void flag_add16(CPU_t* cpu, uint16_t v1, uint16_t v2) {
+	flag_lazy(cpu, CPU_FLAGS_ADD16, v1, v2, (uint32_t)v1 + (uint32_t)v2);
 }
 
 FUNC_INLINE void flag_sbb8(CPU_t* cpu, uint8_t v1, uint8_t v2, uint8_t v3) {
-
 	/* v1 = destination operand, v2 = source operand, v3 = carry flag */
-	uint16_t	dst;
-
 	v2 += v3;
-	dst = (uint16_t)v1 - (uint16_t)v2;
-	flag_szp8(cpu, (uint8_t)dst);
-	if (dst & 0xFF00) {
-		cpu->cf = 1;
-	}
-	else {
-		cpu->cf = 0;
-	}
-
-	if ((dst ^ v1) & (v1 ^ v2) & 0x80) {
-		cpu->of = 1;
-	}
-	else {
-		cpu->of = 0;
-	}
-
-	if ((v1 ^ v2 ^ dst) & 0x10) {
-		cpu->af = 1;
-	}
-	else {
-		cpu->af = 0;
-	}
+	flag_lazy(cpu, CPU_FLAGS_SUB8, v1, v2, (uint32_t)v1 - (uint32_t)v2);
 }
 
 FUNC_INLINE void flag_sbb16(CPU_t* cpu, uint16_t v1, uint16_t v2, uint16_t v3) {
-
-	/* v1 = destination operand, v2 = source operand, v3 = carry flag */
-	uint32_t	dst;
-
 	v2 += v3;
-	dst = (uint32_t)v1 - (uint32_t)v2;
-	flag_szp16(cpu, (uint16_t)dst);
-	if (dst & 0xFFFF0000) {
-		cpu->cf = 1;
-	}
-	else {
-		cpu->cf = 0;
-	}
-
-	if ((dst ^ v1) & (v1 ^ v2) & 0x8000) {
-		cpu->of = 1;
-	}
-	else {
-		cpu->of = 0;
-	}
-
-	if ((v1 ^ v2 ^ dst) & 0x10) {
-		cpu->af = 1;
-	}
-	else {
-		cpu->af = 0;
-	}
+	flag_lazy(cpu, CPU_FLAGS_SUB16, v1, v2, (uint32_t)v1 - (uint32_t)v2);
 }
 
 FUNC_INLINE void flag_sub8(CPU_t* cpu, uint8_t v1, uint8_t v2) {
-
 	/* v1 = destination operand, v2 = source operand */
-	uint16_t	dst;
-
-	dst = (uint16_t)v1 - (uint16_t)v2;
-	flag_szp8(cpu, (uint8_t)dst);
-	if (dst & 0xFF00) {
-		cpu->cf = 1;
-	}
-	else {
-		cpu->cf = 0;
-	}
-
-	if ((dst ^ v1) & (v1 ^ v2) & 0x80) {
-		cpu->of = 1;
-	}
-	else {
-		cpu->of = 0;
-	}
-
-	if ((v1 ^ v2 ^ dst) & 0x10) {
-		cpu->af = 1;
-	}
-	else {
-		cpu->af = 0;
-	}
+	flag_lazy(cpu, CPU_FLAGS_SUB8, v1, v2, (uint32_t)v1 - (uint32_t)v2);
 }
 
 FUNC_INLINE void flag_sub16(CPU_t* cpu, uint16_t v1, uint16_t v2) {
+	flag_lazy(cpu, CPU_FLAGS_SUB16, v1, v2, (uint32_t)v1 - (uint32_t)v2);
+}
 
-	/* v1 = destination operand, v2 = source operand */
-	uint32_t	dst;
+/* INC and DEC don't change the carry flag */
+FUNC_INLINE void op_inc8(CPU_t* cpu) {
+	cpu->res8 = cpu->oper1b + 1;
+	cpu->cf = flag_getcf(cpu);
+	flag_lazy(cpu, CPU_FLAGS_INC8, cpu->oper1b, 1, (uint32_t)cpu->oper1b + 1);
+}
 
-	dst = (uint32_t)v1 - (uint32_t)v2;
-	flag_szp16(cpu, (uint16_t)dst);
-	if (dst & 0xFFFF0000) {
-		cpu->cf = 1;
-	}
-	else {
-		cpu->cf = 0;
-	}
+FUNC_INLINE void op_inc16(CPU_t* cpu) {
+	cpu->res16 = cpu->oper1 + 1;
+	cpu->cf = flag_getcf(cpu);
+	flag_lazy(cpu, CPU_FLAGS_INC16, cpu->oper1, 1, (uint32_t)cpu->oper1 + 1);
+}
 
-	if ((dst ^ v1) & (v1 ^ v2) & 0x8000) {
-		cpu->of = 1;
-	}
-	else {
-		cpu->of = 0;
-	}
+FUNC_INLINE void op_dec8(CPU_t* cpu) {
+	cpu->res8 = cpu->oper1b - 1;
+	cpu->cf = flag_getcf(cpu);
+	flag_lazy(cpu, CPU_FLAGS_DEC8, cpu->oper1b, 1, (uint32_t)cpu->oper1b - 1);
+}
 
-	if ((v1 ^ v2 ^ dst) & 0x10) {
-		cpu->af = 1;
-	}
-	else {
-		cpu->af = 0;
-	}
+FUNC_INLINE void op_dec16(CPU_t* cpu) {
+	cpu->res16 = cpu->oper1 - 1;
+	cpu->cf = flag_getcf(cpu);
+	flag_lazy(cpu, CPU_FLAGS_DEC16, cpu->oper1, 1, (uint32_t)cpu->oper1 - 1);
 }
 
 FUNC_INLINE void op_adc8(CPU_t* cpu) {
-	cpu->res8 = cpu->oper1b + cpu->oper2b + cpu->cf;
-	flag_adc8(cpu, cpu->oper1b, cpu->oper2b, cpu->cf);
+	uint8_t cf = flag_getcf(cpu);
+	cpu->res8 = cpu->oper1b + cpu->oper2b + cf;
+	flag_adc8(cpu, cpu->oper1b, cpu->oper2b, cf);
 }
 
 FUNC_INLINE void op_adc16(CPU_t* cpu) {
-	cpu->res16 = cpu->oper1 + cpu->oper2 + cpu->cf;
-	flag_adc16(cpu, cpu->oper1, cpu->oper2, cpu->cf);
+	uint8_t cf = flag_getcf(cpu);
+	cpu->res16 = cpu->oper1 + cpu->oper2 + cf;
+	flag_adc16(cpu, cpu->oper1, cpu->oper2, cf);
 }
 
 FUNC_INLINE void op_add8(CPU_t* cpu) {
@@ -385,13 +347,15 @@ FUNC_INLINE void op_sub16(CPU_t* cpu) {
 }
 
 FUNC_INLINE void op_sbb8(CPU_t* cpu) {
-	cpu->res8 = cpu->oper1b - (cpu->oper2b + cpu->cf);
-	flag_sbb8(cpu, cpu->oper1b, cpu->oper2b, cpu->cf);
+	uint8_t cf = flag_getcf(cpu);
+	cpu->res8 = cpu->oper1b - (cpu->oper2b + cf);
+	flag_sbb8(cpu, cpu->oper1b, cpu->oper2b, cf);
 }
 
 FUNC_INLINE void op_sbb16(CPU_t* cpu) {
-	cpu->res16 = cpu->oper1 - (cpu->oper2 + cpu->cf);
-	flag_sbb16(cpu, cpu->oper1, cpu->oper2, cpu->cf);
+	uint8_t cf = flag_getcf(cpu);
+	cpu->res16 = cpu->oper1 - (cpu->oper2 + cf);
+	flag_sbb16(cpu, cpu->oper1, cpu->oper2, cf);
 }
 
 FUNC_INLINE void getea(CPU_t* cpu, uint8_t rmval) {
@@ -480,17 +444,21 @@ void cpu_reset(CPU_t* cpu) {
 	uint16_t i;
 	for (i = 0; i < 256; i++) {
 		cpu->int_callback[i] = NULL;
+		cpu->int_udata[i] = NULL;
 	}
 	cpu->segregs[regcs] = 0xFFFF;
 	cpu->ip = 0x0000;
 	cpu->hltstate = 0;
 	cpu->trap_toggle = 0;
+#ifdef CPU_BLOCK_CACHE
+	cpu_cacheFlush(cpu);
+#endif
 }
 
 FUNC_INLINE uint16_t readrm16(CPU_t* cpu, uint8_t rmval) {
 	if (cpu->mode < 3) {
 		getea(cpu, rmval);
-		return cpu_read(cpu, cpu->ea) | ((uint16_t)cpu_read(cpu, cpu->ea + 1) << 8);
+		return cpu_readw(cpu, cpu->ea);
 	}
 	else {
 		return getreg16(cpu, rmval);
@@ -510,8 +478,7 @@ FUNC_INLINE uint8_t readrm8(CPU_t* cpu, uint8_t rmval) {
 FUNC_INLINE void writerm16(CPU_t* cpu, uint8_t rmval, uint16_t value) {
 	if (cpu->mode < 3) {
 		getea(cpu, rmval);
-		cpu_write(cpu, cpu->ea, value & 0xFF);
-		cpu_write(cpu, cpu->ea + 1, value >> 8);
+		cpu_writew(cpu, cpu->ea, value);
 	}
 	else {
 		putreg16(cpu, rmval, value);
@@ -536,6 +503,7 @@ FUNC_INLINE uint8_t op_grp2_8(CPU_t* cpu, uint8_t cnt) {
 	uint16_t	msb;
 
 	s = cpu->oper1b;
+	flag_sync(cpu);
 	oldcf = cpu->cf;
 #ifdef CPU_LIMIT_SHIFT_COUNT
 	cnt &= 0x1F;
@@ -665,6 +633,7 @@ FUNC_INLINE uint16_t op_grp2_16(CPU_t* cpu, uint8_t cnt) {
 	uint32_t	msb;
 
 	s = cpu->oper1;
+	flag_sync(cpu);
 	oldcf = cpu->cf;
 #ifdef CPU_LIMIT_SHIFT_COUNT
 	cnt &= 0x1F;
@@ -839,8 +808,7 @@ FUNC_INLINE void op_grp3_8(CPU_t* cpu) {
 	switch (cpu->reg) {
 	case 0:
 	case 1: /* TEST */
-		flag_log8(cpu, cpu->oper1b & getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-		StepIP(cpu, 1);
+		flag_log8(cpu, cpu->oper1b & cpu->imm);
 		break;
 
 	case 2: /* NOT */
@@ -849,16 +817,11 @@ FUNC_INLINE void op_grp3_8(CPU_t* cpu) {
 
 	case 3: /* NEG */
 		cpu->res8 = (~cpu->oper1b) + 1;
-		flag_sub8(cpu, 0, cpu->oper1b);
-		if (cpu->res8 == 0) {
-			cpu->cf = 0;
-		}
-		else {
-			cpu->cf = 1;
-		}
+		flag_sub8(cpu, 0, cpu->oper1b); /* the borrow out of 0 - value is already the CF that NEG sets */
 		break;
 
 	case 4: /* MUL */
+		flag_sync(cpu);
 		cpu->temp1 = (uint32_t)cpu->oper1b * (uint32_t)cpu->regs.byteregs[regal];
 		cpu->regs.wordregs[regax] = cpu->temp1 & 0xFFFF;
 		flag_szp8(cpu, (uint8_t)cpu->temp1);
@@ -876,6 +839,7 @@ FUNC_INLINE void op_grp3_8(CPU_t* cpu) {
 		break;
 
 	case 5: /* IMUL */
+		flag_sync(cpu);
 		cpu->oper1 = signext(cpu->oper1b);
 		cpu->temp1 = signext(cpu->regs.byteregs[regal]);
 		cpu->temp2 = cpu->oper1;
@@ -966,8 +930,7 @@ FUNC_INLINE void op_grp3_16(CPU_t* cpu) {
 	switch (cpu->reg) {
 	case 0:
 	case 1: /* TEST */
-		flag_log16(cpu, cpu->oper1 & getmem16(cpu, cpu->segregs[regcs], cpu->ip));
-		StepIP(cpu, 2);
+		flag_log16(cpu, cpu->oper1 & cpu->imm);
 		break;
 
 	case 2: /* NOT */
@@ -977,15 +940,10 @@ FUNC_INLINE void op_grp3_16(CPU_t* cpu) {
 	case 3: /* NEG */
 		cpu->res16 = (~cpu->oper1) + 1;
 		flag_sub16(cpu, 0, cpu->oper1);
-		if (cpu->res16) {
-			cpu->cf = 1;
-		}
-		else {
-			cpu->cf = 0;
-		}
 		break;
 
 	case 4: /* MUL */
+		flag_sync(cpu);
 		cpu->temp1 = (uint32_t)cpu->oper1 * (uint32_t)cpu->regs.wordregs[regax];
 		cpu->regs.wordregs[regax] = cpu->temp1 & 0xFFFF;
 		cpu->regs.wordregs[regdx] = cpu->temp1 >> 16;
@@ -1004,6 +962,7 @@ FUNC_INLINE void op_grp3_16(CPU_t* cpu) {
 		break;
 
 	case 5: /* IMUL */
+		flag_sync(cpu);
 		cpu->temp1 = cpu->regs.wordregs[regax];
 		cpu->temp2 = cpu->oper1;
 		if (cpu->temp1 & 0x8000) {
@@ -1044,17 +1003,13 @@ FUNC_INLINE void op_grp5(CPU_t* cpu) {
 	switch (cpu->reg) {
 	case 0: /* INC Ev */
 		cpu->oper2 = 1;
-		cpu->tempcf = cpu->cf;
-		op_add16(cpu);
-		cpu->cf = cpu->tempcf;
+		op_inc16(cpu);
 		writerm16(cpu, cpu->rm, cpu->res16);
 		break;
 
 	case 1: /* DEC Ev */
 		cpu->oper2 = 1;
-		cpu->tempcf = cpu->cf;
-		op_sub16(cpu);
-		cpu->cf = cpu->tempcf;
+		op_dec16(cpu);
 		writerm16(cpu, cpu->rm, cpu->res16);
 		break;
 
@@ -1067,8 +1022,8 @@ FUNC_INLINE void op_grp5(CPU_t* cpu) {
 		push(cpu, cpu->segregs[regcs]);
 		push(cpu, cpu->ip);
 		getea(cpu, cpu->rm);
-		cpu->ip = (uint16_t)cpu_read(cpu, cpu->ea) + (uint16_t)cpu_read(cpu, cpu->ea + 1) * 256;
-		cpu->segregs[regcs] = (uint16_t)cpu_read(cpu, cpu->ea + 2) + (uint16_t)cpu_read(cpu, cpu->ea + 3) * 256;
+		cpu->ip = cpu_readw(cpu, cpu->ea);
+		cpu->segregs[regcs] = cpu_readw(cpu, cpu->ea + 2);
 		break;
 
 	case 4: /* JMP Ev */
@@ -1077,8 +1032,8 @@ FUNC_INLINE void op_grp5(CPU_t* cpu) {
 
 	case 5: /* JMP Mp */
 		getea(cpu, cpu->rm);
-		cpu->ip = (uint16_t)cpu_read(cpu, cpu->ea) + (uint16_t)cpu_read(cpu, cpu->ea + 1) * 256;
-		cpu->segregs[regcs] = (uint16_t)cpu_read(cpu, cpu->ea + 2) + (uint16_t)cpu_read(cpu, cpu->ea + 3) * 256;
+		cpu->ip = cpu_readw(cpu, cpu->ea);
+		cpu->segregs[regcs] = cpu_readw(cpu, cpu->ea + 2);
 		break;
 
 	case 6: /* PUSH Ev */
@@ -1089,7 +1044,8 @@ FUNC_INLINE void op_grp5(CPU_t* cpu) {
 
 FUNC_INLINE void cpu_intcall(CPU_t* cpu, uint8_t intnum) {
 	if (cpu->int_callback[intnum] != NULL) {
-		(*cpu->int_callback[intnum])(cpu, intnum);
+		flag_sync(cpu); /* callbacks use the flag fields directly */
+		(*cpu->int_callback[intnum])(cpu, intnum, cpu->int_udata[intnum]);
 		return;
 	}
 
@@ -1110,2167 +1066,3314 @@ void cpu_interruptCheck(CPU_t* cpu, I8259_t* i8259) {
 	}
 }
 
-void cpu_exec(CPU_t* cpu, uint32_t execloops) {
-
-	uint32_t loopcount;
-	uint8_t docontinue;
-	static uint16_t firstip;
-
-	for (loopcount = 0; loopcount < execloops; loopcount++) {
-
-		if (cpu->trap_toggle) {
-			cpu_intcall(cpu, 1);
-		}
-
-		if (cpu->tf) {
-			cpu->trap_toggle = 1;
-		}
-		else {
-			cpu->trap_toggle = 0;
-		}
-
-		if (cpu->hltstate) goto skipexecution;
-
-		cpu->reptype = 0;
-		cpu->segoverride = 0;
-		cpu->useseg = cpu->segregs[regds];
-		docontinue = 0;
-		firstip = cpu->ip;
-
-		while (!docontinue) {
-			cpu->segregs[regcs] = cpu->segregs[regcs] & 0xFFFF;
-			cpu->ip = cpu->ip & 0xFFFF;
-			cpu->savecs = cpu->segregs[regcs];
-			cpu->saveip = cpu->ip;
-			cpu->opcode = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-
-			switch (cpu->opcode) {
-				/* segment prefix check */
-			case 0x2E:	/* segment cpu->segregs[regcs] */
-				cpu->useseg = cpu->segregs[regcs];
-				cpu->segoverride = 1;
-				break;
+/* memory and I/O ports of the machine this CPU is in */
+void cpu_connectBus(CPU_t* cpu, MEMORY_t* memory, PORTS_t* ports) {
+	cpu->memory = memory;
+	cpu->ports = ports;
+}
 
-			case 0x3E:	/* segment cpu->segregs[regds] */
-				cpu->useseg = cpu->segregs[regds];
-				cpu->segoverride = 1;
-				break;
+/* the i8259 raises cpu->intr itself, the CPU looks at it between instructions */
+void cpu_connectPIC(CPU_t* cpu, I8259_t* i8259) {
+	cpu->i8259 = i8259;
+	i8259_connect(i8259, &cpu->intr);
+}
 
-			case 0x26:	/* segment cpu->segregs[reges] */
-				cpu->useseg = cpu->segregs[reges];
-				cpu->segoverride = 1;
-				break;
+/* STI, MOV SS and POP SS hold interrupts off until the instruction after them has run */
+#define CPU_INT_SHADOW(x)	(((x)->opcode == 0xFB) || ((x)->opcode == 0x17) || (((x)->opcode == 0x8E) && ((x)->reg == regss)))
 
-			case 0x36:	/* segment cpu->segregs[regss] */
-				cpu->useseg = cpu->segregs[regss];
-				cpu->segoverride = 1;
-				break;
+FUNC_INLINE void cpu_boundaryInterrupt(CPU_t* cpu) {
+	if (!CPU_INT_SHADOW(cpu)) {
+		cpu_interruptCheck(cpu, cpu->i8259);
+	}
+}
 
-				/* repetition prefix check */
-			case 0xF3:	/* REP/REPE/REPZ */
-				cpu->reptype = 1;
-				break;
+FUNC_INLINE void op_illegal(CPU_t* cpu) {
+#ifdef CPU_ALLOW_ILLEGAL_OP_EXCEPTION
+	cpu_intcall(cpu, 6); /* trip invalid opcode exception. this occurs on the 80186+, 8086/8088 CPUs treat them as NOPs. */
+					   /* technically they aren't exactly like NOPs in most cases, but for our pursoses, that's accurate enough. */
+	debug_log(DEBUG_INFO, "[CPU] Invalid opcode exception at %04X:%04X\r\n", cpu->segregs[regcs], cpu->firstip);
+#endif
+}
 
-			case 0xF2:	/* REPNE/REPNZ */
-				cpu->reptype = 2;
-				break;
+#ifdef CPU_8086
+#define CPU_OP_80186(handler)	op_illegal
+#define CPU_DEC_80186(flags)	0
+#else
+#define CPU_OP_80186(handler)	handler
+#define CPU_DEC_80186(flags)	flags
+#endif
 
-			default:
-				docontinue = 1;
-				break;
+/*
+	Opcode list shared by the decoder and both interpreter cores. O() entries are complete
+	instructions, P() entries are prefixes, which the decoder folds into the instruction that
+	follows them.
+*/
+#define CPU_OPCODE_LIST(O, P) \
+	O(00, op_00, CPU_DEC_MODRM) O(01, op_01, CPU_DEC_MODRM) O(02, op_02, CPU_DEC_MODRM) O(03, op_03, CPU_DEC_MODRM) \
+	O(04, op_04, CPU_DEC_IMM8) O(05, op_05, CPU_DEC_IMM16) O(06, op_06, 0) O(07, op_07, 0) O(08, op_08, CPU_DEC_MODRM) \
+	O(09, op_09, CPU_DEC_MODRM) O(0A, op_0A, CPU_DEC_MODRM) O(0B, op_0B, CPU_DEC_MODRM) O(0C, op_0C, CPU_DEC_IMM8) \
+	O(0D, op_0D, CPU_DEC_IMM16) O(0E, op_0E, 0) O(0F, op_0F, CPU_DEC_BRANCH) O(10, op_10, CPU_DEC_MODRM) \
+	O(11, op_11, CPU_DEC_MODRM) O(12, op_12, CPU_DEC_MODRM) O(13, op_13, CPU_DEC_MODRM) O(14, op_14, CPU_DEC_IMM8) \
+	O(15, op_15, CPU_DEC_IMM16) O(16, op_16, 0) O(17, op_17, 0) O(18, op_18, CPU_DEC_MODRM) O(19, op_19, CPU_DEC_MODRM) \
+	O(1A, op_1A, CPU_DEC_MODRM) O(1B, op_1B, CPU_DEC_MODRM) O(1C, op_1C, CPU_DEC_IMM8) O(1D, op_1D, CPU_DEC_IMM16) \
+	O(1E, op_1E, 0) O(1F, op_1F, 0) O(20, op_20, CPU_DEC_MODRM) O(21, op_21, CPU_DEC_MODRM) O(22, op_22, CPU_DEC_MODRM) \
+	O(23, op_23, CPU_DEC_MODRM) O(24, op_24, CPU_DEC_IMM8) O(25, op_25, CPU_DEC_IMM16) P(26, CPU_DEC_PREFIX) \
+	O(27, op_27, 0) O(28, op_28, CPU_DEC_MODRM) O(29, op_29, CPU_DEC_MODRM) O(2A, op_2A, CPU_DEC_MODRM) \
+	O(2B, op_2B, CPU_DEC_MODRM) O(2C, op_2C, CPU_DEC_IMM8) O(2D, op_2D, CPU_DEC_IMM16) P(2E, CPU_DEC_PREFIX) \
+	O(2F, op_2F, 0) O(30, op_30, CPU_DEC_MODRM) O(31, op_31, CPU_DEC_MODRM) O(32, op_32, CPU_DEC_MODRM) \
+	O(33, op_33, CPU_DEC_MODRM) O(34, op_34, CPU_DEC_IMM8) O(35, op_35, CPU_DEC_IMM16) P(36, CPU_DEC_PREFIX) \
+	O(37, op_37, 0) O(38, op_38, CPU_DEC_MODRM) O(39, op_39, CPU_DEC_MODRM) O(3A, op_3A, CPU_DEC_MODRM) \
+	O(3B, op_3B, CPU_DEC_MODRM) O(3C, op_3C, CPU_DEC_IMM8) O(3D, op_3D, CPU_DEC_IMM16) P(3E, CPU_DEC_PREFIX) \
+	O(3F, op_3F, 0) O(40, op_40, 0) O(41, op_41, 0) O(42, op_42, 0) O(43, op_43, 0) O(44, op_44, 0) O(45, op_45, 0) \
+	O(46, op_46, 0) O(47, op_47, 0) O(48, op_48, 0) O(49, op_49, 0) O(4A, op_4A, 0) O(4B, op_4B, 0) O(4C, op_4C, 0) \
+	O(4D, op_4D, 0) O(4E, op_4E, 0) O(4F, op_4F, 0) O(50, op_50, 0) O(51, op_51, 0) O(52, op_52, 0) O(53, op_53, 0) \
+	O(54, op_54, 0) O(55, op_55, 0) O(56, op_56, 0) O(57, op_57, 0) O(58, op_58, 0) O(59, op_59, 0) O(5A, op_5A, 0) \
+	O(5B, op_5B, 0) O(5C, op_5C, 0) O(5D, op_5D, 0) O(5E, op_5E, 0) O(5F, op_5F, 0) \
+	O(60, CPU_OP_80186(op_60), CPU_DEC_80186(0)) O(61, CPU_OP_80186(op_61), CPU_DEC_80186(0)) \
+	O(62, CPU_OP_80186(op_62), CPU_DEC_80186(CPU_DEC_MODRM | CPU_DEC_BRANCH)) O(63, op_illegal, CPU_DEC_BRANCH) \
+	O(64, op_illegal, CPU_DEC_BRANCH) O(65, op_illegal, CPU_DEC_BRANCH) O(66, op_illegal, CPU_DEC_BRANCH) \
+	O(67, op_illegal, CPU_DEC_BRANCH) O(68, CPU_OP_80186(op_68), CPU_DEC_80186(CPU_DEC_IMM16)) \
+	O(69, CPU_OP_80186(op_69), CPU_DEC_80186(CPU_DEC_MODRM | CPU_DEC_IMM16)) \
+	O(6A, CPU_OP_80186(op_6A), CPU_DEC_80186(CPU_DEC_IMM8)) \
+	O(6B, CPU_OP_80186(op_6B), CPU_DEC_80186(CPU_DEC_MODRM | CPU_DEC_IMM8)) \
+	O(6C, CPU_OP_80186(op_6C), CPU_DEC_80186(0)) O(6D, CPU_OP_80186(op_6D), CPU_DEC_80186(0)) \
+	O(6E, CPU_OP_80186(op_6E), CPU_DEC_80186(0)) O(6F, CPU_OP_80186(op_6F), CPU_DEC_80186(0)) \
+	O(70, op_70, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(71, op_71, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(72, op_72, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(73, op_73, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(74, op_74, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(75, op_75, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(76, op_76, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(77, op_77, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(78, op_78, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(79, op_79, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(7A, op_7A, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(7B, op_7B, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(7C, op_7C, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(7D, op_7D, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(7E, op_7E, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(7F, op_7F, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(80, op_80, CPU_DEC_MODRM | CPU_DEC_IMM8) O(81, op_81, CPU_DEC_MODRM | CPU_DEC_IMM16) \
+	O(82, op_80, CPU_DEC_MODRM | CPU_DEC_IMM8) O(83, op_81, CPU_DEC_MODRM | CPU_DEC_IMM8) O(84, op_84, CPU_DEC_MODRM) \
+	O(85, op_85, CPU_DEC_MODRM) O(86, op_86, CPU_DEC_MODRM) O(87, op_87, CPU_DEC_MODRM) O(88, op_88, CPU_DEC_MODRM) \
+	O(89, op_89, CPU_DEC_MODRM) O(8A, op_8A, CPU_DEC_MODRM) O(8B, op_8B, CPU_DEC_MODRM) O(8C, op_8C, CPU_DEC_MODRM) \
+	O(8D, op_8D, CPU_DEC_MODRM) O(8E, op_8E, CPU_DEC_MODRM) O(8F, op_8F, CPU_DEC_MODRM) O(90, op_90, 0) O(91, op_91, 0) \
+	O(92, op_92, 0) O(93, op_93, 0) O(94, op_94, 0) O(95, op_95, 0) O(96, op_96, 0) O(97, op_97, 0) O(98, op_98, 0) \
+	O(99, op_99, 0) O(9A, op_9A, CPU_DEC_IMM16 | CPU_DEC_IMM2_16 | CPU_DEC_BRANCH) O(9B, op_9B, 0) O(9C, op_9C, 0) \
+	O(9D, op_9D, 0) O(9E, op_9E, 0) O(9F, op_9F, 0) O(A0, op_A0, CPU_DEC_IMM16) O(A1, op_A1, CPU_DEC_IMM16) \
+	O(A2, op_A2, CPU_DEC_IMM16) O(A3, op_A3, CPU_DEC_IMM16) O(A4, op_A4, 0) O(A5, op_A5, 0) O(A6, op_A6, 0) \
+	O(A7, op_A7, 0) O(A8, op_A8, CPU_DEC_IMM8) O(A9, op_A9, CPU_DEC_IMM16) O(AA, op_AA, 0) O(AB, op_AB, 0) \
+	O(AC, op_AC, 0) O(AD, op_AD, 0) O(AE, op_AE, 0) O(AF, op_AF, 0) O(B0, op_B0, CPU_DEC_IMM8) \
+	O(B1, op_B1, CPU_DEC_IMM8) O(B2, op_B2, CPU_DEC_IMM8) O(B3, op_B3, CPU_DEC_IMM8) O(B4, op_B4, CPU_DEC_IMM8) \
+	O(B5, op_B5, CPU_DEC_IMM8) O(B6, op_B6, CPU_DEC_IMM8) O(B7, op_B7, CPU_DEC_IMM8) O(B8, op_B8, CPU_DEC_IMM16) \
+	O(B9, op_B9, CPU_DEC_IMM16) O(BA, op_BA, CPU_DEC_IMM16) O(BB, op_BB, CPU_DEC_IMM16) O(BC, op_BC, CPU_DEC_IMM16) \
+	O(BD, op_BD, CPU_DEC_IMM16) O(BE, op_BE, CPU_DEC_IMM16) O(BF, op_BF, CPU_DEC_IMM16) \
+	O(C0, op_C0, CPU_DEC_MODRM | CPU_DEC_IMM8) O(C1, op_C1, CPU_DEC_MODRM | CPU_DEC_IMM8) \
+	O(C2, op_C2, CPU_DEC_IMM16 | CPU_DEC_BRANCH) O(C3, op_C3, CPU_DEC_BRANCH) O(C4, op_C4, CPU_DEC_MODRM) \
+	O(C5, op_C5, CPU_DEC_MODRM) O(C6, op_C6, CPU_DEC_MODRM | CPU_DEC_IMM8) O(C7, op_C7, CPU_DEC_MODRM | CPU_DEC_IMM16) \
+	O(C8, op_C8, CPU_DEC_IMM16 | CPU_DEC_IMM2_8) O(C9, op_C9, 0) O(CA, op_CA, CPU_DEC_IMM16 | CPU_DEC_BRANCH) \
+	O(CB, op_CB, CPU_DEC_BRANCH) O(CC, op_CC, CPU_DEC_BRANCH) O(CD, op_CD, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(CE, op_CE, CPU_DEC_BRANCH) O(CF, op_CF, CPU_DEC_BRANCH) O(D0, op_D0, CPU_DEC_MODRM) O(D1, op_D1, CPU_DEC_MODRM) \
+	O(D2, op_D2, CPU_DEC_MODRM) O(D3, op_D3, CPU_DEC_MODRM) O(D4, op_D4, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(D5, op_D5, CPU_DEC_IMM8) O(D6, op_D6, 0) O(D7, op_D7, 0) O(D8, op_D8, CPU_DEC_MODRM) O(D9, op_D8, CPU_DEC_MODRM) \
+	O(DA, op_D8, CPU_DEC_MODRM) O(DB, op_D8, CPU_DEC_MODRM) O(DC, op_D8, CPU_DEC_MODRM) O(DD, op_D8, CPU_DEC_MODRM) \
+	O(DE, op_D8, CPU_DEC_MODRM) O(DF, op_D8, CPU_DEC_MODRM) O(E0, op_E0, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(E1, op_E1, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(E2, op_E2, CPU_DEC_IMM8 | CPU_DEC_BRANCH) \
+	O(E3, op_E3, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(E4, op_E4, CPU_DEC_IMM8) O(E5, op_E5, CPU_DEC_IMM8) \
+	O(E6, op_E6, CPU_DEC_IMM8) O(E7, op_E7, CPU_DEC_IMM8) O(E8, op_E8, CPU_DEC_IMM16 | CPU_DEC_BRANCH) \
+	O(E9, op_E9, CPU_DEC_IMM16 | CPU_DEC_BRANCH) O(EA, op_EA, CPU_DEC_IMM16 | CPU_DEC_IMM2_16 | CPU_DEC_BRANCH) \
+	O(EB, op_EB, CPU_DEC_IMM8 | CPU_DEC_BRANCH) O(EC, op_EC, 0) O(ED, op_ED, 0) O(EE, op_EE, 0) O(EF, op_EF, 0) \
+	O(F0, op_F0, 0) O(F1, op_illegal, CPU_DEC_BRANCH) P(F2, CPU_DEC_PREFIX) P(F3, CPU_DEC_PREFIX) \
+	O(F4, op_F4, CPU_DEC_BRANCH) O(F5, op_F5, 0) O(F6, op_F6, CPU_DEC_MODRM | CPU_DEC_GRP3 | CPU_DEC_BRANCH) \
+	O(F7, op_F7, CPU_DEC_MODRM | CPU_DEC_GRP3 | CPU_DEC_BRANCH) O(F8, op_F8, 0) O(F9, op_F9, 0) O(FA, op_FA, 0) \
+	O(FB, op_FB, 0) O(FC, op_FC, 0) O(FD, op_FD, 0) O(FE, op_FE, CPU_DEC_MODRM) \
+	O(FF, op_FF, CPU_DEC_MODRM | CPU_DEC_BRANCH)
+
+#define CPU_DEC_FLAGS(n, handler, flags)	flags,
+#define CPU_DEC_PREFIXFLAGS(n, flags)	flags,
+
+const uint8_t cpu_decodeflags[256] = { CPU_OPCODE_LIST(CPU_DEC_FLAGS, CPU_DEC_PREFIXFLAGS) };
+
+/* decode the instruction at CS:ip, including any prefixes, without changing CPU state */
+FUNC_INLINE void cpu_decode(CPU_t* cpu, uint16_t ip, CPU_DECODED_t* dec) {
+	uint16_t cs = cpu->segregs[regcs];
+	uint8_t flags, mode, rm;
+
+	dec->ip = ip;
+	dec->segoverride = 0;
+	dec->useseg = regds;
+	dec->reptype = 0;
+	dec->addrbyte = 0;
+	dec->disp16 = 0;
+	dec->imm = 0;
+	dec->imm2 = 0;
+
+	while (1) {
+		dec->opcode = getmem8(cpu, cs, ip);
+		ip++;
+		flags = cpu_decodeflags[dec->opcode];
+		if (!(flags & CPU_DEC_PREFIX)) break;
+		switch (dec->opcode) {
+		case 0x26:
+			dec->useseg = reges;
+			dec->segoverride = 1;
+			break;
+		case 0x2E:
+			dec->useseg = regcs;
+			dec->segoverride = 1;
+			break;
+		case 0x36:
+			dec->useseg = regss;
+			dec->segoverride = 1;
+			break;
+		case 0x3E:
+			dec->useseg = regds;
+			dec->segoverride = 1;
+			break;
+		case 0xF2:	/* REPNE/REPNZ */
+			dec->reptype = 2;
+			break;
+		case 0xF3:	/* REP/REPE/REPZ */
+			dec->reptype = 1;
+			break;
+		}
+	}
+	dec->prefixlen = ip - dec->ip - 1;
+	dec->dispatch = dec->opcode;
+
+	if (flags & CPU_DEC_MODRM) {
+		dec->addrbyte = getmem8(cpu, cs, ip);
+		ip++;
+		mode = dec->addrbyte >> 6;
+		rm = dec->addrbyte & 7;
+		switch (mode) {
+		case 0:
+			if (rm == 6) {
+				dec->disp16 = getmem16(cpu, cs, ip);
+				ip += 2;
 			}
+			if (((rm == 2) || (rm == 3)) && !dec->segoverride) {
+				dec->useseg = regss;
+			}
+			break;
+		case 1:
+			dec->disp16 = signext(getmem8(cpu, cs, ip));
+			ip++;
+			if (((rm == 2) || (rm == 3) || (rm == 6)) && !dec->segoverride) {
+				dec->useseg = regss;
+			}
+			break;
+		case 2:
+			dec->disp16 = getmem16(cpu, cs, ip);
+			ip += 2;
+			if (((rm == 2) || (rm == 3) || (rm == 6)) && !dec->segoverride) {
+				dec->useseg = regss;
+			}
+			break;
 		}
+	}
 
-		cpu->totalexec++;
+	if ((flags & CPU_DEC_GRP3) && (((dec->addrbyte >> 3) & 7) < 2)) {
+		flags |= (dec->opcode & 1) ? CPU_DEC_IMM16 : CPU_DEC_IMM8;
+	}
 
-		switch (cpu->opcode) {
-		case 0x0:	/* 00 ADD Eb Gb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getreg8(cpu, cpu->reg);
-			op_add8(cpu);
-			writerm8(cpu, cpu->rm, cpu->res8);
-			break;
+	if (flags & CPU_DEC_IMM8) {
+		dec->imm = getmem8(cpu, cs, ip);
+		ip++;
+	}
+	else if (flags & CPU_DEC_IMM16) {
+		dec->imm = getmem16(cpu, cs, ip);
+		ip += 2;
+	}
 
-		case 0x1:	/* 01 ADD Ev Gv */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getreg16(cpu, cpu->reg);
-			op_add16(cpu);
-			writerm16(cpu, cpu->rm, cpu->res16);
-			break;
+	if (flags & CPU_DEC_IMM2_8) {
+		dec->imm2 = getmem8(cpu, cs, ip);
+		ip++;
+	}
+	else if (flags & CPU_DEC_IMM2_16) {
+		dec->imm2 = getmem16(cpu, cs, ip);
+		ip += 2;
+	}
 
-		case 0x2:	/* 02 ADD Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			op_add8(cpu);
-			putreg8(cpu, cpu->reg, cpu->res8);
-			break;
+	dec->len = ip - dec->ip;
+	dec->cycles = cpu_cycles(dec);
+}
 
-		case 0x3:	/* 03 ADD Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			op_add16(cpu);
-			putreg16(cpu, cpu->reg, cpu->res16);
-			break;
+/* set up the CPU to execute a decoded instruction, this is what fetching prefixes, ModR/M and immediates used to do */
+FUNC_INLINE void cpu_loaddecoded(CPU_t* cpu, const CPU_DECODED_t* dec) {
+	cpu->opcode = dec->opcode;
+	cpu->dispatch = dec->dispatch;
+	cpu->segoverride = dec->segoverride;
+	cpu->useseg = cpu->segregs[dec->useseg];
+	cpu->reptype = dec->reptype;
+	cpu->repcycles = dec->cycles;
+	cpu->savecs = cpu->segregs[regcs];
+	cpu->saveip = dec->ip + dec->prefixlen;
+	if (cpu_decodeflags[dec->opcode] & CPU_DEC_MODRM) {
+		cpu->addrbyte = dec->addrbyte;
+		cpu->mode = dec->addrbyte >> 6;
+		cpu->reg = (dec->addrbyte >> 3) & 7;
+		cpu->rm = dec->addrbyte & 7;
+		cpu->disp16 = dec->disp16;
+	}
+	cpu->imm = dec->imm;
+	cpu->imm2 = dec->imm2;
+	cpu->ip = dec->ip + dec->len;
+	cpu->cycles += dec->cycles;
+}
 
-		case 0x4:	/* 04 ADD cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			op_add8(cpu);
-			cpu->regs.byteregs[regal] = cpu->res8;
-			break;
+#ifdef CPU_BLOCK_CACHE
+void cpu_cacheFlush(CPU_t* cpu) {
+	uint32_t i;
 
-		case 0x5:	/* 05 ADD eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			op_add16(cpu);
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+	if (cpu->blocks == NULL) {
+		cpu->blocks = (CPU_BLOCK_t*)malloc(sizeof(CPU_BLOCK_t) * CPU_BLOCK_COUNT);
+		if (cpu->blocks == NULL) {
+			debug_log(DEBUG_ERROR, "[CPU] Unable to allocate block cache, running without it\r\n");
+			return;
+		}
+	}
 
-		case 0x6:	/* 06 PUSH cpu->segregs[reges] */
-			push(cpu, cpu->segregs[reges]);
-			break;
+	for (i = 0; i < CPU_BLOCK_COUNT; i++) {
+		cpu->blocks[i].count = 0;
+	}
+	cpu->block = NULL;
+#ifdef CPU_JIT
+	cpu_jitFlush(cpu);
+#endif
+}
 
-		case 0x7:	/* 07 POP cpu->segregs[reges] */
-			cpu->segregs[reges] = pop(cpu);
-			break;
+/* check that the whole instruction at IP lies below the linear address end without wrapping the segment, peeking only at plain memory */
+uint8_t cpu_cacheFits(CPU_t* cpu, uint16_t ip, uint32_t addr, uint32_t end) {
+	uint32_t len = 0;
+	uint8_t opcode, flags, addrbyte, mode;
 
-		case 0x8:	/* 08 OR Eb Gb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getreg8(cpu, cpu->reg);
-			op_or8(cpu);
-			writerm8(cpu, cpu->rm, cpu->res8);
-			break;
+	do {
+		if ((((uint32_t)ip + len) >= 0x10000) || ((addr + len) >= end)) {
+			return 0;
+		}
+		opcode = cpu->memory->pageRead[(addr + len) >> MEMORY_PAGE_SHIFT][(addr + len) & MEMORY_PAGE_MASK];
+		len++;
+		flags = cpu_decodeflags[opcode];
+	} while (flags & CPU_DEC_PREFIX);
+
+	if (flags & CPU_DEC_MODRM) {
+		if ((((uint32_t)ip + len) >= 0x10000) || ((addr + len) >= end)) {
+			return 0;
+		}
+		addrbyte = cpu->memory->pageRead[(addr + len) >> MEMORY_PAGE_SHIFT][(addr + len) & MEMORY_PAGE_MASK];
+		len++;
+		mode = addrbyte >> 6;
+		if (mode == 1) {
+			len++;
+		}
+		else if ((mode == 2) || ((mode == 0) && ((addrbyte & 7) == 6))) {
+			len += 2;
+		}
+		if ((flags & CPU_DEC_GRP3) && (((addrbyte >> 3) & 7) < 2)) {
+			flags |= (opcode & 1) ? CPU_DEC_IMM16 : CPU_DEC_IMM8;
+		}
+	}
 
-		case 0x9:	/* 09 OR Ev Gv */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getreg16(cpu, cpu->reg);
-			op_or16(cpu);
-			writerm16(cpu, cpu->rm, cpu->res16);
-			break;
+	if (flags & CPU_DEC_IMM8) len++;
+	else if (flags & CPU_DEC_IMM16) len += 2;
+	if (flags & CPU_DEC_IMM2_8) len++;
+	else if (flags & CPU_DEC_IMM2_16) len += 2;
 
-		case 0xA:	/* 0A OR Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			op_or8(cpu);
-			putreg8(cpu, cpu->reg, cpu->res8);
-			break;
+	return ((((uint32_t)ip + len) <= 0x10000) && ((addr + len) <= end));
+}
 
-		case 0xB:	/* 0B OR Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			op_or16(cpu);
-			if ((cpu->oper1 == 0xF802) && (cpu->oper2 == 0xF802)) {
-				cpu->sf = 0;	/* cheap hack to make Wolf 3D think we're a 286 so it plays */
-			}
-
-			putreg16(cpu, cpu->reg, cpu->res16);
-			break;
-
-		case 0xC:	/* 0C OR cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			op_or8(cpu);
-			cpu->regs.byteregs[regal] = cpu->res8;
-			break;
+#ifdef CPU_FUSE
+/* give the instruction just added to the block, or the one before it, the fused handler of the sequence they make */
+void cpu_fuseMark(CPU_BLOCK_t* block) {
+	CPU_DECODED_t* dec = &block->ins[block->count - 1];
+	CPU_DECODED_t* prev;
 
-		case 0xD:	/* 0D OR eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			op_or16(cpu);
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+	if ((dec->opcode == 0xE2) && ((uint16_t)(dec->ip + dec->len + signext(dec->imm)) == block->ip)) {
+		dec->dispatch = CPU_FUSED | dec->opcode;
+	}
+	if (block->count < 2) {
+		return;
+	}
+	prev = &block->ins[block->count - 2];
+	if (prev->reptype) {
+		return;
+	}
 
-		case 0xE:	/* 0E PUSH cpu->segregs[regcs] */
-			push(cpu, cpu->segregs[regcs]);
-			break;
+	switch (prev->opcode) {
+	case 0x38: case 0x39: case 0x3A: case 0x3B: case 0x3C: case 0x3D:	/* CMP */
+	case 0x84: case 0x85: case 0xA8: case 0xA9:	/* TEST */
+		if ((dec->opcode & 0xF0) == 0x70) break;
+		return;
+	case 0x80: case 0x81: case 0x82: case 0x83:	/* GRP1 with CMP */
+		if (((dec->opcode & 0xF0) == 0x70) && (((prev->addrbyte >> 3) & 7) == 7)) break;
+		return;
+	case 0x46: case 0x47:	/* INC SI, INC DI */
+		if (dec->opcode == (prev->opcode ^ 1)) break;
+		return;
+	case 0x48: case 0x49: case 0x4A: case 0x4B: case 0x4C: case 0x4D: case 0x4E: case 0x4F:	/* DEC reg */
+		if (dec->opcode == 0x75) break;
+		return;
+	case 0xAC:	/* LODSB */
+		if ((dec->opcode == 0xAA) && !dec->reptype) break;
+		return;
+	default:
+		return;
+	}
+	prev->dispatch = CPU_FUSED | prev->opcode;
+}
+#endif
 
-#ifdef CPU_ALLOW_POP_CS //only the 8086/8088 does this.
-		case 0xF: //0F POP CS
-			cpu->segregs[regcs] = pop(cpu);
-			break;
+/*
+	decode a new block starting at CS:IP, stopping at a branch or where the next instruction leaves the page.
+	the last instruction may run into the following page if that is plain memory too. nothing outside those
+	pages is read, since it could be memory-mapped I/O with side effects on read.
+*/
+uint8_t cpu_cacheBuild(CPU_t* cpu, CPU_BLOCK_t* block) {
+	uint16_t cs = cpu->segregs[regcs], ip = cpu->ip;
+	uint32_t page, addr, end;
+	uint8_t spill;
+	CPU_DECODED_t* dec;
+
+	page = ((segbase(cs) + ip) & MEMORY_MASK) >> MEMORY_CODE_SHIFT;
+	if (!memory_isDirectPage(cpu->memory, page)) {
+		return 0;
+	}
+	spill = ((page + 1) < MEMORY_CODE_PAGES) && memory_isDirectPage(cpu->memory, page + 1);
+	end = (page + (spill ? 2 : 1)) << MEMORY_CODE_SHIFT;
+
+	block->cs = cs;
+	block->ip = ip;
+	block->page = block->page2 = page;
+	block->count = 0;
+	block->cycles = 0;
+#ifdef CPU_JIT
+	block->hits = 0;
+	block->code = NULL;
 #endif
 
-		case 0x10:	/* 10 ADC Eb Gb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getreg8(cpu, cpu->reg);
-			op_adc8(cpu);
-			writerm8(cpu, cpu->rm, cpu->res8);
+	while (block->count < CPU_BLOCK_MAX) {
+		addr = (segbase(cs) + ip) & MEMORY_MASK;
+		if (((addr >> MEMORY_CODE_SHIFT) != page) || !cpu_cacheFits(cpu, ip, addr, end)) break;
+		dec = &block->ins[block->count];
+		cpu_decode(cpu, ip, dec);
+		block->count++;
+		block->cycles += dec->cycles;
+#ifdef CPU_FUSE
+		cpu_fuseMark(block);
+#endif
+		if (((addr + dec->len - 1) >> MEMORY_CODE_SHIFT) != page) {
+			block->page2 = page + 1;
 			break;
+		}
+		if (cpu_decodeflags[dec->opcode] & CPU_DEC_BRANCH) break;
+		ip += dec->len;
+	}
 
-		case 0x11:	/* 11 ADC Ev Gv */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getreg16(cpu, cpu->reg);
-			op_adc16(cpu);
-			writerm16(cpu, cpu->rm, cpu->res16);
-			break;
+	if (block->count == 0) {
+		return 0;
+	}
 
-		case 0x12:	/* 12 ADC Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			op_adc8(cpu);
-			putreg8(cpu, cpu->reg, cpu->res8);
-			break;
+	cpu->memory->codePage[block->page] = 1;
+	cpu->memory->codePage[block->page2] = 1;
+	block->gen = cpu->memory->codeGen[block->page];
+	block->gen2 = cpu->memory->codeGen[block->page2];
+	return 1;
+}
 
-		case 0x13:	/* 13 ADC Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			op_adc16(cpu);
-			putreg16(cpu, cpu->reg, cpu->res16);
-			break;
+CPU_DECODED_t* cpu_cacheLookup(CPU_t* cpu) {
+	CPU_BLOCK_t* block = cpu->block;
+	uint32_t addr;
 
-		case 0x14:	/* 14 ADC cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			op_adc8(cpu);
-			cpu->regs.byteregs[regal] = cpu->res8;
-			break;
+	if (cpu->blocks == NULL) {
+		return NULL;
+	}
 
-		case 0x15:	/* 15 ADC eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			op_adc16(cpu);
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+	/* REP string instructions jump back to themselves */
+	if ((block != NULL) && cpu->blockpos && (block->ins[cpu->blockpos - 1].ip == cpu->ip) && (block->cs == cpu->segregs[regcs]) &&
+		(block->gen == cpu->memory->codeGen[block->page]) && (block->gen2 == cpu->memory->codeGen[block->page2])) {
+		return &block->ins[cpu->blockpos - 1];
+	}
 
-		case 0x16:	/* 16 PUSH cpu->segregs[regss] */
-			push(cpu, cpu->segregs[regss]);
-			break;
+	addr = (segbase(cpu->segregs[regcs]) + cpu->ip) & MEMORY_MASK;
+	block = &cpu->blocks[(addr ^ (addr >> 10)) & (CPU_BLOCK_COUNT - 1)];
+	if (!block->count || (block->cs != cpu->segregs[regcs]) || (block->ip != cpu->ip) ||
+		(block->gen != cpu->memory->codeGen[block->page]) || (block->gen2 != cpu->memory->codeGen[block->page2])) {
+		if (!cpu_cacheBuild(cpu, block)) {
+			cpu->block = NULL;
+			return NULL;
+		}
+	}
 
-		case 0x17:	/* 17 POP cpu->segregs[regss] */
-			cpu->segregs[regss] = pop(cpu);
-			break;
+	cpu->block = block;
+	cpu->blockpos = 1;
+	return &block->ins[0];
+}
+#endif
 
-		case 0x18:	/* 18 SBB Eb Gb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getreg8(cpu, cpu->reg);
-			op_sbb8(cpu);
-			writerm8(cpu, cpu->rm, cpu->res8);
-			break;
+/* fetch and decode the next instruction, from the block cache when possible */
+FUNC_INLINE void cpu_fetch(CPU_t* cpu) {
+#ifdef CPU_BLOCK_CACHE
+	CPU_BLOCK_t* block = cpu->block;
+	CPU_DECODED_t* dec;
 
-		case 0x19:	/* 19 SBB Ev Gv */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getreg16(cpu, cpu->reg);
-			op_sbb16(cpu);
-			writerm16(cpu, cpu->rm, cpu->res16);
-			break;
+	if ((block != NULL) && (cpu->blockpos < block->count) && (block->ins[cpu->blockpos].ip == cpu->ip) && (block->cs == cpu->segregs[regcs]) &&
+		(block->gen == cpu->memory->codeGen[block->page]) && (block->gen2 == cpu->memory->codeGen[block->page2])) {
+		cpu_loaddecoded(cpu, &block->ins[cpu->blockpos++]);
+		return;
+	}
 
-		case 0x1A:	/* 1A SBB Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			op_sbb8(cpu);
-			putreg8(cpu, cpu->reg, cpu->res8);
-			break;
+	dec = cpu_cacheLookup(cpu);
+	if (dec != NULL) {
+		cpu_loaddecoded(cpu, dec);
+		return;
+	}
+#endif
+	cpu_decode(cpu, cpu->ip, &cpu->decoded);
+	cpu_loaddecoded(cpu, &cpu->decoded);
+}
 
-		case 0x1B:	/* 1B SBB Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			op_sbb16(cpu);
-			putreg16(cpu, cpu->reg, cpu->res16);
-			break;
 
-		case 0x1C:	/* 1C SBB cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			op_sbb8(cpu);
-			cpu->regs.byteregs[regal] = cpu->res8;
-			break;
+/* 00 ADD Eb Gb */
+FUNC_INLINE void op_00(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = getreg8(cpu, cpu->reg);
+	op_add8(cpu);
+	writerm8(cpu, cpu->rm, cpu->res8);
+}
 
-		case 0x1D:	/* 1D SBB eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			op_sbb16(cpu);
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+/* 01 ADD Ev Gv */
+FUNC_INLINE void op_01(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = getreg16(cpu, cpu->reg);
+	op_add16(cpu);
+	writerm16(cpu, cpu->rm, cpu->res16);
+}
 
-		case 0x1E:	/* 1E PUSH cpu->segregs[regds] */
-			push(cpu, cpu->segregs[regds]);
-			break;
+/* 02 ADD Gb Eb */
+FUNC_INLINE void op_02(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	op_add8(cpu);
+	putreg8(cpu, cpu->reg, cpu->res8);
+}
 
-		case 0x1F:	/* 1F POP cpu->segregs[regds] */
-			cpu->segregs[regds] = pop(cpu);
-			break;
+/* 03 ADD Gv Ev */
+FUNC_INLINE void op_03(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	op_add16(cpu);
+	putreg16(cpu, cpu->reg, cpu->res16);
+}
 
-		case 0x20:	/* 20 AND Eb Gb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getreg8(cpu, cpu->reg);
-			op_and8(cpu);
-			writerm8(cpu, cpu->rm, cpu->res8);
-			break;
+/* 04 ADD cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_04(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	op_add8(cpu);
+	cpu->regs.byteregs[regal] = cpu->res8;
+}
 
-		case 0x21:	/* 21 AND Ev Gv */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getreg16(cpu, cpu->reg);
-			op_and16(cpu);
-			writerm16(cpu, cpu->rm, cpu->res16);
-			break;
+/* 05 ADD eAX Iv */
+FUNC_INLINE void op_05(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	op_add16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-		case 0x22:	/* 22 AND Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			op_and8(cpu);
-			putreg8(cpu, cpu->reg, cpu->res8);
-			break;
+/* 06 PUSH cpu->segregs[reges] */
+FUNC_INLINE void op_06(CPU_t* cpu) {
+	push(cpu, cpu->segregs[reges]);
+}
 
-		case 0x23:	/* 23 AND Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			op_and16(cpu);
-			putreg16(cpu, cpu->reg, cpu->res16);
-			break;
+/* 07 POP cpu->segregs[reges] */
+FUNC_INLINE void op_07(CPU_t* cpu) {
+	cpu->segregs[reges] = pop(cpu);
+}
 
-		case 0x24:	/* 24 AND cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			op_and8(cpu);
-			cpu->regs.byteregs[regal] = cpu->res8;
-			break;
+/* 08 OR Eb Gb */
+FUNC_INLINE void op_08(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = getreg8(cpu, cpu->reg);
+	op_or8(cpu);
+	writerm8(cpu, cpu->rm, cpu->res8);
+}
 
-		case 0x25:	/* 25 AND eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			op_and16(cpu);
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+/* 09 OR Ev Gv */
+FUNC_INLINE void op_09(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = getreg16(cpu, cpu->reg);
+	op_or16(cpu);
+	writerm16(cpu, cpu->rm, cpu->res16);
+}
 
-		case 0x27:	/* 27 DAA */
-		{
-			uint8_t old_al;
-			old_al = cpu->regs.byteregs[regal];
-			if (((cpu->regs.byteregs[regal] & 0x0F) > 9) || cpu->af) {
-				cpu->oper1 = (uint16_t)cpu->regs.byteregs[regal] + 0x06;
-				cpu->regs.byteregs[regal] = cpu->oper1 & 0xFF;
-				if (cpu->oper1 & 0xFF00) cpu->cf = 1;
-				if ((cpu->oper1 & 0x000F) < (old_al & 0x0F)) cpu->af = 1;
-			}
-			if (((cpu->regs.byteregs[regal] & 0xF0) > 0x90) || cpu->cf) {
-				cpu->oper1 = (uint16_t)cpu->regs.byteregs[regal] + 0x60;
-				cpu->regs.byteregs[regal] = cpu->oper1 & 0xFF;
-				if (cpu->oper1 & 0xFF00) cpu->cf = 1; else cpu->cf = 0;
-			}
-			flag_szp8(cpu, cpu->regs.byteregs[regal]);
-			break;
-		}
+/* 0A OR Gb Eb */
+FUNC_INLINE void op_0A(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	op_or8(cpu);
+	putreg8(cpu, cpu->reg, cpu->res8);
+}
 
-		case 0x28:	/* 28 SUB Eb Gb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getreg8(cpu, cpu->reg);
-			op_sub8(cpu);
-			writerm8(cpu, cpu->rm, cpu->res8);
-			break;
+/* 0B OR Gv Ev */
+FUNC_INLINE void op_0B(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	op_or16(cpu);
+	if ((cpu->oper1 == 0xF802) && (cpu->oper2 == 0xF802)) {
+		flag_sync(cpu);
+		cpu->sf = 0;	/* cheap hack to make Wolf 3D think we're a 286 so it plays */
+	}
 
-		case 0x29:	/* 29 SUB Ev Gv */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getreg16(cpu, cpu->reg);
-			op_sub16(cpu);
-			writerm16(cpu, cpu->rm, cpu->res16);
-			break;
+	putreg16(cpu, cpu->reg, cpu->res16);
+}
 
-		case 0x2A:	/* 2A SUB Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			op_sub8(cpu);
-			putreg8(cpu, cpu->reg, cpu->res8);
-			break;
+/* 0C OR cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_0C(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	op_or8(cpu);
+	cpu->regs.byteregs[regal] = cpu->res8;
+}
 
-		case 0x2B:	/* 2B SUB Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			op_sub16(cpu);
-			putreg16(cpu, cpu->reg, cpu->res16);
-			break;
+/* 0D OR eAX Iv */
+FUNC_INLINE void op_0D(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	op_or16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-		case 0x2C:	/* 2C SUB cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			op_sub8(cpu);
-			cpu->regs.byteregs[regal] = cpu->res8;
-			break;
+/* 0E PUSH cpu->segregs[regcs] */
+FUNC_INLINE void op_0E(CPU_t* cpu) {
+	push(cpu, cpu->segregs[regcs]);
+}
 
-		case 0x2D:	/* 2D SUB eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			op_sub16(cpu);
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+/* 0F POP CS */
+FUNC_INLINE void op_0F(CPU_t* cpu) {
+#ifdef CPU_ALLOW_POP_CS //only the 8086/8088 does this.
+	cpu->segregs[regcs] = pop(cpu);
+#else
+	op_illegal(cpu);
+#endif
+}
 
-		case 0x2F:	/* 2F DAS */
-		{
-			uint8_t old_al;
-			old_al = cpu->regs.byteregs[regal];
-			if (((cpu->regs.byteregs[regal] & 0x0F) > 9) || cpu->af) {
-				cpu->oper1 = (uint16_t)cpu->regs.byteregs[regal] - 0x06;
-				cpu->regs.byteregs[regal] = cpu->oper1 & 0xFF;
-				if (cpu->oper1 & 0xFF00) cpu->cf = 1;
-				if ((cpu->oper1 & 0x000F) >= (old_al & 0x0F)) cpu->af = 1;
-			}
-			if (((cpu->regs.byteregs[regal] & 0xF0) > 0x90) || cpu->cf) {
-				cpu->oper1 = (uint16_t)cpu->regs.byteregs[regal] - 0x60;
-				cpu->regs.byteregs[regal] = cpu->oper1 & 0xFF;
-				if (cpu->oper1 & 0xFF00) cpu->cf = 1; else cpu->cf = 0;
-			}
-			flag_szp8(cpu, cpu->regs.byteregs[regal]);
-			break;
-		}
+/* 10 ADC Eb Gb */
+FUNC_INLINE void op_10(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = getreg8(cpu, cpu->reg);
+	op_adc8(cpu);
+	writerm8(cpu, cpu->rm, cpu->res8);
+}
 
-		case 0x30:	/* 30 XOR Eb Gb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getreg8(cpu, cpu->reg);
-			op_xor8(cpu);
-			writerm8(cpu, cpu->rm, cpu->res8);
-			break;
+/* 11 ADC Ev Gv */
+FUNC_INLINE void op_11(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = getreg16(cpu, cpu->reg);
+	op_adc16(cpu);
+	writerm16(cpu, cpu->rm, cpu->res16);
+}
 
-		case 0x31:	/* 31 XOR Ev Gv */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getreg16(cpu, cpu->reg);
-			op_xor16(cpu);
-			writerm16(cpu, cpu->rm, cpu->res16);
-			break;
+/* 12 ADC Gb Eb */
+FUNC_INLINE void op_12(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	op_adc8(cpu);
+	putreg8(cpu, cpu->reg, cpu->res8);
+}
 
-		case 0x32:	/* 32 XOR Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			op_xor8(cpu);
-			putreg8(cpu, cpu->reg, cpu->res8);
-			break;
+/* 13 ADC Gv Ev */
+FUNC_INLINE void op_13(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	op_adc16(cpu);
+	putreg16(cpu, cpu->reg, cpu->res16);
+}
 
-		case 0x33:	/* 33 XOR Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			op_xor16(cpu);
-			putreg16(cpu, cpu->reg, cpu->res16);
-			break;
+/* 14 ADC cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_14(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	op_adc8(cpu);
+	cpu->regs.byteregs[regal] = cpu->res8;
+}
 
-		case 0x34:	/* 34 XOR cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			op_xor8(cpu);
-			cpu->regs.byteregs[regal] = cpu->res8;
-			break;
+/* 15 ADC eAX Iv */
+FUNC_INLINE void op_15(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	op_adc16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-		case 0x35:	/* 35 XOR eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			op_xor16(cpu);
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+/* 16 PUSH cpu->segregs[regss] */
+FUNC_INLINE void op_16(CPU_t* cpu) {
+	push(cpu, cpu->segregs[regss]);
+}
 
-		case 0x37:	/* 37 AAA ASCII */
-			if (((cpu->regs.byteregs[regal] & 0xF) > 9) || (cpu->af == 1)) {
-				cpu->regs.wordregs[regax] = cpu->regs.wordregs[regax] + 0x106;
-				cpu->af = 1;
-				cpu->cf = 1;
-			}
-			else {
-				cpu->af = 0;
-				cpu->cf = 0;
-			}
+/* 17 POP cpu->segregs[regss] */
+FUNC_INLINE void op_17(CPU_t* cpu) {
+	cpu->segregs[regss] = pop(cpu);
+}
 
-			cpu->regs.byteregs[regal] = cpu->regs.byteregs[regal] & 0xF;
-			break;
+/* 18 SBB Eb Gb */
+FUNC_INLINE void op_18(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = getreg8(cpu, cpu->reg);
+	op_sbb8(cpu);
+	writerm8(cpu, cpu->rm, cpu->res8);
+}
 
-		case 0x38:	/* 38 CMP Eb Gb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getreg8(cpu, cpu->reg);
-			flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
-			break;
+/* 19 SBB Ev Gv */
+FUNC_INLINE void op_19(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = getreg16(cpu, cpu->reg);
+	op_sbb16(cpu);
+	writerm16(cpu, cpu->rm, cpu->res16);
+}
 
-		case 0x39:	/* 39 CMP Ev Gv */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getreg16(cpu, cpu->reg);
-			flag_sub16(cpu, cpu->oper1, cpu->oper2);
-			break;
+/* 1A SBB Gb Eb */
+FUNC_INLINE void op_1A(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	op_sbb8(cpu);
+	putreg8(cpu, cpu->reg, cpu->res8);
+}
 
-		case 0x3A:	/* 3A CMP Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
-			break;
+/* 1B SBB Gv Ev */
+FUNC_INLINE void op_1B(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	op_sbb16(cpu);
+	putreg16(cpu, cpu->reg, cpu->res16);
+}
 
-		case 0x3B:	/* 3B CMP Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			flag_sub16(cpu, cpu->oper1, cpu->oper2);
-			break;
+/* 1C SBB cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_1C(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	op_sbb8(cpu);
+	cpu->regs.byteregs[regal] = cpu->res8;
+}
 
-		case 0x3C:	/* 3C CMP cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
-			break;
+/* 1D SBB eAX Iv */
+FUNC_INLINE void op_1D(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	op_sbb16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-		case 0x3D:	/* 3D CMP eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			flag_sub16(cpu, cpu->oper1, cpu->oper2);
-			break;
+/* 1E PUSH cpu->segregs[regds] */
+FUNC_INLINE void op_1E(CPU_t* cpu) {
+	push(cpu, cpu->segregs[regds]);
+}
 
-		case 0x3F:	/* 3F AAS ASCII */
-			if (((cpu->regs.byteregs[regal] & 0xF) > 9) || (cpu->af == 1)) {
-				cpu->regs.wordregs[regax] = cpu->regs.wordregs[regax] - 6;
-				cpu->regs.byteregs[regah] = cpu->regs.byteregs[regah] - 1;
-				cpu->af = 1;
-				cpu->cf = 1;
-			}
-			else {
-				cpu->af = 0;
-				cpu->cf = 0;
-			}
+/* 1F POP cpu->segregs[regds] */
+FUNC_INLINE void op_1F(CPU_t* cpu) {
+	cpu->segregs[regds] = pop(cpu);
+}
 
-			cpu->regs.byteregs[regal] = cpu->regs.byteregs[regal] & 0xF;
-			break;
+/* 20 AND Eb Gb */
+FUNC_INLINE void op_20(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = getreg8(cpu, cpu->reg);
+	op_and8(cpu);
+	writerm8(cpu, cpu->rm, cpu->res8);
+}
 
-		case 0x40:	/* 40 INC eAX */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = 1;
-			op_add16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+/* 21 AND Ev Gv */
+FUNC_INLINE void op_21(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = getreg16(cpu, cpu->reg);
+	op_and16(cpu);
+	writerm16(cpu, cpu->rm, cpu->res16);
+}
 
-		case 0x41:	/* 41 INC eCX */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regcx];
-			cpu->oper2 = 1;
-			op_add16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regcx] = cpu->res16;
-			break;
+/* 22 AND Gb Eb */
+FUNC_INLINE void op_22(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	op_and8(cpu);
+	putreg8(cpu, cpu->reg, cpu->res8);
+}
 
-		case 0x42:	/* 42 INC eDX */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regdx];
-			cpu->oper2 = 1;
-			op_add16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regdx] = cpu->res16;
-			break;
+/* 23 AND Gv Ev */
+FUNC_INLINE void op_23(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	op_and16(cpu);
+	putreg16(cpu, cpu->reg, cpu->res16);
+}
 
-		case 0x43:	/* 43 INC eBX */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regbx];
-			cpu->oper2 = 1;
-			op_add16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regbx] = cpu->res16;
-			break;
+/* 24 AND cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_24(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	op_and8(cpu);
+	cpu->regs.byteregs[regal] = cpu->res8;
+}
 
-		case 0x44:	/* 44 INC eSP */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regsp];
-			cpu->oper2 = 1;
-			op_add16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regsp] = cpu->res16;
-			break;
+/* 25 AND eAX Iv */
+FUNC_INLINE void op_25(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	op_and16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-		case 0x45:	/* 45 INC eBP */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regbp];
-			cpu->oper2 = 1;
-			op_add16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regbp] = cpu->res16;
-			break;
+/* 27 DAA */
+FUNC_INLINE void op_27(CPU_t* cpu) {
+	uint8_t old_al;
+	flag_sync(cpu);
+	old_al = cpu->regs.byteregs[regal];
+	if (((cpu->regs.byteregs[regal] & 0x0F) > 9) || cpu->af) {
+	cpu->oper1 = (uint16_t)cpu->regs.byteregs[regal] + 0x06;
+	cpu->regs.byteregs[regal] = cpu->oper1 & 0xFF;
+	if (cpu->oper1 & 0xFF00) cpu->cf = 1;
+	if ((cpu->oper1 & 0x000F) < (old_al & 0x0F)) cpu->af = 1;
+	}
+	if (((cpu->regs.byteregs[regal] & 0xF0) > 0x90) || cpu->cf) {
+	cpu->oper1 = (uint16_t)cpu->regs.byteregs[regal] + 0x60;
+	cpu->regs.byteregs[regal] = cpu->oper1 & 0xFF;
+	if (cpu->oper1 & 0xFF00) cpu->cf = 1; else cpu->cf = 0;
+	}
+	flag_szp8(cpu, cpu->regs.byteregs[regal]);
+}
 
-		case 0x46:	/* 46 INC eSI */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regsi];
-			cpu->oper2 = 1;
-			op_add16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regsi] = cpu->res16;
-			break;
+/* 28 SUB Eb Gb */
+FUNC_INLINE void op_28(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = getreg8(cpu, cpu->reg);
+	op_sub8(cpu);
+	writerm8(cpu, cpu->rm, cpu->res8);
+}
 
-		case 0x47:	/* 47 INC eDI */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regdi];
-			cpu->oper2 = 1;
-			op_add16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regdi] = cpu->res16;
-			break;
+/* 29 SUB Ev Gv */
+FUNC_INLINE void op_29(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = getreg16(cpu, cpu->reg);
+	op_sub16(cpu);
+	writerm16(cpu, cpu->rm, cpu->res16);
+}
 
-		case 0x48:	/* 48 DEC eAX */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = 1;
-			op_sub16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regax] = cpu->res16;
-			break;
+/* 2A SUB Gb Eb */
+FUNC_INLINE void op_2A(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	op_sub8(cpu);
+	putreg8(cpu, cpu->reg, cpu->res8);
+}
 
-		case 0x49:	/* 49 DEC eCX */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regcx];
-			cpu->oper2 = 1;
-			op_sub16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regcx] = cpu->res16;
-			break;
+/* 2B SUB Gv Ev */
+FUNC_INLINE void op_2B(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	op_sub16(cpu);
+	putreg16(cpu, cpu->reg, cpu->res16);
+}
 
-		case 0x4A:	/* 4A DEC eDX */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regdx];
-			cpu->oper2 = 1;
-			op_sub16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regdx] = cpu->res16;
-			break;
+/* 2C SUB cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_2C(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	op_sub8(cpu);
+	cpu->regs.byteregs[regal] = cpu->res8;
+}
 
-		case 0x4B:	/* 4B DEC eBX */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regbx];
-			cpu->oper2 = 1;
-			op_sub16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regbx] = cpu->res16;
-			break;
+/* 2D SUB eAX Iv */
+FUNC_INLINE void op_2D(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	op_sub16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-		case 0x4C:	/* 4C DEC eSP */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regsp];
-			cpu->oper2 = 1;
-			op_sub16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regsp] = cpu->res16;
-			break;
+/* 2F DAS */
+FUNC_INLINE void op_2F(CPU_t* cpu) {
+	uint8_t old_al;
+	flag_sync(cpu);
+	old_al = cpu->regs.byteregs[regal];
+	if (((cpu->regs.byteregs[regal] & 0x0F) > 9) || cpu->af) {
+	cpu->oper1 = (uint16_t)cpu->regs.byteregs[regal] - 0x06;
+	cpu->regs.byteregs[regal] = cpu->oper1 & 0xFF;
+	if (cpu->oper1 & 0xFF00) cpu->cf = 1;
+	if ((cpu->oper1 & 0x000F) >= (old_al & 0x0F)) cpu->af = 1;
+	}
+	if (((cpu->regs.byteregs[regal] & 0xF0) > 0x90) || cpu->cf) {
+	cpu->oper1 = (uint16_t)cpu->regs.byteregs[regal] - 0x60;
+	cpu->regs.byteregs[regal] = cpu->oper1 & 0xFF;
+	if (cpu->oper1 & 0xFF00) cpu->cf = 1; else cpu->cf = 0;
+	}
+	flag_szp8(cpu, cpu->regs.byteregs[regal]);
+}
 
-		case 0x4D:	/* 4D DEC eBP */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regbp];
-			cpu->oper2 = 1;
-			op_sub16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regbp] = cpu->res16;
-			break;
+/* 30 XOR Eb Gb */
+FUNC_INLINE void op_30(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = getreg8(cpu, cpu->reg);
+	op_xor8(cpu);
+	writerm8(cpu, cpu->rm, cpu->res8);
+}
 
-		case 0x4E:	/* 4E DEC eSI */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regsi];
-			cpu->oper2 = 1;
-			op_sub16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regsi] = cpu->res16;
-			break;
+/* 31 XOR Ev Gv */
+FUNC_INLINE void op_31(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = getreg16(cpu, cpu->reg);
+	op_xor16(cpu);
+	writerm16(cpu, cpu->rm, cpu->res16);
+}
 
-		case 0x4F:	/* 4F DEC eDI */
-			cpu->oldcf = cpu->cf;
-			cpu->oper1 = cpu->regs.wordregs[regdi];
-			cpu->oper2 = 1;
-			op_sub16(cpu);
-			cpu->cf = cpu->oldcf;
-			cpu->regs.wordregs[regdi] = cpu->res16;
-			break;
+/* 32 XOR Gb Eb */
+FUNC_INLINE void op_32(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	op_xor8(cpu);
+	putreg8(cpu, cpu->reg, cpu->res8);
+}
 
-		case 0x50:	/* 50 PUSH eAX */
-			push(cpu, cpu->regs.wordregs[regax]);
-			break;
+/* 33 XOR Gv Ev */
+FUNC_INLINE void op_33(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	op_xor16(cpu);
+	putreg16(cpu, cpu->reg, cpu->res16);
+}
 
-		case 0x51:	/* 51 PUSH eCX */
-			push(cpu, cpu->regs.wordregs[regcx]);
-			break;
+/* 34 XOR cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_34(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	op_xor8(cpu);
+	cpu->regs.byteregs[regal] = cpu->res8;
+}
 
-		case 0x52:	/* 52 PUSH eDX */
-			push(cpu, cpu->regs.wordregs[regdx]);
-			break;
+/* 35 XOR eAX Iv */
+FUNC_INLINE void op_35(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	op_xor16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-		case 0x53:	/* 53 PUSH eBX */
-			push(cpu, cpu->regs.wordregs[regbx]);
-			break;
+/* 37 AAA ASCII */
+FUNC_INLINE void op_37(CPU_t* cpu) {
+	flag_sync(cpu);
+	if (((cpu->regs.byteregs[regal] & 0xF) > 9) || (cpu->af == 1)) {
+		cpu->regs.wordregs[regax] = cpu->regs.wordregs[regax] + 0x106;
+		cpu->af = 1;
+		cpu->cf = 1;
+	}
+	else {
+		cpu->af = 0;
+		cpu->cf = 0;
+	}
 
-		case 0x54:	/* 54 PUSH eSP */
-#ifdef USE_286_STYLE_PUSH_SP
-			push(cpu, cpu->regs.wordregs[regsp]);
-#else
-			push(cpu, cpu->regs.wordregs[regsp] - 2);
-#endif
-			break;
+	cpu->regs.byteregs[regal] = cpu->regs.byteregs[regal] & 0xF;
+}
 
-		case 0x55:	/* 55 PUSH eBP */
-			push(cpu, cpu->regs.wordregs[regbp]);
-			break;
+/* 38 CMP Eb Gb */
+FUNC_INLINE void op_38(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = getreg8(cpu, cpu->reg);
+	flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
+}
 
-		case 0x56:	/* 56 PUSH eSI */
-			push(cpu, cpu->regs.wordregs[regsi]);
-			break;
+/* 39 CMP Ev Gv */
+FUNC_INLINE void op_39(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = getreg16(cpu, cpu->reg);
+	flag_sub16(cpu, cpu->oper1, cpu->oper2);
+}
 
-		case 0x57:	/* 57 PUSH eDI */
-			push(cpu, cpu->regs.wordregs[regdi]);
-			break;
+/* 3A CMP Gb Eb */
+FUNC_INLINE void op_3A(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
+}
 
-		case 0x58:	/* 58 POP eAX */
-			cpu->regs.wordregs[regax] = pop(cpu);
-			break;
+/* 3B CMP Gv Ev */
+FUNC_INLINE void op_3B(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	flag_sub16(cpu, cpu->oper1, cpu->oper2);
+}
 
-		case 0x59:	/* 59 POP eCX */
-			cpu->regs.wordregs[regcx] = pop(cpu);
-			break;
+/* 3C CMP cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_3C(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
+}
 
-		case 0x5A:	/* 5A POP eDX */
-			cpu->regs.wordregs[regdx] = pop(cpu);
-			break;
+/* 3D CMP eAX Iv */
+FUNC_INLINE void op_3D(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	flag_sub16(cpu, cpu->oper1, cpu->oper2);
+}
 
-		case 0x5B:	/* 5B POP eBX */
-			cpu->regs.wordregs[regbx] = pop(cpu);
-			break;
+/* 3F AAS ASCII */
+FUNC_INLINE void op_3F(CPU_t* cpu) {
+	flag_sync(cpu);
+	if (((cpu->regs.byteregs[regal] & 0xF) > 9) || (cpu->af == 1)) {
+		cpu->regs.wordregs[regax] = cpu->regs.wordregs[regax] - 6;
+		cpu->regs.byteregs[regah] = cpu->regs.byteregs[regah] - 1;
+		cpu->af = 1;
+		cpu->cf = 1;
+	}
+	else {
+		cpu->af = 0;
+		cpu->cf = 0;
+	}
 
-		case 0x5C:	/* 5C POP eSP */
-			cpu->regs.wordregs[regsp] = pop(cpu);
-			break;
+	cpu->regs.byteregs[regal] = cpu->regs.byteregs[regal] & 0xF;
+}
 
-		case 0x5D:	/* 5D POP eBP */
-			cpu->regs.wordregs[regbp] = pop(cpu);
-			break;
+/* 40 INC eAX */
+FUNC_INLINE void op_40(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-		case 0x5E:	/* 5E POP eSI */
-			cpu->regs.wordregs[regsi] = pop(cpu);
-			break;
+/* 41 INC eCX */
+FUNC_INLINE void op_41(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regcx];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[regcx] = cpu->res16;
+}
 
-		case 0x5F:	/* 5F POP eDI */
-			cpu->regs.wordregs[regdi] = pop(cpu);
-			break;
+/* 42 INC eDX */
+FUNC_INLINE void op_42(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdx];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[regdx] = cpu->res16;
+}
 
-#ifndef CPU_8086
-		case 0x60:	/* 60 PUSHA (80186+) */
-			cpu->oldsp = cpu->regs.wordregs[regsp];
-			push(cpu, cpu->regs.wordregs[regax]);
-			push(cpu, cpu->regs.wordregs[regcx]);
-			push(cpu, cpu->regs.wordregs[regdx]);
-			push(cpu, cpu->regs.wordregs[regbx]);
-			push(cpu, cpu->oldsp);
-			push(cpu, cpu->regs.wordregs[regbp]);
-			push(cpu, cpu->regs.wordregs[regsi]);
-			push(cpu, cpu->regs.wordregs[regdi]);
-			break;
+/* 43 INC eBX */
+FUNC_INLINE void op_43(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regbx];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[regbx] = cpu->res16;
+}
 
-		case 0x61:	/* 61 POPA (80186+) */
-			cpu->regs.wordregs[regdi] = pop(cpu);
-			cpu->regs.wordregs[regsi] = pop(cpu);
-			cpu->regs.wordregs[regbp] = pop(cpu);
-			cpu->regs.wordregs[regsp] += 2;
-			cpu->regs.wordregs[regbx] = pop(cpu);
-			cpu->regs.wordregs[regdx] = pop(cpu);
-			cpu->regs.wordregs[regcx] = pop(cpu);
-			cpu->regs.wordregs[regax] = pop(cpu);
-			break;
+/* 44 INC eSP */
+FUNC_INLINE void op_44(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regsp];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[regsp] = cpu->res16;
+}
 
-		case 0x62: /* 62 BOUND Gv, Ev (80186+) */
-			modregrm(cpu);
-			getea(cpu, cpu->rm);
-			if (signext32(getreg16(cpu, cpu->reg)) < signext32(getmem16(cpu, cpu->ea >> 4, cpu->ea & 15))) {
-				cpu_intcall(cpu, 5); //bounds check exception
-			}
-			else {
-				cpu->ea += 2;
-				if (signext32(getreg16(cpu, cpu->reg)) > signext32(getmem16(cpu, cpu->ea >> 4, cpu->ea & 15))) {
-					cpu_intcall(cpu, 5); //bounds check exception
-				}
-			}
-			break;
+/* 45 INC eBP */
+FUNC_INLINE void op_45(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regbp];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[regbp] = cpu->res16;
+}
 
-		case 0x68:	/* 68 PUSH Iv (80186+) */
-			push(cpu, getmem16(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 2);
-			break;
+/* 46 INC eSI */
+FUNC_INLINE void op_46(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regsi];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[regsi] = cpu->res16;
+}
 
-		case 0x69:	/* 69 IMUL Gv Ev Iv (80186+) */
-			modregrm(cpu);
-			cpu->temp1 = readrm16(cpu, cpu->rm);
-			cpu->temp2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			if ((cpu->temp1 & 0x8000L) == 0x8000L) {
-				cpu->temp1 = cpu->temp1 | 0xFFFF0000L;
-			}
+/* 47 INC eDI */
+FUNC_INLINE void op_47(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdi];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[regdi] = cpu->res16;
+}
 
-			if ((cpu->temp2 & 0x8000L) == 0x8000L) {
-				cpu->temp2 = cpu->temp2 | 0xFFFF0000L;
-			}
+/* 48 DEC eAX */
+FUNC_INLINE void op_48(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[regax] = cpu->res16;
+}
 
-			cpu->temp3 = cpu->temp1 * cpu->temp2;
-			putreg16(cpu, cpu->reg, cpu->temp3 & 0xFFFFL);
-			if (cpu->temp3 & 0xFFFF0000L) {
-				cpu->cf = 1;
-				cpu->of = 1;
-			}
-			else {
-				cpu->cf = 0;
-				cpu->of = 0;
-			}
-			break;
+/* 49 DEC eCX */
+FUNC_INLINE void op_49(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regcx];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[regcx] = cpu->res16;
+}
 
-		case 0x6A:	/* 6A PUSH Ib (80186+) */
-			push(cpu, (uint16_t)signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip)));
-			StepIP(cpu, 1);
-			break;
+/* 4A DEC eDX */
+FUNC_INLINE void op_4A(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdx];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[regdx] = cpu->res16;
+}
+
+/* 4B DEC eBX */
+FUNC_INLINE void op_4B(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regbx];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[regbx] = cpu->res16;
+}
+
+/* 4C DEC eSP */
+FUNC_INLINE void op_4C(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regsp];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[regsp] = cpu->res16;
+}
+
+/* 4D DEC eBP */
+FUNC_INLINE void op_4D(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regbp];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[regbp] = cpu->res16;
+}
+
+/* 4E DEC eSI */
+FUNC_INLINE void op_4E(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regsi];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[regsi] = cpu->res16;
+}
+
+/* 4F DEC eDI */
+FUNC_INLINE void op_4F(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdi];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[regdi] = cpu->res16;
+}
+
+/* 50 PUSH eAX */
+FUNC_INLINE void op_50(CPU_t* cpu) {
+	push(cpu, cpu->regs.wordregs[regax]);
+}
+
+/* 51 PUSH eCX */
+FUNC_INLINE void op_51(CPU_t* cpu) {
+	push(cpu, cpu->regs.wordregs[regcx]);
+}
+
+/* 52 PUSH eDX */
+FUNC_INLINE void op_52(CPU_t* cpu) {
+	push(cpu, cpu->regs.wordregs[regdx]);
+}
+
+/* 53 PUSH eBX */
+FUNC_INLINE void op_53(CPU_t* cpu) {
+	push(cpu, cpu->regs.wordregs[regbx]);
+}
+
+/* 54 PUSH eSP */
+FUNC_INLINE void op_54(CPU_t* cpu) {
+#ifdef USE_286_STYLE_PUSH_SP
+	push(cpu, cpu->regs.wordregs[regsp]);
+#else
+	push(cpu, cpu->regs.wordregs[regsp] - 2);
+#endif
+}
+
+/* 55 PUSH eBP */
+FUNC_INLINE void op_55(CPU_t* cpu) {
+	push(cpu, cpu->regs.wordregs[regbp]);
+}
+
+/* 56 PUSH eSI */
+FUNC_INLINE void op_56(CPU_t* cpu) {
+	push(cpu, cpu->regs.wordregs[regsi]);
+}
+
+/* 57 PUSH eDI */
+FUNC_INLINE void op_57(CPU_t* cpu) {
+	push(cpu, cpu->regs.wordregs[regdi]);
+}
+
+/* 58 POP eAX */
+FUNC_INLINE void op_58(CPU_t* cpu) {
+	cpu->regs.wordregs[regax] = pop(cpu);
+}
+
+/* 59 POP eCX */
+FUNC_INLINE void op_59(CPU_t* cpu) {
+	cpu->regs.wordregs[regcx] = pop(cpu);
+}
+
+/* 5A POP eDX */
+FUNC_INLINE void op_5A(CPU_t* cpu) {
+	cpu->regs.wordregs[regdx] = pop(cpu);
+}
+
+/* 5B POP eBX */
+FUNC_INLINE void op_5B(CPU_t* cpu) {
+	cpu->regs.wordregs[regbx] = pop(cpu);
+}
+
+/* 5C POP eSP */
+FUNC_INLINE void op_5C(CPU_t* cpu) {
+	cpu->regs.wordregs[regsp] = pop(cpu);
+}
+
+/* 5D POP eBP */
+FUNC_INLINE void op_5D(CPU_t* cpu) {
+	cpu->regs.wordregs[regbp] = pop(cpu);
+}
+
+/* 5E POP eSI */
+FUNC_INLINE void op_5E(CPU_t* cpu) {
+	cpu->regs.wordregs[regsi] = pop(cpu);
+}
+
+/* 5F POP eDI */
+FUNC_INLINE void op_5F(CPU_t* cpu) {
+	cpu->regs.wordregs[regdi] = pop(cpu);
+}
+
+#ifndef CPU_8086
+
+/* 60 PUSHA (80186+) */
+FUNC_INLINE void op_60(CPU_t* cpu) {
+	cpu->oldsp = cpu->regs.wordregs[regsp];
+	push(cpu, cpu->regs.wordregs[regax]);
+	push(cpu, cpu->regs.wordregs[regcx]);
+	push(cpu, cpu->regs.wordregs[regdx]);
+	push(cpu, cpu->regs.wordregs[regbx]);
+	push(cpu, cpu->oldsp);
+	push(cpu, cpu->regs.wordregs[regbp]);
+	push(cpu, cpu->regs.wordregs[regsi]);
+	push(cpu, cpu->regs.wordregs[regdi]);
+}
+
+/* 61 POPA (80186+) */
+FUNC_INLINE void op_61(CPU_t* cpu) {
+	cpu->regs.wordregs[regdi] = pop(cpu);
+	cpu->regs.wordregs[regsi] = pop(cpu);
+	cpu->regs.wordregs[regbp] = pop(cpu);
+	cpu->regs.wordregs[regsp] += 2;
+	cpu->regs.wordregs[regbx] = pop(cpu);
+	cpu->regs.wordregs[regdx] = pop(cpu);
+	cpu->regs.wordregs[regcx] = pop(cpu);
+	cpu->regs.wordregs[regax] = pop(cpu);
+}
+
+/* 62 BOUND Gv, Ev (80186+) */
+FUNC_INLINE void op_62(CPU_t* cpu) {
+	getea(cpu, cpu->rm);
+	if (signext32(getreg16(cpu, cpu->reg)) < signext32(getmem16(cpu, cpu->ea >> 4, cpu->ea & 15))) {
+		cpu_intcall(cpu, 5); //bounds check exception
+	}
+	else {
+		cpu->ea += 2;
+		if (signext32(getreg16(cpu, cpu->reg)) > signext32(getmem16(cpu, cpu->ea >> 4, cpu->ea & 15))) {
+			cpu_intcall(cpu, 5); //bounds check exception
+		}
+	}
+}
+
+/* 68 PUSH Iv (80186+) */
+FUNC_INLINE void op_68(CPU_t* cpu) {
+	push(cpu, cpu->imm);
+}
+
+/* 69 IMUL Gv Ev Iv (80186+) */
+FUNC_INLINE void op_69(CPU_t* cpu) {
+	cpu->temp1 = readrm16(cpu, cpu->rm);
+	cpu->temp2 = cpu->imm;
+	if ((cpu->temp1 & 0x8000L) == 0x8000L) {
+		cpu->temp1 = cpu->temp1 | 0xFFFF0000L;
+	}
+
+	if ((cpu->temp2 & 0x8000L) == 0x8000L) {
+		cpu->temp2 = cpu->temp2 | 0xFFFF0000L;
+	}
+
+	cpu->temp3 = cpu->temp1 * cpu->temp2;
+	putreg16(cpu, cpu->reg, cpu->temp3 & 0xFFFFL);
+	flag_sync(cpu);
+	if (cpu->temp3 & 0xFFFF0000L) {
+		cpu->cf = 1;
+		cpu->of = 1;
+	}
+	else {
+		cpu->cf = 0;
+		cpu->of = 0;
+	}
+}
+
+/* 6A PUSH Ib (80186+) */
+FUNC_INLINE void op_6A(CPU_t* cpu) {
+	push(cpu, (uint16_t)signext(cpu->imm));
+}
+
+/* 6B IMUL Gv Eb Ib (80186+) */
+FUNC_INLINE void op_6B(CPU_t* cpu) {
+	cpu->temp1 = readrm16(cpu, cpu->rm);
+	cpu->temp2 = signext(cpu->imm);
+	if ((cpu->temp1 & 0x8000L) == 0x8000L) {
+		cpu->temp1 = cpu->temp1 | 0xFFFF0000L;
+	}
+
+	if ((cpu->temp2 & 0x8000L) == 0x8000L) {
+		cpu->temp2 = cpu->temp2 | 0xFFFF0000L;
+	}
+
+	cpu->temp3 = cpu->temp1 * cpu->temp2;
+	putreg16(cpu, cpu->reg, cpu->temp3 & 0xFFFFL);
+	flag_sync(cpu);
+	if (cpu->temp3 & 0xFFFF0000L) {
+		cpu->cf = 1;
+		cpu->of = 1;
+	}
+	else {
+		cpu->cf = 0;
+		cpu->of = 0;
+	}
+}
+
+/* 6C INSB */
+FUNC_INLINE void op_6C(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+
+	putmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], port_read(cpu, cpu->regs.wordregs[regdx]));
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
+	}
+
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
+
+	if (!cpu->reptype) {
+		return;
+	}
+
+	cpu->ip = cpu->firstip;
+}
+
+/* 6D INSW */
+FUNC_INLINE void op_6D(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+
+	putmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], port_readw(cpu, cpu->regs.wordregs[regdx]));
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
+	}
+
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
+
+	if (!cpu->reptype) {
+		return;
+	}
+
+	cpu->ip = cpu->firstip;
+}
+
+/* 6E OUTSB */
+FUNC_INLINE void op_6E(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+
+	port_write(cpu, cpu->regs.wordregs[regdx], getmem8(cpu, cpu->useseg, cpu->regs.wordregs[regsi]));
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
+	}
+
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
+
+	if (!cpu->reptype) {
+		return;
+	}
+
+	cpu->ip = cpu->firstip;
+}
+
+/* 6F OUTSW */
+FUNC_INLINE void op_6F(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+
+	port_writew(cpu, cpu->regs.wordregs[regdx], getmem16(cpu, cpu->useseg, cpu->regs.wordregs[regsi]));
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
+	}
+
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
+
+	if (!cpu->reptype) {
+		return;
+	}
+
+	cpu->ip = cpu->firstip;
+}
+
+#endif
+
+/* 70 JO Jb */
+FUNC_INLINE void op_70(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (flag_getof(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 71 JNO Jb */
+FUNC_INLINE void op_71(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (!flag_getof(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 72 JB Jb */
+FUNC_INLINE void op_72(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (flag_getcf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 73 JNB Jb */
+FUNC_INLINE void op_73(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (!flag_getcf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 74 JZ Jb */
+FUNC_INLINE void op_74(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (flag_getzf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 75 JNZ Jb */
+FUNC_INLINE void op_75(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (!flag_getzf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 76 JBE Jb */
+FUNC_INLINE void op_76(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (flag_getcf(cpu) || flag_getzf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 77 JA Jb */
+FUNC_INLINE void op_77(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (!flag_getcf(cpu) && !flag_getzf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 78 JS Jb */
+FUNC_INLINE void op_78(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (flag_getsf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 79 JNS Jb */
+FUNC_INLINE void op_79(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (!flag_getsf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 7A JPE Jb */
+FUNC_INLINE void op_7A(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (flag_getpf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 7B JPO Jb */
+FUNC_INLINE void op_7B(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (!flag_getpf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 7C JL Jb */
+FUNC_INLINE void op_7C(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (flag_getsf(cpu) != flag_getof(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 7D JGE Jb */
+FUNC_INLINE void op_7D(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (flag_getsf(cpu) == flag_getof(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 7E JLE Jb */
+FUNC_INLINE void op_7E(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if ((flag_getsf(cpu) != flag_getof(cpu)) || flag_getzf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 7F JG Jb */
+FUNC_INLINE void op_7F(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (!flag_getzf(cpu) && (flag_getsf(cpu) == flag_getof(cpu))) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
+
+/* 80/82 GRP1 Eb Ib */
+FUNC_INLINE void op_80(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = cpu->imm;
+	switch (cpu->reg) {
+	case 0:
+		op_add8(cpu);
+		break;
+	case 1:
+		op_or8(cpu);
+		break;
+	case 2:
+		op_adc8(cpu);
+		break;
+	case 3:
+		op_sbb8(cpu);
+		break;
+	case 4:
+		op_and8(cpu);
+		break;
+	case 5:
+		op_sub8(cpu);
+		break;
+	case 6:
+		op_xor8(cpu);
+		break;
+	case 7:
+		flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
+		break;
+	default:
+		break;	/* to avoid compiler warnings */
+	}
+
+	if (cpu->reg < 7) {
+		writerm8(cpu, cpu->rm, cpu->res8);
+	}
+}
+
+/* 81 GRP1 Ev Iv, 83 GRP1 Ev Ib */
+FUNC_INLINE void op_81(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	if (cpu->opcode == 0x81) {
+		cpu->oper2 = cpu->imm;
+	}
+	else {
+		cpu->oper2 = signext(cpu->imm);
+	}
+
+	switch (cpu->reg) {
+	case 0:
+		op_add16(cpu);
+		break;
+	case 1:
+		op_or16(cpu);
+		break;
+	case 2:
+		op_adc16(cpu);
+		break;
+	case 3:
+		op_sbb16(cpu);
+		break;
+	case 4:
+		op_and16(cpu);
+		break;
+	case 5:
+		op_sub16(cpu);
+		break;
+	case 6:
+		op_xor16(cpu);
+		break;
+	case 7:
+		flag_sub16(cpu, cpu->oper1, cpu->oper2);
+		break;
+	default:
+		break;	/* to avoid compiler warnings */
+	}
+
+	if (cpu->reg < 7) {
+		writerm16(cpu, cpu->rm, cpu->res16);
+	}
+}
+
+/* 84 TEST Gb Eb */
+FUNC_INLINE void op_84(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	cpu->oper2b = readrm8(cpu, cpu->rm);
+	flag_log8(cpu, cpu->oper1b & cpu->oper2b);
+}
+
+/* 85 TEST Gv Ev */
+FUNC_INLINE void op_85(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	cpu->oper2 = readrm16(cpu, cpu->rm);
+	flag_log16(cpu, cpu->oper1 & cpu->oper2);
+}
+
+/* 86 XCHG Gb Eb */
+FUNC_INLINE void op_86(CPU_t* cpu) {
+	cpu->oper1b = getreg8(cpu, cpu->reg);
+	putreg8(cpu, cpu->reg, readrm8(cpu, cpu->rm));
+	writerm8(cpu, cpu->rm, cpu->oper1b);
+}
+
+/* 87 XCHG Gv Ev */
+FUNC_INLINE void op_87(CPU_t* cpu) {
+	cpu->oper1 = getreg16(cpu, cpu->reg);
+	putreg16(cpu, cpu->reg, readrm16(cpu, cpu->rm));
+	writerm16(cpu, cpu->rm, cpu->oper1);
+}
+
+/* 88 MOV Eb Gb */
+FUNC_INLINE void op_88(CPU_t* cpu) {
+	writerm8(cpu, cpu->rm, getreg8(cpu, cpu->reg));
+}
+
+/* 89 MOV Ev Gv */
+FUNC_INLINE void op_89(CPU_t* cpu) {
+	writerm16(cpu, cpu->rm, getreg16(cpu, cpu->reg));
+}
+
+/* 8A MOV Gb Eb */
+FUNC_INLINE void op_8A(CPU_t* cpu) {
+	putreg8(cpu, cpu->reg, readrm8(cpu, cpu->rm));
+}
+
+/* 8B MOV Gv Ev */
+FUNC_INLINE void op_8B(CPU_t* cpu) {
+	putreg16(cpu, cpu->reg, readrm16(cpu, cpu->rm));
+}
+
+/* 8C MOV Ew Sw */
+FUNC_INLINE void op_8C(CPU_t* cpu) {
+	writerm16(cpu, cpu->rm, getsegreg(cpu, cpu->reg));
+}
+
+/* 8D LEA Gv M */
+FUNC_INLINE void op_8D(CPU_t* cpu) {
+	getea(cpu, cpu->rm);
+	putreg16(cpu, cpu->reg, cpu->ea - segbase(cpu->useseg));
+}
+
+/* 8E MOV Sw Ew */
+FUNC_INLINE void op_8E(CPU_t* cpu) {
+	putsegreg(cpu, cpu->reg, readrm16(cpu, cpu->rm));
+}
+
+/* 8F POP Ev */
+FUNC_INLINE void op_8F(CPU_t* cpu) {
+	writerm16(cpu, cpu->rm, pop(cpu));
+}
+
+/* 90 NOP */
+FUNC_INLINE void op_90(CPU_t* cpu) {
+}
+
+/* 91 XCHG eCX eAX */
+FUNC_INLINE void op_91(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regcx];
+	cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regax];
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
+
+/* 92 XCHG eDX eAX */
+FUNC_INLINE void op_92(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdx];
+	cpu->regs.wordregs[regdx] = cpu->regs.wordregs[regax];
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
+
+/* 93 XCHG eBX eAX */
+FUNC_INLINE void op_93(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regbx];
+	cpu->regs.wordregs[regbx] = cpu->regs.wordregs[regax];
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
+
+/* 94 XCHG eSP eAX */
+FUNC_INLINE void op_94(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regsp];
+	cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regax];
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
+
+/* 95 XCHG eBP eAX */
+FUNC_INLINE void op_95(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regbp];
+	cpu->regs.wordregs[regbp] = cpu->regs.wordregs[regax];
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
+
+/* 96 XCHG eSI eAX */
+FUNC_INLINE void op_96(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regsi];
+	cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regax];
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
+
+/* 97 XCHG eDI eAX */
+FUNC_INLINE void op_97(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdi];
+	cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regax];
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
 
-		case 0x6B:	/* 6B IMUL Gv Eb Ib (80186+) */
-			modregrm(cpu);
-			cpu->temp1 = readrm16(cpu, cpu->rm);
-			cpu->temp2 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if ((cpu->temp1 & 0x8000L) == 0x8000L) {
-				cpu->temp1 = cpu->temp1 | 0xFFFF0000L;
-			}
+/* 98 CBW */
+FUNC_INLINE void op_98(CPU_t* cpu) {
+	if ((cpu->regs.byteregs[regal] & 0x80) == 0x80) {
+		cpu->regs.byteregs[regah] = 0xFF;
+	}
+	else {
+		cpu->regs.byteregs[regah] = 0;
+	}
+}
 
-			if ((cpu->temp2 & 0x8000L) == 0x8000L) {
-				cpu->temp2 = cpu->temp2 | 0xFFFF0000L;
-			}
+/* 99 CWD */
+FUNC_INLINE void op_99(CPU_t* cpu) {
+	if ((cpu->regs.byteregs[regah] & 0x80) == 0x80) {
+		cpu->regs.wordregs[regdx] = 0xFFFF;
+	}
+	else {
+		cpu->regs.wordregs[regdx] = 0;
+	}
+}
 
-			cpu->temp3 = cpu->temp1 * cpu->temp2;
-			putreg16(cpu, cpu->reg, cpu->temp3 & 0xFFFFL);
-			if (cpu->temp3 & 0xFFFF0000L) {
-				cpu->cf = 1;
-				cpu->of = 1;
-			}
-			else {
-				cpu->cf = 0;
-				cpu->of = 0;
-			}
-			break;
+/* 9A CALL Ap */
+FUNC_INLINE void op_9A(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->oper2 = cpu->imm2;
+	push(cpu, cpu->segregs[regcs]);
+	push(cpu, cpu->ip);
+	cpu->ip = cpu->oper1;
+	cpu->segregs[regcs] = cpu->oper2;
+}
 
-		case 0x6C:	/* 6E INSB */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+/* 9B WAIT */
+FUNC_INLINE void op_9B(CPU_t* cpu) {
+}
 
-			putmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], port_read(cpu, cpu->regs.wordregs[regdx]));
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
-			}
+/* 9C PUSHF */
+FUNC_INLINE void op_9C(CPU_t* cpu) {
+#ifdef CPU_SET_HIGH_FLAGS
+	push(cpu, makeflagsword(cpu) | 0xF800);
+#else
+	push(cpu, makeflagsword(cpu) | 0x0800);
+#endif
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* 9D POPF */
+FUNC_INLINE void op_9D(CPU_t* cpu) {
+	cpu->temp16 = pop(cpu);
+	decodeflagsword(cpu, cpu->temp16);
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* 9E SAHF */
+FUNC_INLINE void op_9E(CPU_t* cpu) {
+	decodeflagsword(cpu, (makeflagsword(cpu) & 0xFF00) | cpu->regs.byteregs[regah]);
+}
 
-			cpu->ip = firstip;
-			break;
+/* 9F LAHF */
+FUNC_INLINE void op_9F(CPU_t* cpu) {
+	cpu->regs.byteregs[regah] = makeflagsword(cpu) & 0xFF;
+}
 
-		case 0x6D:	/* 6F INSW */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+/* A0 MOV cpu->regs.byteregs[regal] Ob */
+FUNC_INLINE void op_A0(CPU_t* cpu) {
+	cpu->regs.byteregs[regal] = getmem8(cpu, cpu->useseg, cpu->imm);
+}
 
-			putmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], port_readw(cpu, cpu->regs.wordregs[regdx]));
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
-			}
+/* A1 MOV eAX Ov */
+FUNC_INLINE void op_A1(CPU_t* cpu) {
+	cpu->oper1 = getmem16(cpu, cpu->useseg, cpu->imm);
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* A2 MOV Ob cpu->regs.byteregs[regal] */
+FUNC_INLINE void op_A2(CPU_t* cpu) {
+	putmem8(cpu, cpu->useseg, cpu->imm, cpu->regs.byteregs[regal]);
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* A3 MOV Ov eAX */
+FUNC_INLINE void op_A3(CPU_t* cpu) {
+	putmem16(cpu, cpu->useseg, cpu->imm, cpu->regs.wordregs[regax]);
+}
 
-			cpu->ip = firstip;
-			break;
+#ifdef CPU_REP_BULK
+/*
+	REP string instructions over plain memory run as many iterations as the cycle budget allows
+	in one go, instead of going back through dispatch for each element. Registers, flags, cycles
+	and memory end up exactly as if the iterations had been run one at a time.
+*/
 
-		case 0x6E:	/* 6E OUTSB */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+/* iterations of the current REP instruction that would run before the cycle budget is used up, counting this one */
+FUNC_INLINE uint16_t cpu_repCount(CPU_t* cpu) {
+	uint32_t extra;
 
-			port_write(cpu, cpu->regs.wordregs[regdx], getmem8(cpu, cpu->useseg, cpu->regs.wordregs[regsi]));
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
-			}
+	if (cpu->tf || !cpu->repcycles) {
+		return 1;
+	}
+	extra = (cpu->cycles < cpu->budget) ? ((cpu->budget - cpu->cycles + cpu->repcycles - 1) / cpu->repcycles) : 0;
+	if (extra >= cpu->regs.wordregs[regcx]) {
+		return cpu->regs.wordregs[regcx];
+	}
+	return (uint16_t)(extra + 1);
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* host pointer to the element at seg:ofs, cuts count down to how many elements from there in the DF direction stay in the same code page of plain memory */
+FUNC_INLINE uint8_t* cpu_repSpan(CPU_t* cpu, uint16_t seg, uint16_t ofs, uint8_t size, uint8_t write, uint16_t* count) {
+	uint32_t addr = (segbase(seg) + ofs) & MEMORY_MASK, page = addr >> MEMORY_CODE_SHIFT, span;
+	uint8_t* host;
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+	if ((((addr + size - 1) >> MEMORY_CODE_SHIFT) != page) || (((uint32_t)ofs + size) > 0x10000)) {
+		return NULL;
+	}
 
-			cpu->ip = firstip;
-			break;
+	host = write ? cpu->memory->pageWrite[addr >> MEMORY_PAGE_SHIFT] : cpu->memory->pageRead[addr >> MEMORY_PAGE_SHIFT];
+	if ((host == NULL) || (write && cpu->memory->codePage[page])) { //writes to cached code go the slow way so the cache sees them
+		return NULL;
+	}
 
-		case 0x6F:	/* 6F OUTSW */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+	if (cpu->df) {
+		span = (addr & ((1 << MEMORY_CODE_SHIFT) - 1)) / size + 1;
+		if (span > ((uint32_t)ofs / size + 1)) {
+			span = ofs / size + 1;
+		}
+	}
+	else {
+		span = (((page + 1) << MEMORY_CODE_SHIFT) - addr) / size;
+		if (span > ((0x10000 - (uint32_t)ofs) / size)) {
+			span = (0x10000 - ofs) / size;
+		}
+	}
 
-			port_writew(cpu, cpu->regs.wordregs[regdx], getmem16(cpu, cpu->useseg, cpu->regs.wordregs[regsi]));
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
-			}
+	if (span < *count) {
+		*count = (uint16_t)span;
+	}
+	return host + (addr & MEMORY_PAGE_MASK);
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* account for the iterations that ran, stop is set when CMPS/SCAS ended the repeat on the zero flag */
+FUNC_INLINE uint8_t cpu_repFinish(CPU_t* cpu, uint16_t done, uint8_t stop) {
+	cpu->regs.wordregs[regcx] -= done;
+	cpu->cycles += (uint32_t)(done - 1) * cpu->repcycles;
+	cpu->totalexec += done - 1;
+	if (!stop) {
+		cpu->ip = cpu->firstip;
+	}
+	return 1;
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+FUNC_INLINE uint8_t cpu_repMovs(CPU_t* cpu, uint8_t size) {
+	uint16_t count = cpu_repCount(cpu), done = 0, n, i;
+	int32_t step = cpu->df ? -(int32_t)size : size;
+	uint32_t len;
+	uint8_t *src, *dst, lo, hi;
 
-			cpu->ip = firstip;
-			break;
-#endif
+	if (count < 2) {
+		return 0;
+	}
 
-		case 0x70:	/* 70 JO Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (cpu->of) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
+	while (done < count) {
+		n = count - done;
+		src = cpu_repSpan(cpu, cpu->useseg, cpu->regs.wordregs[regsi], size, 0, &n);
+		dst = cpu_repSpan(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], size, 1, &n);
+		if ((src == NULL) || (dst == NULL)) {
 			break;
+		}
 
-		case 0x71:	/* 71 JNO Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (!cpu->of) {
-				cpu->ip = cpu->ip + cpu->temp16;
+		len = (uint32_t)n * size;
+		if (!cpu->df && ((dst <= src) || (dst >= (src + len)))) {
+			memmove(dst, src, len);
+		}
+		else if (cpu->df && ((dst >= src) || ((dst + len) <= src))) {
+			memmove(dst - len + size, src - len + size, len);
+		}
+		else { //overlapping the way that repeats a pattern, so it has to go an element at a time
+			for (i = 0; i < n; i++) {
+				lo = src[0];
+				hi = (size == 2) ? src[1] : 0;
+				dst[0] = lo;
+				if (size == 2) {
+					dst[1] = hi;
+				}
+				src += step;
+				dst += step;
 			}
-			break;
+		}
 
-		case 0x72:	/* 72 JB Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (cpu->cf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+		cpu->regs.wordregs[regsi] += (uint16_t)(step * n);
+		cpu->regs.wordregs[regdi] += (uint16_t)(step * n);
+		done += n;
+	}
 
-		case 0x73:	/* 73 JNB Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (!cpu->cf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+	if (!done) {
+		return 0;
+	}
+	return cpu_repFinish(cpu, done, 0);
+}
 
-		case 0x74:	/* 74 JZ Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (cpu->zf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+FUNC_INLINE uint8_t cpu_repStos(CPU_t* cpu, uint8_t size) {
+	uint16_t count = cpu_repCount(cpu), done = 0, n, i;
+	int32_t step = cpu->df ? -(int32_t)size : size;
+	uint8_t *dst, lo = cpu->regs.byteregs[regal], hi = cpu->regs.byteregs[regah];
 
-		case 0x75:	/* 75 JNZ Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (!cpu->zf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+	if (count < 2) {
+		return 0;
+	}
 
-		case 0x76:	/* 76 JBE Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (cpu->cf || cpu->zf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
+	while (done < count) {
+		n = count - done;
+		dst = cpu_repSpan(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], size, 1, &n);
+		if (dst == NULL) {
 			break;
+		}
 
-		case 0x77:	/* 77 JA Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (!cpu->cf && !cpu->zf) {
-				cpu->ip = cpu->ip + cpu->temp16;
+		if ((size == 1) || (lo == hi)) {
+			memset(cpu->df ? (dst - (uint32_t)n * size + size) : dst, lo, (uint32_t)n * size);
+		}
+		else {
+			for (i = 0; i < n; i++) {
+				dst[0] = lo;
+				dst[1] = hi;
+				dst += step;
 			}
-			break;
+		}
 
-		case 0x78:	/* 78 JS Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (cpu->sf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+		cpu->regs.wordregs[regdi] += (uint16_t)(step * n);
+		done += n;
+	}
 
-		case 0x79:	/* 79 JNS Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (!cpu->sf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+	if (!done) {
+		return 0;
+	}
+	return cpu_repFinish(cpu, done, 0);
+}
 
-		case 0x7A:	/* 7A JPE Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (cpu->pf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+FUNC_INLINE uint8_t cpu_repLods(CPU_t* cpu, uint8_t size) {
+	uint16_t count = cpu_repCount(cpu), done = 0, n;
+	int32_t step = cpu->df ? -(int32_t)size : size;
+	uint8_t* src;
 
-		case 0x7B:	/* 7B JPO Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (!cpu->pf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+	if (count < 2) {
+		return 0;
+	}
 
-		case 0x7C:	/* 7C JL Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (cpu->sf != cpu->of) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
+	while (done < count) {
+		n = count - done;
+		src = cpu_repSpan(cpu, cpu->useseg, cpu->regs.wordregs[regsi], size, 0, &n);
+		if (src == NULL) {
 			break;
+		}
 
-		case 0x7D:	/* 7D JGE Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (cpu->sf == cpu->of) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+		src += step * (n - 1); //only the last element ends up in the accumulator
+		if (size == 1) {
+			cpu->regs.byteregs[regal] = src[0];
+		}
+		else {
+			cpu->oper1 = (uint16_t)src[0] | ((uint16_t)src[1] << 8);
+			cpu->regs.wordregs[regax] = cpu->oper1;
+		}
 
-		case 0x7E:	/* 7E JLE Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if ((cpu->sf != cpu->of) || cpu->zf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+		cpu->regs.wordregs[regsi] += (uint16_t)(step * n);
+		done += n;
+	}
 
-		case 0x7F:	/* 7F JG Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (!cpu->zf && (cpu->sf == cpu->of)) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+	if (!done) {
+		return 0;
+	}
+	return cpu_repFinish(cpu, done, 0);
+}
 
-		case 0x80:
-		case 0x82:	/* 80/82 GRP1 Eb Ib */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			switch (cpu->reg) {
-			case 0:
-				op_add8(cpu);
-				break;
-			case 1:
-				op_or8(cpu);
-				break;
-			case 2:
-				op_adc8(cpu);
-				break;
-			case 3:
-				op_sbb8(cpu);
-				break;
-			case 4:
-				op_and8(cpu);
-				break;
-			case 5:
-				op_sub8(cpu);
-				break;
-			case 6:
-				op_xor8(cpu);
-				break;
-			case 7:
-				flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
-				break;
-			default:
-				break;	/* to avoid compiler warnings */
-			}
+/* CMPS when cmps is set, otherwise SCAS. the flags are set from the last pair compared */
+FUNC_INLINE uint8_t cpu_repCompare(CPU_t* cpu, uint8_t size, uint8_t cmps) {
+	uint16_t count = cpu_repCount(cpu), done = 0, n, i;
+	int32_t step = cpu->df ? -(int32_t)size : size;
+	uint16_t v1 = cpu->regs.wordregs[regax], v2 = 0;
+	uint8_t *src = NULL, *dst, stop = 0;
+
+	if (count < 2) {
+		return 0;
+	}
+
+	if (size == 1) {
+		v1 = cpu->regs.byteregs[regal];
+	}
 
-			if (cpu->reg < 7) {
-				writerm8(cpu, cpu->rm, cpu->res8);
+	while ((done < count) && !stop) {
+		n = count - done;
+		if (cmps) {
+			src = cpu_repSpan(cpu, cpu->useseg, cpu->regs.wordregs[regsi], size, 0, &n);
+			if (src == NULL) {
+				break;
 			}
+		}
+		dst = cpu_repSpan(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], size, 0, &n);
+		if (dst == NULL) {
 			break;
+		}
 
-		case 0x81:	/* 81 GRP1 Ev Iv */
-		case 0x83:	/* 83 GRP1 Ev Ib */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			if (cpu->opcode == 0x81) {
-				cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-				StepIP(cpu, 2);
-			}
-			else {
-				cpu->oper2 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-				StepIP(cpu, 1);
+		for (i = 0; i < n; ) {
+			if (cmps) {
+				v1 = (size == 1) ? src[0] : ((uint16_t)src[0] | ((uint16_t)src[1] << 8));
+				src += step;
 			}
-
-			switch (cpu->reg) {
-			case 0:
-				op_add16(cpu);
-				break;
-			case 1:
-				op_or16(cpu);
-				break;
-			case 2:
-				op_adc16(cpu);
-				break;
-			case 3:
-				op_sbb16(cpu);
+			v2 = (size == 1) ? dst[0] : ((uint16_t)dst[0] | ((uint16_t)dst[1] << 8));
+			dst += step;
+			i++;
+			if ((v1 == v2) != (cpu->reptype == 1)) { //REPE stops on a mismatch, REPNE on a match
+				stop = 1;
 				break;
-			case 4:
-				op_and16(cpu);
-				break;
-			case 5:
-				op_sub16(cpu);
-				break;
-			case 6:
-				op_xor16(cpu);
-				break;
-			case 7:
-				flag_sub16(cpu, cpu->oper1, cpu->oper2);
-				break;
-			default:
-				break;	/* to avoid compiler warnings */
 			}
+		}
 
-			if (cpu->reg < 7) {
-				writerm16(cpu, cpu->rm, cpu->res16);
-			}
-			break;
+		if (cmps) {
+			cpu->regs.wordregs[regsi] += (uint16_t)(step * i);
+		}
+		cpu->regs.wordregs[regdi] += (uint16_t)(step * i);
+		done += i;
+	}
 
-		case 0x84:	/* 84 TEST Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			cpu->oper2b = readrm8(cpu, cpu->rm);
-			flag_log8(cpu, cpu->oper1b & cpu->oper2b);
-			break;
+	if (!done) {
+		return 0;
+	}
 
-		case 0x85:	/* 85 TEST Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			cpu->oper2 = readrm16(cpu, cpu->rm);
-			flag_log16(cpu, cpu->oper1 & cpu->oper2);
-			break;
+	if (size == 1) {
+		cpu->oper1b = (uint8_t)v1;
+		cpu->oper2b = (uint8_t)v2;
+		flag_sub8(cpu, (uint8_t)v1, (uint8_t)v2);
+	}
+	else {
+		cpu->oper1 = v1;
+		cpu->oper2 = v2;
+		flag_sub16(cpu, v1, v2);
+	}
+	return cpu_repFinish(cpu, done, stop);
+}
+#endif
 
-		case 0x86:	/* 86 XCHG Gb Eb */
-			modregrm(cpu);
-			cpu->oper1b = getreg8(cpu, cpu->reg);
-			putreg8(cpu, cpu->reg, readrm8(cpu, cpu->rm));
-			writerm8(cpu, cpu->rm, cpu->oper1b);
-			break;
+/* A4 MOVSB */
+FUNC_INLINE void op_A4(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repMovs(cpu, 1)) {
+		return;
+	}
+#endif
 
-		case 0x87:	/* 87 XCHG Gv Ev */
-			modregrm(cpu);
-			cpu->oper1 = getreg16(cpu, cpu->reg);
-			putreg16(cpu, cpu->reg, readrm16(cpu, cpu->rm));
-			writerm16(cpu, cpu->rm, cpu->oper1);
-			break;
+	putmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], getmem8(cpu, cpu->useseg, cpu->regs.wordregs[regsi]));
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
+	}
 
-		case 0x88:	/* 88 MOV Eb Gb */
-			modregrm(cpu);
-			writerm8(cpu, cpu->rm, getreg8(cpu, cpu->reg));
-			break;
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0x89:	/* 89 MOV Ev Gv */
-			modregrm(cpu);
-			writerm16(cpu, cpu->rm, getreg16(cpu, cpu->reg));
-			break;
+	if (!cpu->reptype) {
+		return;
+	}
 
-		case 0x8A:	/* 8A MOV Gb Eb */
-			modregrm(cpu);
-			putreg8(cpu, cpu->reg, readrm8(cpu, cpu->rm));
-			break;
+	cpu->ip = cpu->firstip;
+}
 
-		case 0x8B:	/* 8B MOV Gv Ev */
-			modregrm(cpu);
-			putreg16(cpu, cpu->reg, readrm16(cpu, cpu->rm));
-			break;
+/* A5 MOVSW */
+FUNC_INLINE void op_A5(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repMovs(cpu, 2)) {
+		return;
+	}
+#endif
 
-		case 0x8C:	/* 8C MOV Ew Sw */
-			modregrm(cpu);
-			writerm16(cpu, cpu->rm, getsegreg(cpu, cpu->reg));
-			break;
+	putmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], getmem16(cpu, cpu->useseg, cpu->regs.wordregs[regsi]));
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
+	}
 
-		case 0x8D:	/* 8D LEA Gv M */
-			modregrm(cpu);
-			getea(cpu, cpu->rm);
-			putreg16(cpu, cpu->reg, cpu->ea - segbase(cpu->useseg));
-			break;
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0x8E:	/* 8E MOV Sw Ew */
-			modregrm(cpu);
-			putsegreg(cpu, cpu->reg, readrm16(cpu, cpu->rm));
-			break;
+	if (!cpu->reptype) {
+		return;
+	}
 
-		case 0x8F:	/* 8F POP Ev */
-			modregrm(cpu);
-			writerm16(cpu, cpu->rm, pop(cpu));
-			break;
+	cpu->ip = cpu->firstip;
+}
 
-		case 0x90:	/* 90 NOP */
-			break;
+/* A6 CMPSB */
+FUNC_INLINE void op_A6(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repCompare(cpu, 1, 1)) {
+		return;
+	}
+#endif
 
-		case 0x91:	/* 91 XCHG eCX eAX */
-			cpu->oper1 = cpu->regs.wordregs[regcx];
-			cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regax];
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+	cpu->oper1b = getmem8(cpu, cpu->useseg, cpu->regs.wordregs[regsi]);
+	cpu->oper2b = getmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi]);
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
+	}
 
-		case 0x92:	/* 92 XCHG eDX eAX */
-			cpu->oper1 = cpu->regs.wordregs[regdx];
-			cpu->regs.wordregs[regdx] = cpu->regs.wordregs[regax];
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+	flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0x93:	/* 93 XCHG eBX eAX */
-			cpu->oper1 = cpu->regs.wordregs[regbx];
-			cpu->regs.wordregs[regbx] = cpu->regs.wordregs[regax];
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+	if ((cpu->reptype == 1) && !flag_getzf(cpu)) {
+		return;
+	}
+	else if ((cpu->reptype == 2) && flag_getzf(cpu)) {
+		return;
+	}
+
+	if (!cpu->reptype) {
+		return;
+	}
+
+	cpu->ip = cpu->firstip;
+}
+
+/* A7 CMPSW */
+FUNC_INLINE void op_A7(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repCompare(cpu, 2, 1)) {
+		return;
+	}
+#endif
+
+	cpu->oper1 = getmem16(cpu, cpu->useseg, cpu->regs.wordregs[regsi]);
+	cpu->oper2 = getmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi]);
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
+	}
+
+	flag_sub16(cpu, cpu->oper1, cpu->oper2);
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
+
+	if ((cpu->reptype == 1) && !flag_getzf(cpu)) {
+		return;
+	}
+
+	if ((cpu->reptype == 2) && flag_getzf(cpu)) {
+		return;
+	}
 
-		case 0x94:	/* 94 XCHG eSP eAX */
-			cpu->oper1 = cpu->regs.wordregs[regsp];
-			cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regax];
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+	if (!cpu->reptype) {
+		return;
+	}
 
-		case 0x95:	/* 95 XCHG eBP eAX */
-			cpu->oper1 = cpu->regs.wordregs[regbp];
-			cpu->regs.wordregs[regbp] = cpu->regs.wordregs[regax];
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+	cpu->ip = cpu->firstip;
+}
 
-		case 0x96:	/* 96 XCHG eSI eAX */
-			cpu->oper1 = cpu->regs.wordregs[regsi];
-			cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regax];
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+/* A8 TEST cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_A8(CPU_t* cpu) {
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = cpu->imm;
+	flag_log8(cpu, cpu->oper1b & cpu->oper2b);
+}
 
-		case 0x97:	/* 97 XCHG eDI eAX */
-			cpu->oper1 = cpu->regs.wordregs[regdi];
-			cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regax];
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+/* A9 TEST eAX Iv */
+FUNC_INLINE void op_A9(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = cpu->imm;
+	flag_log16(cpu, cpu->oper1 & cpu->oper2);
+}
 
-		case 0x98:	/* 98 CBW */
-			if ((cpu->regs.byteregs[regal] & 0x80) == 0x80) {
-				cpu->regs.byteregs[regah] = 0xFF;
-			}
-			else {
-				cpu->regs.byteregs[regah] = 0;
-			}
-			break;
+/* AA STOSB */
+FUNC_INLINE void op_AA(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repStos(cpu, 1)) {
+		return;
+	}
+#endif
 
-		case 0x99:	/* 99 CWD */
-			if ((cpu->regs.byteregs[regah] & 0x80) == 0x80) {
-				cpu->regs.wordregs[regdx] = 0xFFFF;
-			}
-			else {
-				cpu->regs.wordregs[regdx] = 0;
-			}
-			break;
+	putmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], cpu->regs.byteregs[regal]);
+	if (cpu->df) {
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
+	}
+	else {
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
+	}
 
-		case 0x9A:	/* 9A CALL Ap */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			push(cpu, cpu->segregs[regcs]);
-			push(cpu, cpu->ip);
-			cpu->ip = cpu->oper1;
-			cpu->segregs[regcs] = cpu->oper2;
-			break;
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0x9B:	/* 9B WAIT */
-			break;
+	if (!cpu->reptype) {
+		return;
+	}
 
-		case 0x9C:	/* 9C PUSHF */
-#ifdef CPU_SET_HIGH_FLAGS
-			push(cpu, makeflagsword(cpu) | 0xF800);
-#else
-			push(cpu, makeflagsword(cpu) | 0x0800);
+	cpu->ip = cpu->firstip;
+}
+
+/* AB STOSW */
+FUNC_INLINE void op_AB(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repStos(cpu, 2)) {
+		return;
+	}
 #endif
-			break;
 
-		case 0x9D:	/* 9D POPF */
-			cpu->temp16 = pop(cpu);
-			decodeflagsword(cpu, cpu->temp16);
-			break;
+	putmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], cpu->regs.wordregs[regax]);
+	if (cpu->df) {
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
+	}
+	else {
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
+	}
 
-		case 0x9E:	/* 9E SAHF */
-			decodeflagsword(cpu, (makeflagsword(cpu) & 0xFF00) | cpu->regs.byteregs[regah]);
-			break;
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0x9F:	/* 9F LAHF */
-			cpu->regs.byteregs[regah] = makeflagsword(cpu) & 0xFF;
-			break;
+	if (!cpu->reptype) {
+		return;
+	}
 
-		case 0xA0:	/* A0 MOV cpu->regs.byteregs[regal] Ob */
-			cpu->regs.byteregs[regal] = getmem8(cpu, cpu->useseg, getmem16(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 2);
-			break;
+	cpu->ip = cpu->firstip;
+}
 
-		case 0xA1:	/* A1 MOV eAX Ov */
-			cpu->oper1 = getmem16(cpu, cpu->useseg, getmem16(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 2);
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+/* AC LODSB */
+FUNC_INLINE void op_AC(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repLods(cpu, 1)) {
+		return;
+	}
+#endif
 
-		case 0xA2:	/* A2 MOV Ob cpu->regs.byteregs[regal] */
-			putmem8(cpu, cpu->useseg, getmem16(cpu, cpu->segregs[regcs], cpu->ip), cpu->regs.byteregs[regal]);
-			StepIP(cpu, 2);
-			break;
+	cpu->regs.byteregs[regal] = getmem8(cpu, cpu->useseg, cpu->regs.wordregs[regsi]);
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
+	}
 
-		case 0xA3:	/* A3 MOV Ov eAX */
-			putmem16(cpu, cpu->useseg, getmem16(cpu, cpu->segregs[regcs], cpu->ip), cpu->regs.wordregs[regax]);
-			StepIP(cpu, 2);
-			break;
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0xA4:	/* A4 MOVSB */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+	if (!cpu->reptype) {
+		return;
+	}
 
-			putmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], getmem8(cpu, cpu->useseg, cpu->regs.wordregs[regsi]));
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
-			}
+	cpu->ip = cpu->firstip;
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* AD LODSW */
+FUNC_INLINE void op_AD(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repLods(cpu, 2)) {
+		return;
+	}
+#endif
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+	cpu->oper1 = getmem16(cpu, cpu->useseg, cpu->regs.wordregs[regsi]);
+	cpu->regs.wordregs[regax] = cpu->oper1;
+	if (cpu->df) {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
+	}
+	else {
+		cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
+	}
 
-			cpu->ip = firstip;
-			break;
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0xA5:	/* A5 MOVSW */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+	if (!cpu->reptype) {
+		return;
+	}
 
-			putmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], getmem16(cpu, cpu->useseg, cpu->regs.wordregs[regsi]));
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
-			}
+	cpu->ip = cpu->firstip;
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* AE SCASB */
+FUNC_INLINE void op_AE(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repCompare(cpu, 1, 0)) {
+		return;
+	}
+#endif
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+	cpu->oper1b = cpu->regs.byteregs[regal];
+	cpu->oper2b = getmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi]);
+	flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
+	if (cpu->df) {
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
+	}
+	else {
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
+	}
 
-			cpu->ip = firstip;
-			break;
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0xA6:	/* A6 CMPSB */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+	if ((cpu->reptype == 1) && !flag_getzf(cpu)) {
+		return;
+	}
+	else if ((cpu->reptype == 2) && flag_getzf(cpu)) {
+		return;
+	}
 
-			cpu->oper1b = getmem8(cpu, cpu->useseg, cpu->regs.wordregs[regsi]);
-			cpu->oper2b = getmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi]);
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
-			}
+	if (!cpu->reptype) {
+		return;
+	}
 
-			flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+	cpu->ip = cpu->firstip;
+}
 
-			if ((cpu->reptype == 1) && !cpu->zf) {
-				break;
-			}
-			else if ((cpu->reptype == 2) && (cpu->zf == 1)) {
-				break;
-			}
+/* AF SCASW */
+FUNC_INLINE void op_AF(CPU_t* cpu) {
+	if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
+		return;
+	}
+#ifdef CPU_REP_BULK
+	if (cpu->reptype && cpu_repCompare(cpu, 2, 0)) {
+		return;
+	}
+#endif
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+	cpu->oper1 = cpu->regs.wordregs[regax];
+	cpu->oper2 = getmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi]);
+	flag_sub16(cpu, cpu->oper1, cpu->oper2);
+	if (cpu->df) {
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
+	}
+	else {
+		cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
+	}
 
-			cpu->ip = firstip;
-			break;
+	if (cpu->reptype) {
+		cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	}
 
-		case 0xA7:	/* A7 CMPSW */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+	if ((cpu->reptype == 1) && !flag_getzf(cpu)) {
+		return;
+	}
+	else if ((cpu->reptype == 2) && flag_getzf(cpu)) { //did i fix a typo bug? this used to be & instead of &&
+		return;
+	}
 
-			cpu->oper1 = getmem16(cpu, cpu->useseg, cpu->regs.wordregs[regsi]);
-			cpu->oper2 = getmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi]);
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
-			}
+	if (!cpu->reptype) {
+		return;
+	}
 
-			flag_sub16(cpu, cpu->oper1, cpu->oper2);
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+	cpu->ip = cpu->firstip;
+}
 
-			if ((cpu->reptype == 1) && !cpu->zf) {
-				break;
-			}
+/* B0 MOV cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_B0(CPU_t* cpu) {
+	cpu->regs.byteregs[regal] = cpu->imm;
+}
 
-			if ((cpu->reptype == 2) && (cpu->zf == 1)) {
-				break;
-			}
+/* B1 MOV cpu->regs.byteregs[regcl] Ib */
+FUNC_INLINE void op_B1(CPU_t* cpu) {
+	cpu->regs.byteregs[regcl] = cpu->imm;
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* B2 MOV cpu->regs.byteregs[regdl] Ib */
+FUNC_INLINE void op_B2(CPU_t* cpu) {
+	cpu->regs.byteregs[regdl] = cpu->imm;
+}
 
-			cpu->ip = firstip;
-			break;
+/* B3 MOV cpu->regs.byteregs[regbl] Ib */
+FUNC_INLINE void op_B3(CPU_t* cpu) {
+	cpu->regs.byteregs[regbl] = cpu->imm;
+}
 
-		case 0xA8:	/* A8 TEST cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			flag_log8(cpu, cpu->oper1b & cpu->oper2b);
-			break;
+/* B4 MOV cpu->regs.byteregs[regah] Ib */
+FUNC_INLINE void op_B4(CPU_t* cpu) {
+	cpu->regs.byteregs[regah] = cpu->imm;
+}
 
-		case 0xA9:	/* A9 TEST eAX Iv */
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			flag_log16(cpu, cpu->oper1 & cpu->oper2);
-			break;
+/* B5 MOV cpu->regs.byteregs[regch] Ib */
+FUNC_INLINE void op_B5(CPU_t* cpu) {
+	cpu->regs.byteregs[regch] = cpu->imm;
+}
 
-		case 0xAA:	/* AA STOSB */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+/* B6 MOV cpu->regs.byteregs[regdh] Ib */
+FUNC_INLINE void op_B6(CPU_t* cpu) {
+	cpu->regs.byteregs[regdh] = cpu->imm;
+}
 
-			putmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], cpu->regs.byteregs[regal]);
-			if (cpu->df) {
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
-			}
-			else {
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
-			}
+/* B7 MOV cpu->regs.byteregs[regbh] Ib */
+FUNC_INLINE void op_B7(CPU_t* cpu) {
+	cpu->regs.byteregs[regbh] = cpu->imm;
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* B8 MOV eAX Iv */
+FUNC_INLINE void op_B8(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->regs.wordregs[regax] = cpu->oper1;
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* B9 MOV eCX Iv */
+FUNC_INLINE void op_B9(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->regs.wordregs[regcx] = cpu->oper1;
+}
 
-			cpu->ip = firstip;
-			break;
+/* BA MOV eDX Iv */
+FUNC_INLINE void op_BA(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->regs.wordregs[regdx] = cpu->oper1;
+}
 
-		case 0xAB:	/* AB STOSW */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+/* BB MOV eBX Iv */
+FUNC_INLINE void op_BB(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->regs.wordregs[regbx] = cpu->oper1;
+}
 
-			putmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], cpu->regs.wordregs[regax]);
-			if (cpu->df) {
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
-			}
-			else {
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
-			}
+/* BC MOV eSP Iv */
+FUNC_INLINE void op_BC(CPU_t* cpu) {
+	cpu->regs.wordregs[regsp] = cpu->imm;
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* BD MOV eBP Iv */
+FUNC_INLINE void op_BD(CPU_t* cpu) {
+	cpu->regs.wordregs[regbp] = cpu->imm;
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* BE MOV eSI Iv */
+FUNC_INLINE void op_BE(CPU_t* cpu) {
+	cpu->regs.wordregs[regsi] = cpu->imm;
+}
 
-			cpu->ip = firstip;
-			break;
+/* BF MOV eDI Iv */
+FUNC_INLINE void op_BF(CPU_t* cpu) {
+	cpu->regs.wordregs[regdi] = cpu->imm;
+}
 
-		case 0xAC:	/* AC LODSB */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+/* C0 GRP2 byte imm8 (80186+) */
+FUNC_INLINE void op_C0(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = cpu->imm;
+	cpu->cycles += CPU_SHIFT_CYCLES(cpu->oper2b);
+	writerm8(cpu, cpu->rm, op_grp2_8(cpu, cpu->oper2b));
+}
 
-			cpu->regs.byteregs[regal] = getmem8(cpu, cpu->useseg, cpu->regs.wordregs[regsi]);
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 1;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 1;
-			}
+/* C1 GRP2 word imm8 (80186+) */
+FUNC_INLINE void op_C1(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = cpu->imm;
+	cpu->cycles += CPU_SHIFT_CYCLES((uint8_t)cpu->oper2);
+	writerm16(cpu, cpu->rm, op_grp2_16(cpu, (uint8_t)cpu->oper2));
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* C2 RET Iw */
+FUNC_INLINE void op_C2(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->ip = pop(cpu);
+	cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regsp] + cpu->oper1;
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* C3 RET */
+FUNC_INLINE void op_C3(CPU_t* cpu) {
+	cpu->ip = pop(cpu);
+}
 
-			cpu->ip = firstip;
-			break;
+/* C4 LES Gv Mp */
+FUNC_INLINE void op_C4(CPU_t* cpu) {
+	getea(cpu, cpu->rm);
+	putreg16(cpu, cpu->reg, cpu_readw(cpu, cpu->ea));
+	cpu->segregs[reges] = cpu_readw(cpu, cpu->ea + 2);
+}
 
-		case 0xAD:	/* AD LODSW */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+/* C5 LDS Gv Mp */
+FUNC_INLINE void op_C5(CPU_t* cpu) {
+	getea(cpu, cpu->rm);
+	putreg16(cpu, cpu->reg, cpu_readw(cpu, cpu->ea));
+	cpu->segregs[regds] = cpu_readw(cpu, cpu->ea + 2);
+}
 
-			cpu->oper1 = getmem16(cpu, cpu->useseg, cpu->regs.wordregs[regsi]);
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			if (cpu->df) {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] - 2;
-			}
-			else {
-				cpu->regs.wordregs[regsi] = cpu->regs.wordregs[regsi] + 2;
-			}
+/* C6 MOV Eb Ib */
+FUNC_INLINE void op_C6(CPU_t* cpu) {
+	writerm8(cpu, cpu->rm, cpu->imm);
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* C7 MOV Ev Iv */
+FUNC_INLINE void op_C7(CPU_t* cpu) {
+	writerm16(cpu, cpu->rm, cpu->imm);
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* C8 ENTER (80186+) */
+FUNC_INLINE void op_C8(CPU_t* cpu) {
+	cpu->stacksize = cpu->imm;
+	cpu->nestlev = cpu->imm2;
+	push(cpu, cpu->regs.wordregs[regbp]);
+	cpu->frametemp = cpu->regs.wordregs[regsp];
+	if (cpu->nestlev) {
+		for (cpu->temp16 = 1; cpu->temp16 < cpu->nestlev; ++cpu->temp16) {
+			cpu->regs.wordregs[regbp] = cpu->regs.wordregs[regbp] - 2;
+			push(cpu, cpu->regs.wordregs[regbp]);
+		}
 
-			cpu->ip = firstip;
-			break;
+		push(cpu, cpu->frametemp); //cpu->regs.wordregs[regsp]);
+	}
 
-		case 0xAE:	/* AE SCASB */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+	cpu->regs.wordregs[regbp] = cpu->frametemp;
+	cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regbp] - cpu->stacksize;
+}
 
-			cpu->oper1b = cpu->regs.byteregs[regal];
-			cpu->oper2b = getmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi]);
-			flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
-			if (cpu->df) {
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
-			}
-			else {
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
-			}
+/* C9 LEAVE (80186+) */
+FUNC_INLINE void op_C9(CPU_t* cpu) {
+	cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regbp];
+	cpu->regs.wordregs[regbp] = pop(cpu);
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* CA RETF Iw */
+FUNC_INLINE void op_CA(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->ip = pop(cpu);
+	cpu->segregs[regcs] = pop(cpu);
+	cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regsp] + cpu->oper1;
+}
 
-			if ((cpu->reptype == 1) && !cpu->zf) {
-				break;
-			}
-			else if ((cpu->reptype == 2) && (cpu->zf == 1)) {
-				break;
-			}
+/* CB RETF */
+FUNC_INLINE void op_CB(CPU_t* cpu) {
+	cpu->ip = pop(cpu);
+	cpu->segregs[regcs] = pop(cpu);
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* CC INT 3 */
+FUNC_INLINE void op_CC(CPU_t* cpu) {
+	cpu_intcall(cpu, 3);
+}
 
-			cpu->ip = firstip;
-			break;
+/* CD INT Ib */
+FUNC_INLINE void op_CD(CPU_t* cpu) {
+	cpu->oper1b = cpu->imm;
+	cpu_intcall(cpu, cpu->oper1b);
+}
 
-		case 0xAF:	/* AF SCASW */
-			if (cpu->reptype && (cpu->regs.wordregs[regcx] == 0)) {
-				break;
-			}
+/* CE INTO */
+FUNC_INLINE void op_CE(CPU_t* cpu) {
+	if (flag_getof(cpu)) {
+		cpu_intcall(cpu, 4);
+	}
+}
 
-			cpu->oper1 = cpu->regs.wordregs[regax];
-			cpu->oper2 = getmem16(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi]);
-			flag_sub16(cpu, cpu->oper1, cpu->oper2);
-			if (cpu->df) {
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 2;
-			}
-			else {
-				cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 2;
-			}
+/* CF IRET */
+FUNC_INLINE void op_CF(CPU_t* cpu) {
+	cpu->ip = pop(cpu);
+	cpu->segregs[regcs] = pop(cpu);
+	decodeflagsword(cpu, pop(cpu));
+
+	/*
+	 * if (net.enabled) net.canrecv = 1;
+	 */
+}
+
+/* D0 GRP2 Eb 1 */
+FUNC_INLINE void op_D0(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	writerm8(cpu, cpu->rm, op_grp2_8(cpu, 1));
+}
 
-			if (cpu->reptype) {
-				cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			}
+/* D1 GRP2 Ev 1 */
+FUNC_INLINE void op_D1(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	writerm16(cpu, cpu->rm, op_grp2_16(cpu, 1));
+}
 
-			if ((cpu->reptype == 1) && !cpu->zf) {
-				break;
-			}
-			else if ((cpu->reptype == 2) && (cpu->zf == 1)) { //did i fix a typo bug? this used to be & instead of &&
-				break;
-			}
+/* D2 GRP2 Eb cpu->regs.byteregs[regcl] */
+FUNC_INLINE void op_D2(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->cycles += CPU_SHIFT_CYCLES(cpu->regs.byteregs[regcl]);
+	writerm8(cpu, cpu->rm, op_grp2_8(cpu, cpu->regs.byteregs[regcl]));
+}
 
-			loopcount++;
-			if (!cpu->reptype) {
-				break;
-			}
+/* D3 GRP2 Ev cpu->regs.byteregs[regcl] */
+FUNC_INLINE void op_D3(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->cycles += CPU_SHIFT_CYCLES(cpu->regs.byteregs[regcl]);
+	writerm16(cpu, cpu->rm, op_grp2_16(cpu, cpu->regs.byteregs[regcl]));
+}
 
-			cpu->ip = firstip;
-			break;
+/* D4 AAM I0 */
+FUNC_INLINE void op_D4(CPU_t* cpu) {
+	flag_sync(cpu);
+	cpu->oper1 = cpu->imm;
+	if (!cpu->oper1) {
+		cpu_intcall(cpu, 0);
+		return;
+	}	/* division by zero */
 
-		case 0xB0:	/* B0 MOV cpu->regs.byteregs[regal] Ib */
-			cpu->regs.byteregs[regal] = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			break;
+	cpu->regs.byteregs[regah] = (cpu->regs.byteregs[regal] / cpu->oper1) & 255;
+	cpu->regs.byteregs[regal] = (cpu->regs.byteregs[regal] % cpu->oper1) & 255;
+	flag_szp16(cpu, cpu->regs.wordregs[regax]);
+}
 
-		case 0xB1:	/* B1 MOV cpu->regs.byteregs[regcl] Ib */
-			cpu->regs.byteregs[regcl] = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			break;
+/* D5 AAD I0 */
+FUNC_INLINE void op_D5(CPU_t* cpu) {
+	flag_sync(cpu);
+	cpu->oper1 = cpu->imm;
+	cpu->regs.byteregs[regal] = (cpu->regs.byteregs[regah] * cpu->oper1 + cpu->regs.byteregs[regal]) & 255;
+	cpu->regs.byteregs[regah] = 0;
+	flag_szp16(cpu, cpu->regs.byteregs[regah] * cpu->oper1 + cpu->regs.byteregs[regal]);
+	cpu->sf = 0;
+}
 
-		case 0xB2:	/* B2 MOV cpu->regs.byteregs[regdl] Ib */
-			cpu->regs.byteregs[regdl] = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			break;
+/* D7 XLAT */
+FUNC_INLINE void op_D7(CPU_t* cpu) {
+	cpu->regs.byteregs[regal] = cpu_read(cpu, cpu->useseg * 16 + (cpu->regs.wordregs[regbx]) + cpu->regs.byteregs[regal]);
+}
 
-		case 0xB3:	/* B3 MOV cpu->regs.byteregs[regbl] Ib */
-			cpu->regs.byteregs[regbl] = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			break;
+/* D6 XLAT on V20/V30, SALC on 8086/8088 */
+FUNC_INLINE void op_D6(CPU_t* cpu) {
+#ifndef CPU_NO_SALC
+	cpu->regs.byteregs[regal] = flag_getcf(cpu) ? 0xFF : 0x00;
+#else
+	op_D7(cpu);
+#endif
+}
 
-		case 0xB4:	/* B4 MOV cpu->regs.byteregs[regah] Ib */
-			cpu->regs.byteregs[regah] = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			break;
+/* D8-DF escape to x87 FPU (unsupported) */
+FUNC_INLINE void op_D8(CPU_t* cpu) {
+}
 
-		case 0xB5:	/* B5 MOV cpu->regs.byteregs[regch] Ib */
-			cpu->regs.byteregs[regch] = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			break;
+/* E0 LOOPNZ Jb */
+FUNC_INLINE void op_E0(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	if ((cpu->regs.wordregs[regcx]) && !flag_getzf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
 
-		case 0xB6:	/* B6 MOV cpu->regs.byteregs[regdh] Ib */
-			cpu->regs.byteregs[regdh] = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			break;
+/* E1 LOOPZ Jb */
+FUNC_INLINE void op_E1(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	if (cpu->regs.wordregs[regcx] && flag_getzf(cpu)) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
 
-		case 0xB7:	/* B7 MOV cpu->regs.byteregs[regbh] Ib */
-			cpu->regs.byteregs[regbh] = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			break;
+/* E2 LOOP Jb */
+FUNC_INLINE void op_E2(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	if (cpu->regs.wordregs[regcx]) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
 
-		case 0xB8:	/* B8 MOV eAX Iv */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			cpu->regs.wordregs[regax] = cpu->oper1;
-			break;
+/* E3 JCXZ Jb */
+FUNC_INLINE void op_E3(CPU_t* cpu) {
+	cpu->temp16 = signext(cpu->imm);
+	if (!cpu->regs.wordregs[regcx]) {
+		cpu->ip = cpu->ip + cpu->temp16;
+		cpu->cycles += CPU_CYCLES_TAKEN;
+	}
+}
 
-		case 0xB9:	/* B9 MOV eCX Iv */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			cpu->regs.wordregs[regcx] = cpu->oper1;
-			break;
+/* E4 IN cpu->regs.byteregs[regal] Ib */
+FUNC_INLINE void op_E4(CPU_t* cpu) {
+	cpu->oper1b = cpu->imm;
+	cpu->regs.byteregs[regal] = (uint8_t)port_read(cpu, cpu->oper1b);
+}
 
-		case 0xBA:	/* BA MOV eDX Iv */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			cpu->regs.wordregs[regdx] = cpu->oper1;
-			break;
+/* E5 IN eAX Ib */
+FUNC_INLINE void op_E5(CPU_t* cpu) {
+	cpu->oper1b = cpu->imm;
+	cpu->regs.wordregs[regax] = port_readw(cpu, cpu->oper1b);
+}
 
-		case 0xBB:	/* BB MOV eBX Iv */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			cpu->regs.wordregs[regbx] = cpu->oper1;
-			break;
+/* E6 OUT Ib cpu->regs.byteregs[regal] */
+FUNC_INLINE void op_E6(CPU_t* cpu) {
+	cpu->oper1b = cpu->imm;
+	port_write(cpu, cpu->oper1b, cpu->regs.byteregs[regal]);
+}
 
-		case 0xBC:	/* BC MOV eSP Iv */
-			cpu->regs.wordregs[regsp] = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			break;
+/* E7 OUT Ib eAX */
+FUNC_INLINE void op_E7(CPU_t* cpu) {
+	cpu->oper1b = cpu->imm;
+	port_writew(cpu, cpu->oper1b, cpu->regs.wordregs[regax]);
+}
 
-		case 0xBD:	/* BD MOV eBP Iv */
-			cpu->regs.wordregs[regbp] = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			break;
+/* E8 CALL Jv */
+FUNC_INLINE void op_E8(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	push(cpu, cpu->ip);
+	cpu->ip = cpu->ip + cpu->oper1;
+}
 
-		case 0xBE:	/* BE MOV eSI Iv */
-			cpu->regs.wordregs[regsi] = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			break;
+/* E9 JMP Jv */
+FUNC_INLINE void op_E9(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->ip = cpu->ip + cpu->oper1;
+}
 
-		case 0xBF:	/* BF MOV eDI Iv */
-			cpu->regs.wordregs[regdi] = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			break;
+/* EA JMP Ap */
+FUNC_INLINE void op_EA(CPU_t* cpu) {
+	cpu->oper1 = cpu->imm;
+	cpu->oper2 = cpu->imm2;
+	cpu->ip = cpu->oper1;
+	cpu->segregs[regcs] = cpu->oper2;
+}
 
-		case 0xC0:	/* C0 GRP2 byte imm8 (80186+) */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			writerm8(cpu, cpu->rm, op_grp2_8(cpu, cpu->oper2b));
-			break;
+/* EB JMP Jb */
+FUNC_INLINE void op_EB(CPU_t* cpu) {
+	cpu->oper1 = signext(cpu->imm);
+	cpu->ip = cpu->ip + cpu->oper1;
+}
 
-		case 0xC1:	/* C1 GRP2 word imm8 (80186+) */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			cpu->oper2 = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			writerm16(cpu, cpu->rm, op_grp2_16(cpu, (uint8_t)cpu->oper2));
-			break;
+/* EC IN cpu->regs.byteregs[regal] regdx */
+FUNC_INLINE void op_EC(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdx];
+	cpu->regs.byteregs[regal] = (uint8_t)port_read(cpu, cpu->oper1);
+}
 
-		case 0xC2:	/* C2 RET Iw */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			cpu->ip = pop(cpu);
-			cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regsp] + cpu->oper1;
-			break;
+/* ED IN eAX regdx */
+FUNC_INLINE void op_ED(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdx];
+	cpu->regs.wordregs[regax] = port_readw(cpu, cpu->oper1);
+}
 
-		case 0xC3:	/* C3 RET */
-			cpu->ip = pop(cpu);
-			break;
+/* EE OUT regdx cpu->regs.byteregs[regal] */
+FUNC_INLINE void op_EE(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdx];
+	port_write(cpu, cpu->oper1, cpu->regs.byteregs[regal]);
+}
 
-		case 0xC4:	/* C4 LES Gv Mp */
-			modregrm(cpu);
-			getea(cpu, cpu->rm);
-			putreg16(cpu, cpu->reg, cpu_read(cpu, cpu->ea) + cpu_read(cpu, cpu->ea + 1) * 256);
-			cpu->segregs[reges] = cpu_read(cpu, cpu->ea + 2) + cpu_read(cpu, cpu->ea + 3) * 256;
-			break;
+/* EF OUT regdx eAX */
+FUNC_INLINE void op_EF(CPU_t* cpu) {
+	cpu->oper1 = cpu->regs.wordregs[regdx];
+	port_writew(cpu, cpu->oper1, cpu->regs.wordregs[regax]);
+}
 
-		case 0xC5:	/* C5 LDS Gv Mp */
-			modregrm(cpu);
-			getea(cpu, cpu->rm);
-			putreg16(cpu, cpu->reg, cpu_read(cpu, cpu->ea) + cpu_read(cpu, cpu->ea + 1) * 256);
-			cpu->segregs[regds] = cpu_read(cpu, cpu->ea + 2) + cpu_read(cpu, cpu->ea + 3) * 256;
-			break;
+/* F0 LOCK */
+FUNC_INLINE void op_F0(CPU_t* cpu) {
+}
 
-		case 0xC6:	/* C6 MOV Eb Ib */
-			modregrm(cpu);
-			writerm8(cpu, cpu->rm, getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			break;
+/* F4 HLT */
+FUNC_INLINE void op_F4(CPU_t* cpu) {
+	cpu->hltstate = 1;
+}
 
-		case 0xC7:	/* C7 MOV Ev Iv */
-			modregrm(cpu);
-			writerm16(cpu, cpu->rm, getmem16(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 2);
-			break;
+/* F5 CMC */
+FUNC_INLINE void op_F5(CPU_t* cpu) {
+	flag_sync(cpu);
+	if (!cpu->cf) {
+		cpu->cf = 1;
+	}
+	else {
+		cpu->cf = 0;
+	}
+}
 
-		case 0xC8:	/* C8 ENTER (80186+) */
-			cpu->stacksize = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			cpu->nestlev = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			push(cpu, cpu->regs.wordregs[regbp]);
-			cpu->frametemp = cpu->regs.wordregs[regsp];
-			if (cpu->nestlev) {
-				for (cpu->temp16 = 1; cpu->temp16 < cpu->nestlev; ++cpu->temp16) {
-					cpu->regs.wordregs[regbp] = cpu->regs.wordregs[regbp] - 2;
-					push(cpu, cpu->regs.wordregs[regbp]);
-				}
+/* F6 GRP3a Eb */
+FUNC_INLINE void op_F6(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	op_grp3_8(cpu);
+	if ((cpu->reg > 1) && (cpu->reg < 4)) {
+		writerm8(cpu, cpu->rm, cpu->res8);
+	}
+}
 
-				push(cpu, cpu->frametemp); //cpu->regs.wordregs[regsp]);
-			}
+/* F7 GRP3b Ev */
+FUNC_INLINE void op_F7(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	op_grp3_16(cpu);
+	if ((cpu->reg > 1) && (cpu->reg < 4)) {
+		writerm16(cpu, cpu->rm, cpu->res16);
+	}
+}
 
-			cpu->regs.wordregs[regbp] = cpu->frametemp;
-			cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regbp] - cpu->stacksize;
+/* F8 CLC */
+FUNC_INLINE void op_F8(CPU_t* cpu) {
+	flag_sync(cpu);
+	cpu->cf = 0;
+}
 
-			break;
+/* F9 STC */
+FUNC_INLINE void op_F9(CPU_t* cpu) {
+	flag_sync(cpu);
+	cpu->cf = 1;
+}
 
-		case 0xC9:	/* C9 LEAVE (80186+) */
-			cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regbp];
-			cpu->regs.wordregs[regbp] = pop(cpu);
-			break;
+/* FA CLI */
+FUNC_INLINE void op_FA(CPU_t* cpu) {
+	cpu->ifl = 0;
+}
 
-		case 0xCA:	/* CA RETF Iw */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			cpu->ip = pop(cpu);
-			cpu->segregs[regcs] = pop(cpu);
-			cpu->regs.wordregs[regsp] = cpu->regs.wordregs[regsp] + cpu->oper1;
-			break;
+/* FB STI */
+FUNC_INLINE void op_FB(CPU_t* cpu) {
+	cpu->ifl = 1;
+}
 
-		case 0xCB:	/* CB RETF */
-			cpu->ip = pop(cpu);
-			cpu->segregs[regcs] = pop(cpu);
-			break;
+/* FC CLD */
+FUNC_INLINE void op_FC(CPU_t* cpu) {
+	cpu->df = 0;
+}
 
-		case 0xCC:	/* CC INT 3 */
-			cpu_intcall(cpu, 3);
-			break;
+/* FD STD */
+FUNC_INLINE void op_FD(CPU_t* cpu) {
+	cpu->df = 1;
+}
 
-		case 0xCD:	/* CD INT Ib */
-			cpu->oper1b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			cpu_intcall(cpu, cpu->oper1b);
-			break;
+/* FE GRP4 Eb */
+FUNC_INLINE void op_FE(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = 1;
+	if (!cpu->reg) {
+		op_inc8(cpu);
+		writerm8(cpu, cpu->rm, cpu->res8);
+	}
+	else {
+		op_dec8(cpu);
+		writerm8(cpu, cpu->rm, cpu->res8);
+	}
+}
 
-		case 0xCE:	/* CE INTO */
-			if (cpu->of) {
-				cpu_intcall(cpu, 4);
-			}
-			break;
+/* FF GRP5 Ev */
+FUNC_INLINE void op_FF(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	op_grp5(cpu);
+}
 
-		case 0xCF:	/* CF IRET */
-			cpu->ip = pop(cpu);
-			cpu->segregs[regcs] = pop(cpu);
-			decodeflagsword(cpu, pop(cpu));
+#ifdef CPU_FUSE
+/*
+	Fused sequences: cpu_cacheBuild gives the first instruction of a few common pairs a CPU_FUSED
+	dispatch entry, and its handler runs the second instruction of the pair as well, without going
+	back through dispatch. The second instruction is left to run on its own where it would be
+	preceded by a trap, an interrupt or the end of the cycle budget.
+*/
+FUNC_INLINE uint8_t cpu_fuseNext(CPU_t* cpu) {
+	if (cpu->tf | (cpu->intr & cpu->ifl) | (cpu->cycles >= cpu->budget)) {
+		return 0;
+	}
+	cpu->firstip = cpu->ip;
+	cpu_loaddecoded(cpu, &cpu->block->ins[cpu->blockpos++]);
+	cpu->totalexec++;
+	return 1;
+}
 
-			/*
-			 * if (net.enabled) net.canrecv = 1;
-			 */
-			break;
+/* take a short jump. going back to the top of the current block carries on in it without looking it up again */
+FUNC_INLINE void cpu_fuseBranch(CPU_t* cpu) {
+	cpu->ip = cpu->ip + signext(cpu->imm);
+	cpu->cycles += CPU_CYCLES_TAKEN;
+	if (cpu->ip == cpu->block->ip) {
+		cpu->blockpos = 0;
+	}
+}
 
-		case 0xD0:	/* D0 GRP2 Eb 1 */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			writerm8(cpu, cpu->rm, op_grp2_8(cpu, 1));
-			break;
+/* conditional jump after CMP, straight from the operands and only for the flags it tests. sign is the operand's top bit */
+FUNC_INLINE void cpu_fuseJccCmp(CPU_t* cpu, uint32_t sign) {
+	uint32_t v1 = cpu->flagop1, v2 = cpu->flagop2;
+	uint8_t cond;
 
-		case 0xD1:	/* D1 GRP2 Ev 1 */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			writerm16(cpu, cpu->rm, op_grp2_16(cpu, 1));
-			break;
+	switch ((cpu->opcode >> 1) & 7) {
+	case 0:	/* JO */
+		cond = (((cpu->flagres ^ v1) & (v1 ^ v2)) & sign) != 0;
+		break;
+	case 1:	/* JB */
+		cond = v1 < v2;
+		break;
+	case 2:	/* JZ */
+		cond = v1 == v2;
+		break;
+	case 3:	/* JBE */
+		cond = v1 <= v2;
+		break;
+	case 4:	/* JS */
+		cond = (cpu->flagres & sign) != 0;
+		break;
+	case 5:	/* JPE */
+		cond = parity[cpu->flagres & 0xFF];
+		break;
+	case 6:	/* JL */
+		cond = (v1 ^ sign) < (v2 ^ sign);
+		break;
+	default:	/* JLE */
+		cond = (v1 ^ sign) <= (v2 ^ sign);
+		break;
+	}
+	if (cond != (cpu->opcode & 1)) {
+		cpu_fuseBranch(cpu);
+	}
+}
 
-		case 0xD2:	/* D2 GRP2 Eb cpu->regs.byteregs[regcl] */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			writerm8(cpu, cpu->rm, op_grp2_8(cpu, cpu->regs.byteregs[regcl]));
-			break;
+/* conditional jump after TEST, which always clears CF and OF */
+FUNC_INLINE void cpu_fuseJccTest(CPU_t* cpu, uint32_t sign) {
+	uint32_t res = cpu->flagres;
+	uint8_t cond;
 
-		case 0xD3:	/* D3 GRP2 Ev cpu->regs.byteregs[regcl] */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			writerm16(cpu, cpu->rm, op_grp2_16(cpu, cpu->regs.byteregs[regcl]));
-			break;
+	switch ((cpu->opcode >> 1) & 7) {
+	case 0:	/* JO */
+	case 1:	/* JB */
+		cond = 0;
+		break;
+	case 2:	/* JZ */
+	case 3:	/* JBE */
+		cond = res == 0;
+		break;
+	case 4:	/* JS */
+	case 6:	/* JL */
+		cond = (res & sign) != 0;
+		break;
+	case 5:	/* JPE */
+		cond = parity[res & 0xFF];
+		break;
+	default:	/* JLE */
+		cond = ((res & sign) != 0) || (res == 0);
+		break;
+	}
+	if (cond != (cpu->opcode & 1)) {
+		cpu_fuseBranch(cpu);
+	}
+}
 
-		case 0xD4:	/* D4 AAM I0 */
-			cpu->oper1 = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			if (!cpu->oper1) {
-				cpu_intcall(cpu, 0);
-				break;
-			}	/* division by zero */
+/* 38 CMP Eb Gb, Jcc */
+FUNC_INLINE void fuse_38(CPU_t* cpu) {
+	op_38(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccCmp(cpu, 0x80);
+}
 
-			cpu->regs.byteregs[regah] = (cpu->regs.byteregs[regal] / cpu->oper1) & 255;
-			cpu->regs.byteregs[regal] = (cpu->regs.byteregs[regal] % cpu->oper1) & 255;
-			flag_szp16(cpu, cpu->regs.wordregs[regax]);
-			break;
+/* 39 CMP Ev Gv, Jcc */
+FUNC_INLINE void fuse_39(CPU_t* cpu) {
+	op_39(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccCmp(cpu, 0x8000);
+}
 
-		case 0xD5:	/* D5 AAD I0 */
-			cpu->oper1 = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			cpu->regs.byteregs[regal] = (cpu->regs.byteregs[regah] * cpu->oper1 + cpu->regs.byteregs[regal]) & 255;
-			cpu->regs.byteregs[regah] = 0;
-			flag_szp16(cpu, cpu->regs.byteregs[regah] * cpu->oper1 + cpu->regs.byteregs[regal]);
-			cpu->sf = 0;
-			break;
+/* 3A CMP Gb Eb, Jcc */
+FUNC_INLINE void fuse_3A(CPU_t* cpu) {
+	op_3A(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccCmp(cpu, 0x80);
+}
 
-		case 0xD6:	/* D6 XLAT on V20/V30, SALC on 8086/8088 */
-#ifndef CPU_NO_SALC
-			cpu->regs.byteregs[regal] = cpu->cf ? 0xFF : 0x00;
-			break;
-#endif
+/* 3B CMP Gv Ev, Jcc */
+FUNC_INLINE void fuse_3B(CPU_t* cpu) {
+	op_3B(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccCmp(cpu, 0x8000);
+}
 
-		case 0xD7:	/* D7 XLAT */
-			cpu->regs.byteregs[regal] = cpu_read(cpu, cpu->useseg * 16 + (cpu->regs.wordregs[regbx]) + cpu->regs.byteregs[regal]);
-			break;
+/* 3C CMP AL Ib, Jcc */
+FUNC_INLINE void fuse_3C(CPU_t* cpu) {
+	op_3C(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccCmp(cpu, 0x80);
+}
 
-		case 0xD8:
-		case 0xD9:
-		case 0xDA:
-		case 0xDB:
-		case 0xDC:
-		case 0xDE:
-		case 0xDD:
-		case 0xDF:	/* escape to x87 FPU (unsupported) */
-			modregrm(cpu);
-			break;
+/* 3D CMP eAX Iv, Jcc */
+FUNC_INLINE void fuse_3D(CPU_t* cpu) {
+	op_3D(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccCmp(cpu, 0x8000);
+}
 
-		case 0xE0:	/* E0 LOOPNZ Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			if ((cpu->regs.wordregs[regcx]) && !cpu->zf) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+/* 46 INC SI, INC DI and 47 INC DI, INC SI */
+FUNC_INLINE void fuse_46(CPU_t* cpu) {
+	uint8_t reg = cpu->opcode & 7;
+
+	cpu->oper1 = cpu->regs.wordregs[reg];
+	cpu->oper2 = 1;
+	op_inc16(cpu);
+	cpu->regs.wordregs[reg] = cpu->res16;
+	if (cpu_fuseNext(cpu)) {
+		reg ^= 1;
+		cpu->oper1 = cpu->regs.wordregs[reg];
+		cpu->res16 = cpu->oper1 + 1;
+		flag_lazy(cpu, CPU_FLAGS_INC16, cpu->oper1, 1, (uint32_t)cpu->oper1 + 1); /* the first INC already stored CF */
+		cpu->regs.wordregs[reg] = cpu->res16;
+	}
+}
 
-		case 0xE1:	/* E1 LOOPZ Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			if (cpu->regs.wordregs[regcx] && (cpu->zf == 1)) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+/* 48-4F DEC reg, JNZ */
+FUNC_INLINE void fuse_48(CPU_t* cpu) {
+	uint8_t reg = cpu->opcode & 7;
 
-		case 0xE2:	/* E2 LOOP Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
-			if (cpu->regs.wordregs[regcx]) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+	cpu->oper1 = cpu->regs.wordregs[reg];
+	cpu->oper2 = 1;
+	op_dec16(cpu);
+	cpu->regs.wordregs[reg] = cpu->res16;
+	if (cpu_fuseNext(cpu) && cpu->res16) {
+		cpu_fuseBranch(cpu);
+	}
+}
 
-		case 0xE3:	/* E3 JCXZ Jb */
-			cpu->temp16 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			if (!cpu->regs.wordregs[regcx]) {
-				cpu->ip = cpu->ip + cpu->temp16;
-			}
-			break;
+/* 80/82 GRP1 Eb Ib with CMP, Jcc */
+FUNC_INLINE void fuse_80(CPU_t* cpu) {
+	cpu->oper1b = readrm8(cpu, cpu->rm);
+	cpu->oper2b = cpu->imm;
+	flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccCmp(cpu, 0x80);
+}
 
-		case 0xE4:	/* E4 IN cpu->regs.byteregs[regal] Ib */
-			cpu->oper1b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			cpu->regs.byteregs[regal] = (uint8_t)port_read(cpu, cpu->oper1b);
-			break;
+/* 81 GRP1 Ev Iv and 83 GRP1 Ev Ib with CMP, Jcc */
+FUNC_INLINE void fuse_81(CPU_t* cpu) {
+	cpu->oper1 = readrm16(cpu, cpu->rm);
+	cpu->oper2 = (cpu->opcode == 0x81) ? cpu->imm : signext(cpu->imm);
+	flag_sub16(cpu, cpu->oper1, cpu->oper2);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccCmp(cpu, 0x8000);
+}
 
-		case 0xE5:	/* E5 IN eAX Ib */
-			cpu->oper1b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			cpu->regs.wordregs[regax] = port_readw(cpu, cpu->oper1b);
-			break;
+/* 84 TEST Gb Eb, Jcc */
+FUNC_INLINE void fuse_84(CPU_t* cpu) {
+	op_84(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccTest(cpu, 0x80);
+}
 
-		case 0xE6:	/* E6 OUT Ib cpu->regs.byteregs[regal] */
-			cpu->oper1b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			port_write(cpu, cpu->oper1b, cpu->regs.byteregs[regal]);
-			break;
+/* 85 TEST Gv Ev, Jcc */
+FUNC_INLINE void fuse_85(CPU_t* cpu) {
+	op_85(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccTest(cpu, 0x8000);
+}
 
-		case 0xE7:	/* E7 OUT Ib eAX */
-			cpu->oper1b = getmem8(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 1);
-			port_writew(cpu, cpu->oper1b, cpu->regs.wordregs[regax]);
-			break;
+/* A8 TEST AL Ib, Jcc */
+FUNC_INLINE void fuse_A8(CPU_t* cpu) {
+	op_A8(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccTest(cpu, 0x80);
+}
 
-		case 0xE8:	/* E8 CALL Jv */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			push(cpu, cpu->ip);
-			cpu->ip = cpu->ip + cpu->oper1;
-			break;
+/* A9 TEST eAX Iv, Jcc */
+FUNC_INLINE void fuse_A9(CPU_t* cpu) {
+	op_A9(cpu);
+	if (cpu_fuseNext(cpu)) cpu_fuseJccTest(cpu, 0x8000);
+}
 
-		case 0xE9:	/* E9 JMP Jv */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			cpu->ip = cpu->ip + cpu->oper1;
-			break;
+/* AC LODSB, STOSB */
+FUNC_INLINE void fuse_AC(CPU_t* cpu) {
+	op_AC(cpu);
+	if (cpu_fuseNext(cpu)) {
+		putmem8(cpu, cpu->segregs[reges], cpu->regs.wordregs[regdi], cpu->regs.byteregs[regal]);
+		if (cpu->df) {
+			cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] - 1;
+		}
+		else {
+			cpu->regs.wordregs[regdi] = cpu->regs.wordregs[regdi] + 1;
+		}
+	}
+}
 
-		case 0xEA:	/* EA JMP Ap */
-			cpu->oper1 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			StepIP(cpu, 2);
-			cpu->oper2 = getmem16(cpu, cpu->segregs[regcs], cpu->ip);
-			cpu->ip = cpu->oper1;
-			cpu->segregs[regcs] = cpu->oper2;
-			break;
+/* E2 LOOP back to the top of its block */
+FUNC_INLINE void fuse_E2(CPU_t* cpu) {
+	cpu->regs.wordregs[regcx] = cpu->regs.wordregs[regcx] - 1;
+	if (cpu->regs.wordregs[regcx]) {
+		cpu_fuseBranch(cpu);
+	}
+}
 
-		case 0xEB:	/* EB JMP Jb */
-			cpu->oper1 = signext(getmem8(cpu, cpu->segregs[regcs], cpu->ip));
-			StepIP(cpu, 1);
-			cpu->ip = cpu->ip + cpu->oper1;
-			break;
+#define CPU_FUSED_LIST(F) \
+	F(38, fuse_38) F(39, fuse_39) F(3A, fuse_3A) F(3B, fuse_3B) F(3C, fuse_3C) F(3D, fuse_3D) F(46, fuse_46) \
+	F(47, fuse_46) F(48, fuse_48) F(49, fuse_48) F(4A, fuse_48) F(4B, fuse_48) F(4C, fuse_48) F(4D, fuse_48) \
+	F(4E, fuse_48) F(4F, fuse_48) F(80, fuse_80) F(81, fuse_81) F(82, fuse_80) F(83, fuse_81) F(84, fuse_84) \
+	F(85, fuse_85) F(A8, fuse_A8) F(A9, fuse_A9) F(AC, fuse_AC) F(E2, fuse_E2)
+#else
+#define CPU_FUSED_LIST(F)
+#endif
 
-		case 0xEC:	/* EC IN cpu->regs.byteregs[regal] regdx */
-			cpu->oper1 = cpu->regs.wordregs[regdx];
-			cpu->regs.byteregs[regal] = (uint8_t)port_read(cpu, cpu->oper1);
-			break;
+/* time passing in HLT, all of what's left of the budget unless the trap flag needs to be handled at each step */
+FUNC_INLINE void cpu_hltcycles(CPU_t* cpu) {
+	if (!cpu->trap_toggle && (cpu->cycles < cpu->budget)) {
+		cpu->cycles = cpu->budget;
+	}
+	else {
+		cpu->cycles += CPU_CYCLES_HLT;
+	}
+}
 
-		case 0xED:	/* ED IN eAX regdx */
-			cpu->oper1 = cpu->regs.wordregs[regdx];
-			cpu->regs.wordregs[regax] = port_readw(cpu, cpu->oper1);
-			break;
+#define CPU_SWITCH_CASE(n, handler, flags)	case 0x##n: handler(cpu); break;
+#define CPU_SWITCH_PREFIX(n, flags)
+#define CPU_SWITCH_FUSED(n, handler)	case CPU_FUSED | 0x##n: handler(cpu); break;
 
-		case 0xEE:	/* EE OUT regdx cpu->regs.byteregs[regal] */
-			cpu->oper1 = cpu->regs.wordregs[regdx];
-			port_write(cpu, cpu->oper1, cpu->regs.byteregs[regal]);
-			break;
+/* run a single instruction. in HLT nothing can happen until the timers raise an interrupt after cpu_exec returns, so the rest of the budget just passes */
+FUNC_INLINE void cpu_step(CPU_t* cpu) {
+	if (cpu->intr & cpu->ifl) {
+		cpu_boundaryInterrupt(cpu);
+	}
 
-		case 0xEF:	/* EF OUT regdx eAX */
-			cpu->oper1 = cpu->regs.wordregs[regdx];
-			port_writew(cpu, cpu->oper1, cpu->regs.wordregs[regax]);
-			break;
+	if (cpu->trap_toggle) {
+		cpu_intcall(cpu, 1);
+	}
 
-		case 0xF0:	/* F0 LOCK */
-			break;
+	if (cpu->tf) {
+		cpu->trap_toggle = 1;
+	}
+	else {
+		cpu->trap_toggle = 0;
+	}
 
-		case 0xF4:	/* F4 HLT */
-			cpu->hltstate = 1;
-			break;
+	if (cpu->hltstate) {
+		cpu_hltcycles(cpu);
+		return;
+	}
 
-		case 0xF5:	/* F5 CMC */
-			if (!cpu->cf) {
-				cpu->cf = 1;
-			}
-			else {
-				cpu->cf = 0;
-			}
-			break;
+	cpu->firstip = cpu->ip;
+	cpu_fetch(cpu);
+	cpu->totalexec++;
 
-		case 0xF6:	/* F6 GRP3a Eb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			op_grp3_8(cpu);
-			if ((cpu->reg > 1) && (cpu->reg < 4)) {
-				writerm8(cpu, cpu->rm, cpu->res8);
-			}
-			break;
+	switch (cpu->dispatch) {
+		CPU_OPCODE_LIST(CPU_SWITCH_CASE, CPU_SWITCH_PREFIX)
+		CPU_FUSED_LIST(CPU_SWITCH_FUSED)
+	}
+}
 
-		case 0xF7:	/* F7 GRP3b Ev */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			op_grp3_16(cpu);
-			if ((cpu->reg > 1) && (cpu->reg < 4)) {
-				writerm16(cpu, cpu->rm, cpu->res16);
-			}
-			break;
+void cpu_exec_switch(CPU_t* cpu, uint32_t cycles) {
+	while (cpu->cycles < cycles) {
+		cpu_step(cpu);
+	}
+}
 
-		case 0xF8:	/* F8 CLC */
-			cpu->cf = 0;
-			break;
+#ifdef CPU_THREADED_DISPATCH
+/*
+	Threaded core: every handler ends with its own copy of the dispatch sequence and jumps
+	straight to the next handler through a label table, rather than all instructions sharing
+	the single indirect branch of the switch. The trap flag, HLT state and interrupts waiting
+	to be taken are rare, so they are handled out of line at the boundary label.
+*/
+#define CPU_THREAD_LABEL(n, handler, flags)	&&opcode_##n,
+#define CPU_THREAD_PREFIXLABEL(n, flags)	NULL,
+#define CPU_THREAD_OP(n, handler, flags)	opcode_##n: handler(cpu); CPU_THREAD_NEXT();
+#define CPU_THREAD_PREFIX(n, flags)
+#define CPU_THREAD_FUSEDLABEL(n, handler)	[CPU_FUSED | 0x##n] = &&fused_##n,
+#define CPU_THREAD_FUSED(n, handler)	fused_##n: handler(cpu); CPU_THREAD_NEXT();
+
+#define CPU_THREAD_START() { \
+	cpu->firstip = cpu->ip; \
+	cpu_fetch(cpu); \
+	cpu->totalexec++; \
+	goto *optable[cpu->dispatch]; \
+}
 
-		case 0xF9:	/* F9 STC */
-			cpu->cf = 1;
-			break;
+#define CPU_THREAD_NEXT() { \
+	if (cpu->cycles >= cycles) return; \
+	if (cpu->trap_toggle | cpu->tf | cpu->hltstate | (cpu->intr & cpu->ifl)) goto boundary; \
+	CPU_THREAD_START(); \
+}
 
-		case 0xFA:	/* FA CLI */
-			cpu->ifl = 0;
-			break;
+void cpu_exec_threaded(CPU_t* cpu, uint32_t cycles) {
+	static const void* const optable[CPU_FUSED + 256] = { CPU_OPCODE_LIST(CPU_THREAD_LABEL, CPU_THREAD_PREFIXLABEL) CPU_FUSED_LIST(CPU_THREAD_FUSEDLABEL) };
 
-		case 0xFB:	/* FB STI */
-			cpu->ifl = 1;
-			break;
+	if (cpu->cycles >= cycles) return;
 
-		case 0xFC:	/* FC CLD */
-			cpu->df = 0;
-			break;
+boundary:
+	if (cpu->intr & cpu->ifl) {
+		cpu_boundaryInterrupt(cpu);
+	}
 
-		case 0xFD:	/* FD STD */
-			cpu->df = 1;
-			break;
+	if (cpu->trap_toggle) {
+		cpu_intcall(cpu, 1);
+	}
 
-		case 0xFE:	/* FE GRP4 Eb */
-			modregrm(cpu);
-			cpu->oper1b = readrm8(cpu, cpu->rm);
-			cpu->oper2b = 1;
-			if (!cpu->reg) {
-				cpu->tempcf = cpu->cf;
-				cpu->res8 = cpu->oper1b + cpu->oper2b;
-				flag_add8(cpu, cpu->oper1b, cpu->oper2b);
-				cpu->cf = cpu->tempcf;
-				writerm8(cpu, cpu->rm, cpu->res8);
-			}
-			else {
-				cpu->tempcf = cpu->cf;
-				cpu->res8 = cpu->oper1b - cpu->oper2b;
-				flag_sub8(cpu, cpu->oper1b, cpu->oper2b);
-				cpu->cf = cpu->tempcf;
-				writerm8(cpu, cpu->rm, cpu->res8);
-			}
-			break;
+	if (cpu->tf) {
+		cpu->trap_toggle = 1;
+	}
+	else {
+		cpu->trap_toggle = 0;
+	}
 
-		case 0xFF:	/* FF GRP5 Ev */
-			modregrm(cpu);
-			cpu->oper1 = readrm16(cpu, cpu->rm);
-			op_grp5(cpu);
-			break;
+	if (cpu->hltstate) {
+		cpu_hltcycles(cpu);
+		if (cpu->cycles >= cycles) return;
+		goto boundary;
+	}
 
-		default:
-#ifdef CPU_ALLOW_ILLEGAL_OP_EXCEPTION
-			cpu_intcall(cpu, 6); /* trip invalid opcode exception. this occurs on the 80186+, 8086/8088 CPUs treat them as NOPs. */
-						   /* technically they aren't exactly like NOPs in most cases, but for our pursoses, that's accurate enough. */
-			debug_log(DEBUG_INFO, "[CPU] Invalid opcode exception at %04X:%04X\r\n", cpu->segregs[regcs], firstip);
+	CPU_THREAD_START();
+
+	CPU_OPCODE_LIST(CPU_THREAD_OP, CPU_THREAD_PREFIX)
+	CPU_FUSED_LIST(CPU_THREAD_FUSED)
+}
 #endif
-			break;
+
+#ifdef CPU_JIT
+#define CPU_JIT_HANDLER(n, handler, flags)	handler,
+#define CPU_JIT_PREFIXHANDLER(n, flags)	NULL,
+
+void (* const cpu_handlers[256])(CPU_t* cpu) = { CPU_OPCODE_LIST(CPU_JIT_HANDLER, CPU_JIT_PREFIXHANDLER) };
+
+/*
+	JIT core: cached blocks that have run CPU_JIT_THRESHOLD times are translated to native
+	code by cpujit.c. The interpreter runs anything else one instruction at a time, which
+	includes the trap flag, HLT, code that can't be cached and blocks that don't fit in what's
+	left of the cycle budget. Interrupts are taken between blocks, only a handler call (port
+	access, STI, POPF...) can raise one inside a block and it leaves the block when that happens.
+	the block cache is only searched where the current block doesn't continue, so translations
+	always start at the top of a block instead of at every instruction that gets interpreted.
+*/
+void cpu_exec_jit(CPU_t* cpu, uint32_t cycles) {
+	CPU_BLOCK_t* block;
+	CPU_DECODED_t* dec;
+	uint8_t i;
+
+	while (cpu->cycles < cycles) {
+		block = cpu->block;
+		if (!(cpu->trap_toggle | cpu->tf | cpu->hltstate | (cpu->intr & cpu->ifl)) && ((block == NULL) || (cpu->blockpos == 0) || (cpu->blockpos >= block->count) ||
+			(block->ins[cpu->blockpos].ip != cpu->ip) || (block->cs != cpu->segregs[regcs]))) {
+			dec = cpu_cacheLookup(cpu);
+			if (dec != NULL) {
+				block = cpu->block;
+				cpu->blockpos = (uint8_t)(dec - block->ins); /* cpu_fetch takes it from here */
+				if (cpu->blockpos == 0) {
+					if ((block->code == NULL) && (++block->hits == CPU_JIT_THRESHOLD)) {
+						cpu_jitCompile(cpu, block);
+					}
+					if ((block->code != NULL) && ((cycles - cpu->cycles) >= block->cycles)) {
+						(*block->code)(cpu, cycles);
+						for (i = 0; (i < block->count) && (block->ins[i].ip != cpu->ip); i++);
+						cpu->blockpos = i;
+						continue;
+					}
+				}
+			}
 		}
+		cpu_step(cpu);
+	}
+}
+#endif
 
-	skipexecution:
-		;
+/* run until at least the given number of clock cycles have passed, returns how many did */
+uint32_t cpu_exec(CPU_t* cpu, uint32_t cycles) {
+	cpu->cycles = 0;
+	cpu->budget = cycles;
+#ifdef CPU_JIT
+	if (cpu->core == CPU_CORE_JIT) {
+		cpu_exec_jit(cpu, cycles);
+		return cpu->cycles;
+	}
+#endif
+#ifdef CPU_THREADED_DISPATCH
+	if (cpu->core != CPU_CORE_SWITCH) {
+		cpu_exec_threaded(cpu, cycles);
+		return cpu->cycles;
 	}
+#endif
+	cpu_exec_switch(cpu, cycles);
+	return cpu->cycles;
 }
 
-void cpu_registerIntCallback(CPU_t* cpu, uint8_t interrupt, void (*cb)(CPU_t*, uint8_t)) {
+void cpu_registerIntCallback(CPU_t* cpu, uint8_t interrupt, void (*cb)(CPU_t*, uint8_t, void*), void* udata) {
 	cpu->int_callback[interrupt] = cb;
+	cpu->int_udata[interrupt] = udata;
 }
@@ -23,26 +23,114 @@
 #include <stdint.h>
 #include "cpuconf.h"
 #include "../chipset/i8259.h"
+#include "../memory.h"
+#include "../ports.h"
+
+#define CPU_BLOCK_MAX		16		//Maximum instructions in a cached block
+#define CPU_BLOCK_COUNT		4096	//Number of cached blocks, must be a power of two
+#define CPU_JIT_THRESHOLD	32		//Times a cached block is run before the JIT translates it
+
+/* clock cycles that aren't in the tables in cpucycles.c */
+#define CPU_CYCLES_PREFIX	2		//Each prefix byte
+#define CPU_CYCLES_HLT		2		//Time that passes per check while halted with the trap flag set, otherwise the whole budget does
+#ifdef CPU_8086
+#define CPU_CYCLES_TAKEN	12		//Extra for a conditional jump or loop that's taken
+#define CPU_CYCLES_SHIFT	4		//Each bit of a shift or rotate by CL
+#else
+#define CPU_CYCLES_TAKEN	9
+#define CPU_CYCLES_SHIFT	1
+#endif
+#ifdef CPU_LIMIT_SHIFT_COUNT
+#define CPU_SHIFT_CYCLES(cnt)	(((cnt) & 0x1F) * CPU_CYCLES_SHIFT)
+#else
+#define CPU_SHIFT_CYCLES(cnt)	((cnt) * CPU_CYCLES_SHIFT)
+#endif
+
+/* decoder flags for each opcode */
+#define CPU_DEC_MODRM	0x01	/* ModR/M byte and displacement follow the opcode */
+#define CPU_DEC_IMM8	0x02	/* byte immediate */
+#define CPU_DEC_IMM16	0x04	/* word immediate */
+#define CPU_DEC_IMM2_8	0x08	/* second byte immediate */
+#define CPU_DEC_IMM2_16	0x10	/* second word immediate */
+#define CPU_DEC_GRP3	0x20	/* immediate only present for TEST in the F6/F7 group */
+#define CPU_DEC_BRANCH	0x40	/* may transfer control, ends a cached block */
+#define CPU_DEC_PREFIX	0x80
+
+/* dispatch entry of a fused instruction sequence, the opcode of its first instruction is added to it */
+#define CPU_FUSED	0x100
+
+/* last flag-setting operation, the arithmetic flags are worked out from it when something reads them */
+#define CPU_FLAGS_NONE	0	/* cf, pf, af, zf, sf and of all hold their values */
+#define CPU_FLAGS_ADD8	1
+#define CPU_FLAGS_ADD16	2
+#define CPU_FLAGS_SUB8	3
+#define CPU_FLAGS_SUB16	4
+#define CPU_FLAGS_INC8	5	/* like ADD, but cf holds its value */
+#define CPU_FLAGS_INC16	6
+#define CPU_FLAGS_DEC8	7	/* like SUB, but cf holds its value */
+#define CPU_FLAGS_DEC16	8
+#define CPU_FLAGS_LOG8	9	/* cf and of are clear, af holds its value */
+#define CPU_FLAGS_LOG16	10
 
 union _bytewordregs_ {
 	uint16_t wordregs[8];
 	uint8_t byteregs[8];
 };
 
+typedef struct {
+	uint16_t ip, len, prefixlen, disp16, imm, imm2, cycles;
+	uint16_t dispatch; //opcode, or CPU_FUSED plus the opcode where a fused sequence starts
+	uint8_t opcode, addrbyte, segoverride, useseg, reptype;
+} CPU_DECODED_t;
+
+typedef struct {
+	uint16_t cs, ip;
+	uint32_t page, page2;
+	uint32_t gen, gen2;
+	uint8_t count;
+	uint32_t cycles; //sum of the cycles of the instructions in it
+	CPU_DECODED_t ins[CPU_BLOCK_MAX];
+#ifdef CPU_JIT
+	uint32_t hits;
+	void (*code)(void*, uint32_t); //native code from the JIT, takes the CPU_t and the cycle budget
+#endif
+} CPU_BLOCK_t;
+
 typedef struct {
 	union _bytewordregs_ regs;
-	uint8_t	opcode, segoverride, reptype, hltstate;
+	uint8_t	opcode, segoverride, reptype, hltstate, intr;
 	uint16_t segregs[4], savecs, saveip, ip, useseg, oldsp;
 	uint8_t	tempcf, oldcf, cf, pf, af, zf, sf, tf, ifl, df, of, mode, reg, rm;
-	uint16_t oper1, oper2, res16, disp16, temp16, dummy, stacksize, frametemp;
+	uint8_t flagop;
+	uint32_t flagop1, flagop2, flagres;
+	uint16_t oper1, oper2, res16, disp16, temp16, dummy, stacksize, frametemp, imm, imm2;
 	uint8_t	oper1b, oper2b, res8, disp8, temp8, nestlev, addrbyte;
 	uint32_t temp1, temp2, temp3, temp4, temp5, temp32, tempaddr32, ea;
 	int32_t	result;
-	uint16_t trap_toggle;
+	uint16_t trap_toggle, firstip, repcycles;
+	uint32_t cycles, budget;
+	uint8_t core;
 	uint64_t totalexec;
-	void (*int_callback[256])(void*, uint8_t); //Want to pass a CPU object in first param, but it's not defined at this point so use a void*
+	I8259_t* i8259;
+	void (*int_callback[256])(void*, uint8_t, void*); //Want to pass a CPU object in first param, but it's not defined at this point so use a void*
+	void* int_udata[256];
+	MEMORY_t* memory;
+	PORTS_t* ports;
+	CPU_DECODED_t decoded;
+	uint16_t dispatch;
+	CPU_BLOCK_t* blocks;
+	CPU_BLOCK_t* block;
+	uint8_t blockpos;
+#ifdef CPU_JIT
+	uint8_t* jitbuf;
+	uint32_t jitpos;
+#endif
 } CPU_t;
 
+#define CPU_CORE_THREADED	0
+#define CPU_CORE_SWITCH		1
+#define CPU_CORE_JIT		2
+
 #define regax 0
 #define regcx 1
 #define regdx 2
@@ -93,6 +181,7 @@ typedef struct {
 
 #define makeflagsword(x) \
 	( \
+	cpu_flagsSync(x), \
 	2 | (uint16_t) x->cf | ((uint16_t) x->pf << 2) | ((uint16_t) x->af << 4) | ((uint16_t) x->zf << 6) | ((uint16_t) x->sf << 7) | \
 	((uint16_t) x->tf << 8) | ((uint16_t) x->ifl << 9) | ((uint16_t) x->df << 10) | ((uint16_t) x->of << 11) \
 	)
@@ -109,6 +198,7 @@ typedef struct {
 	x->ifl = (tmp >> 9) & 1; \
 	x->df = (tmp >> 10) & 1; \
 	x->of = (tmp >> 11) & 1; \
+	x->flagop = CPU_FLAGS_NONE; \
 }
 
 #define modregrm(x) { \
@@ -151,19 +241,26 @@ typedef struct {
 	} \
 }
 
+extern const uint8_t cpu_decodeflags[256];
+
+uint16_t cpu_cycles(CPU_DECODED_t* dec);
 
 uint8_t cpu_read(CPU_t* cpu, uint32_t addr);
 uint16_t cpu_readw(CPU_t* cpu, uint32_t addr);
 void cpu_write(CPU_t* cpu, uint32_t addr32, uint8_t value);
 void cpu_writew(CPU_t* cpu, uint32_t addr32, uint16_t value);
 void cpu_intcall(CPU_t* cpu, uint8_t intnum);
+void cpu_flagsSync(CPU_t* cpu);
 void cpu_reset(CPU_t* cpu);
+void cpu_cacheFlush(CPU_t* cpu);
 void cpu_interruptCheck(CPU_t* cpu, I8259_t* i8259);
-void cpu_exec(CPU_t* cpu, uint32_t execloops);
+void cpu_connectPIC(CPU_t* cpu, I8259_t* i8259);
+void cpu_connectBus(CPU_t* cpu, MEMORY_t* memory, PORTS_t* ports);
+uint32_t cpu_exec(CPU_t* cpu, uint32_t cycles);
 void port_write(CPU_t* cpu, uint16_t portnum, uint8_t value);
 void port_writew(CPU_t* cpu, uint16_t portnum, uint16_t value);
 uint8_t port_read(CPU_t* cpu, uint16_t portnum);
 uint16_t port_readw(CPU_t* cpu, uint16_t portnum);
-void cpu_registerIntCallback(CPU_t* cpu, uint8_t interrupt, void (*cb)(CPU_t*, uint8_t));
+void cpu_registerIntCallback(CPU_t* cpu, uint8_t interrupt, void (*cb)(CPU_t*, uint8_t, void*), void* udata);
 
 #endif
@@ -41,3 +41,26 @@
 #else
 #define CPU_SET_HIGH_FLAGS
 #endif
+
+//Use computed-goto threaded dispatch in cpu_exec where the compiler supports it (GCC and Clang).
+//Comment this out to only build the portable switch-based interpreter core.
+#if defined(__GNUC__)
+#define CPU_THREADED_DISPATCH
+#endif
+
+//Cache decoded blocks of guest code. Cached code is invalidated when the memory page it was decoded from is written to.
+#define CPU_BLOCK_CACHE
+
+//Run a few common instruction pairs in cached blocks as one fused step: CMP or TEST and a conditional jump,
+//DEC and JNZ, INC SI and INC DI, LODSB and STOSB. A LOOP back to the top of its block also stays in the block.
+#ifdef CPU_BLOCK_CACHE
+#define CPU_FUSE
+#endif
+
+//Run REP string instructions over plain memory in bulk, rather than one element per pass through dispatch.
+#define CPU_REP_BULK
+
+//Translate hot cached blocks into native code when -cpucore jit is used. Only x86-64 hosts are supported.
+#if defined(CPU_BLOCK_CACHE) && (defined(__x86_64__) || defined(_M_X64))
+#define CPU_JIT
+#endif
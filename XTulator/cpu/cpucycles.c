@@ -0,0 +1,171 @@
+/*
+  XTulator: A portable, open-source 80186 PC emulator.
+  Copyright (C)2020 Mike Chambers
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+	Clock cycle counts for each instruction, used to pace the CPU by time instead of by
+	instruction count. The numbers are the documented ones from Intel's manuals, taking the
+	upper end where a range is given. Each entry is { register operand form, memory operand form }.
+	For string instructions the second number is the cost of each iteration under a REP prefix.
+	Instructions that don't exist on the selected CPU use the 80186 numbers.
+*/
+
+#include <stdint.h>
+#include "cpu.h"
+
+#ifdef CPU_8086
+
+/* 8088, word memory operands include the extra bus cycles of its 8-bit bus. the EA calculation comes from cpu_eacycles. */
+const uint8_t cpu_cycletable[256][2] = {
+	/* 00 */ { 3, 16 }, { 3, 24 }, { 3, 9 }, { 3, 13 }, { 4, 4 }, { 4, 4 }, { 14, 14 }, { 12, 12 },
+	/* 08 */ { 3, 16 }, { 3, 24 }, { 3, 9 }, { 3, 13 }, { 4, 4 }, { 4, 4 }, { 14, 14 }, { 12, 12 },
+	/* 10 */ { 3, 16 }, { 3, 24 }, { 3, 9 }, { 3, 13 }, { 4, 4 }, { 4, 4 }, { 14, 14 }, { 12, 12 },
+	/* 18 */ { 3, 16 }, { 3, 24 }, { 3, 9 }, { 3, 13 }, { 4, 4 }, { 4, 4 }, { 14, 14 }, { 12, 12 },
+	/* 20 */ { 3, 16 }, { 3, 24 }, { 3, 9 }, { 3, 13 }, { 4, 4 }, { 4, 4 }, { 2, 2 }, { 4, 4 },
+	/* 28 */ { 3, 16 }, { 3, 24 }, { 3, 9 }, { 3, 13 }, { 4, 4 }, { 4, 4 }, { 2, 2 }, { 4, 4 },
+	/* 30 */ { 3, 16 }, { 3, 24 }, { 3, 9 }, { 3, 13 }, { 4, 4 }, { 4, 4 }, { 2, 2 }, { 8, 8 },
+	/* 38 */ { 3, 9 }, { 3, 13 }, { 3, 9 }, { 3, 13 }, { 4, 4 }, { 4, 4 }, { 2, 2 }, { 8, 8 },
+	/* 40 */ { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 },
+	/* 48 */ { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 },
+	/* 50 */ { 15, 15 }, { 15, 15 }, { 15, 15 }, { 15, 15 }, { 15, 15 }, { 15, 15 }, { 15, 15 }, { 15, 15 },
+	/* 58 */ { 12, 12 }, { 12, 12 }, { 12, 12 }, { 12, 12 }, { 12, 12 }, { 12, 12 }, { 12, 12 }, { 12, 12 },
+	/* 60 */ { 36, 36 }, { 51, 51 }, { 35, 35 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 },
+	/* 68 */ { 10, 10 }, { 25, 32 }, { 10, 10 }, { 25, 32 }, { 14, 8 }, { 14, 8 }, { 14, 8 }, { 14, 8 },
+	/* 70 */ { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 },
+	/* 78 */ { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 },
+	/* 80 */ { 4, 17 }, { 4, 25 }, { 4, 17 }, { 4, 25 }, { 3, 9 }, { 3, 13 }, { 4, 17 }, { 4, 25 },
+	/* 88 */ { 2, 9 }, { 2, 13 }, { 2, 8 }, { 2, 12 }, { 2, 13 }, { 2, 2 }, { 2, 12 }, { 12, 25 },
+	/* 90 */ { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 },
+	/* 98 */ { 2, 2 }, { 5, 5 }, { 36, 36 }, { 4, 4 }, { 14, 14 }, { 12, 12 }, { 4, 4 }, { 4, 4 },
+	/* A0 */ { 10, 10 }, { 14, 14 }, { 10, 10 }, { 14, 14 }, { 18, 17 }, { 26, 25 }, { 22, 22 }, { 30, 30 },
+	/* A8 */ { 4, 4 }, { 4, 4 }, { 11, 10 }, { 15, 14 }, { 12, 13 }, { 16, 17 }, { 15, 15 }, { 19, 19 },
+	/* B0 */ { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 },
+	/* B8 */ { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 },
+	/* C0 */ { 5, 17 }, { 5, 25 }, { 24, 24 }, { 20, 20 }, { 24, 24 }, { 24, 24 }, { 4, 10 }, { 4, 14 },
+	/* C8 */ { 15, 15 }, { 8, 8 }, { 33, 33 }, { 34, 34 }, { 72, 72 }, { 71, 71 }, { 4, 4 }, { 44, 44 },
+	/* D0 */ { 2, 15 }, { 2, 23 }, { 8, 20 }, { 8, 28 }, { 83, 83 }, { 60, 60 }, { 4, 4 }, { 11, 11 },
+	/* D8 */ { 2, 8 }, { 2, 8 }, { 2, 8 }, { 2, 8 }, { 2, 8 }, { 2, 8 }, { 2, 8 }, { 2, 8 },
+	/* E0 */ { 5, 5 }, { 6, 6 }, { 5, 5 }, { 6, 6 }, { 10, 10 }, { 14, 14 }, { 10, 10 }, { 14, 14 },
+	/* E8 */ { 23, 23 }, { 15, 15 }, { 15, 15 }, { 15, 15 }, { 8, 8 }, { 12, 12 }, { 8, 8 }, { 12, 12 },
+	/* F0 */ { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 5, 11 }, { 5, 15 },
+	/* F8 */ { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 3, 15 }, { 3, 23 }
+};
+
+/* the groups where the ModR/M reg field picks the instruction: 80/82, 81/83, F6, F7, FE, FF */
+const uint8_t cpu_cyclegroup[6][8][2] = {
+	{ { 4, 17 }, { 4, 17 }, { 4, 17 }, { 4, 17 }, { 4, 17 }, { 4, 17 }, { 4, 17 }, { 4, 10 } },
+	{ { 4, 25 }, { 4, 25 }, { 4, 25 }, { 4, 25 }, { 4, 25 }, { 4, 25 }, { 4, 25 }, { 4, 14 } },
+	{ { 5, 11 }, { 5, 11 }, { 3, 16 }, { 3, 16 }, { 77, 83 }, { 98, 104 }, { 90, 96 }, { 112, 118 } },
+	{ { 5, 15 }, { 5, 15 }, { 3, 24 }, { 3, 24 }, { 133, 143 }, { 154, 164 }, { 162, 172 }, { 184, 194 } },
+	{ { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 } },
+	{ { 3, 23 }, { 3, 23 }, { 20, 29 }, { 53, 53 }, { 11, 22 }, { 32, 32 }, { 15, 24 }, { 15, 24 } }
+};
+
+/* effective address calculation for each ModR/M mode and r/m, mode 2 is the same as mode 1 */
+const uint8_t cpu_eacycles[2][8] = {
+	{ 7, 8, 8, 7, 5, 5, 6, 5 },
+	{ 11, 12, 12, 11, 9, 9, 9, 9 }
+};
+
+#else
+
+/* 80186, the V20 is close enough to use the same numbers. EAs are calculated in dedicated hardware, so they're included. */
+const uint8_t cpu_cycletable[256][2] = {
+	/* 00 */ { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 3 }, { 4, 4 }, { 9, 9 }, { 8, 8 },
+	/* 08 */ { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 3 }, { 4, 4 }, { 9, 9 }, { 8, 8 },
+	/* 10 */ { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 3 }, { 4, 4 }, { 9, 9 }, { 8, 8 },
+	/* 18 */ { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 3 }, { 4, 4 }, { 9, 9 }, { 8, 8 },
+	/* 20 */ { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 3 }, { 4, 4 }, { 2, 2 }, { 4, 4 },
+	/* 28 */ { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 3 }, { 4, 4 }, { 2, 2 }, { 4, 4 },
+	/* 30 */ { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 3 }, { 4, 4 }, { 2, 2 }, { 8, 8 },
+	/* 38 */ { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 10 }, { 3, 3 }, { 4, 4 }, { 2, 2 }, { 7, 7 },
+	/* 40 */ { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 },
+	/* 48 */ { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 },
+	/* 50 */ { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 },
+	/* 58 */ { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 }, { 10, 10 },
+	/* 60 */ { 36, 36 }, { 51, 51 }, { 35, 35 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 },
+	/* 68 */ { 10, 10 }, { 25, 32 }, { 10, 10 }, { 25, 32 }, { 14, 8 }, { 14, 8 }, { 14, 8 }, { 14, 8 },
+	/* 70 */ { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 },
+	/* 78 */ { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 },
+	/* 80 */ { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 3, 10 }, { 3, 10 }, { 4, 17 }, { 4, 17 },
+	/* 88 */ { 2, 12 }, { 2, 12 }, { 2, 9 }, { 2, 9 }, { 2, 11 }, { 6, 6 }, { 2, 9 }, { 10, 20 },
+	/* 90 */ { 3, 3 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 },
+	/* 98 */ { 2, 2 }, { 4, 4 }, { 23, 23 }, { 6, 6 }, { 9, 9 }, { 8, 8 }, { 3, 3 }, { 2, 2 },
+	/* A0 */ { 8, 8 }, { 8, 8 }, { 9, 9 }, { 9, 9 }, { 14, 8 }, { 14, 8 }, { 22, 22 }, { 22, 22 },
+	/* A8 */ { 3, 3 }, { 4, 4 }, { 10, 9 }, { 10, 9 }, { 12, 11 }, { 12, 11 }, { 15, 15 }, { 15, 15 },
+	/* B0 */ { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 },
+	/* B8 */ { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 },
+	/* C0 */ { 5, 17 }, { 5, 17 }, { 18, 18 }, { 16, 16 }, { 18, 18 }, { 18, 18 }, { 3, 12 }, { 4, 13 },
+	/* C8 */ { 15, 15 }, { 8, 8 }, { 25, 25 }, { 22, 22 }, { 45, 45 }, { 47, 47 }, { 4, 4 }, { 28, 28 },
+	/* D0 */ { 2, 15 }, { 2, 15 }, { 5, 17 }, { 5, 17 }, { 19, 19 }, { 15, 15 }, { 3, 3 }, { 11, 11 },
+	/* D8 */ { 6, 6 }, { 6, 6 }, { 6, 6 }, { 6, 6 }, { 6, 6 }, { 6, 6 }, { 6, 6 }, { 6, 6 },
+	/* E0 */ { 5, 5 }, { 5, 5 }, { 5, 5 }, { 5, 5 }, { 10, 10 }, { 10, 10 }, { 9, 9 }, { 9, 9 },
+	/* E8 */ { 15, 15 }, { 14, 14 }, { 14, 14 }, { 14, 14 }, { 8, 8 }, { 8, 8 }, { 7, 7 }, { 7, 7 },
+	/* F0 */ { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 4, 10 }, { 4, 10 },
+	/* F8 */ { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 2, 2 }, { 3, 15 }, { 3, 15 }
+};
+
+const uint8_t cpu_cyclegroup[6][8][2] = {
+	{ { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 3, 10 } },
+	{ { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 4, 16 }, { 3, 10 } },
+	{ { 4, 10 }, { 4, 10 }, { 3, 10 }, { 3, 10 }, { 28, 34 }, { 28, 34 }, { 29, 35 }, { 52, 58 } },
+	{ { 4, 10 }, { 4, 10 }, { 3, 10 }, { 3, 10 }, { 37, 43 }, { 37, 43 }, { 38, 44 }, { 61, 67 } },
+	{ { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 }, { 3, 15 } },
+	{ { 3, 15 }, { 3, 15 }, { 13, 19 }, { 38, 38 }, { 11, 17 }, { 26, 26 }, { 10, 16 }, { 10, 16 } }
+};
+
+#endif
+
+/* cycles a decoded instruction takes, not counting anything that depends on what it does when it runs */
+uint16_t cpu_cycles(CPU_DECODED_t* dec) {
+	uint8_t flags = cpu_decodeflags[dec->opcode], mode = dec->addrbyte >> 6, reg = (dec->addrbyte >> 3) & 7;
+	uint8_t mem, group;
+	uint16_t cycles;
+
+	if (flags & CPU_DEC_MODRM) {
+		mem = (mode != 3);
+	}
+	else {
+		mem = (dec->reptype != 0); /* REP string instructions */
+	}
+
+	switch (dec->opcode) {
+	case 0x80: case 0x82: group = 0; break;
+	case 0x81: case 0x83: group = 1; break;
+	case 0xF6: group = 2; break;
+	case 0xF7: group = 3; break;
+	case 0xFE: group = 4; break;
+	case 0xFF: group = 5; break;
+	default: group = 0xFF; break;
+	}
+
+	if (group != 0xFF) {
+		cycles = cpu_cyclegroup[group][reg][mem];
+	}
+	else {
+		cycles = cpu_cycletable[dec->opcode][mem];
+	}
+
+	cycles += dec->prefixlen * CPU_CYCLES_PREFIX;
+#ifdef CPU_8086
+	if ((flags & CPU_DEC_MODRM) && mem) {
+		cycles += cpu_eacycles[mode ? 1 : 0][dec->addrbyte & 7];
+	}
+#endif
+	return cycles;
+}
@@ -0,0 +1,832 @@
+/*
+  XTulator: A portable, open-source 80186 PC emulator.
+  Copyright (C)2020 Mike Chambers
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+	Template JIT for x86-64 hosts. Cached blocks that have been run CPU_JIT_THRESHOLD
+	times are translated into native code. Simple register, flag and branch instructions
+	and plain MOVs to and from memory are emitted inline, with RAM accessed directly through
+	the memory map and cpu_read/cpu_write only called for anything else. Every other
+	instruction calls its interpreter handler with the decoded fields stored into the CPU_t.
+
+	The guest registers stay in the CPU_t, which the generated code addresses through RBX.
+	Native code runs one block at a time and hands control back to cpu_exec_jit at the end
+	of it, whenever the trap flag or HLT need handling, and when the block's code is written to.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "cpu.h"
+#include "../config.h"
+
+#ifdef CPU_JIT
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "cpujit.h"
+#include "../debuglog.h"
+#include "../memory.h"
+
+#define JIT_CPU(field)	((uint32_t)offsetof(CPU_t, field))
+#define JIT_REG16(r)	(JIT_CPU(regs) + (r) * 2)
+#define JIT_REG8(r)		(JIT_CPU(regs) + byteregtable[r])
+#define JIT_SEG(s)		(JIT_CPU(segregs) + (s) * 2)
+
+//x86 condition codes, the opposite condition is always the code XOR 1
+#define JIT_CC_O	0x0
+#define JIT_CC_B	0x2
+#define JIT_CC_E	0x4
+#define JIT_CC_NE	0x5
+#define JIT_CC_S	0x8
+#define JIT_CC_P	0xA
+#define JIT_CC_L	0xC
+
+void jit_emit8(CPU_JIT_t* jit, uint8_t value) {
+	*jit->p++ = value;
+}
+
+void jit_emit16(CPU_JIT_t* jit, uint16_t value) {
+	jit_emit8(jit, (uint8_t)value);
+	jit_emit8(jit, (uint8_t)(value >> 8));
+}
+
+void jit_emit32(CPU_JIT_t* jit, uint32_t value) {
+	jit_emit16(jit, (uint16_t)value);
+	jit_emit16(jit, (uint16_t)(value >> 16));
+}
+
+void jit_emit64(CPU_JIT_t* jit, uint64_t value) {
+	jit_emit32(jit, (uint32_t)value);
+	jit_emit32(jit, (uint32_t)(value >> 32));
+}
+
+//ModR/M for a [rbx + ofs] operand, RBX always points at the CPU_t
+void jit_cpuop(CPU_JIT_t* jit, uint8_t reg, uint32_t ofs) {
+	if (ofs < 0x80) {
+		jit_emit8(jit, 0x43 | (reg << 3));
+		jit_emit8(jit, (uint8_t)ofs);
+	}
+	else {
+		jit_emit8(jit, 0x83 | (reg << 3));
+		jit_emit32(jit, ofs);
+	}
+}
+
+void jit_link(uint8_t* rel, uint8_t* target) {
+	uint32_t disp = (uint32_t)(target - (rel + 4));
+	rel[0] = (uint8_t)disp;
+	rel[1] = (uint8_t)(disp >> 8);
+	rel[2] = (uint8_t)(disp >> 16);
+	rel[3] = (uint8_t)(disp >> 24);
+}
+
+void jit_patch(CPU_JIT_t* jit, uint8_t* rel) {
+	jit_link(rel, jit->p);
+}
+
+//conditional and unconditional jumps, returns where the displacement goes
+uint8_t* jit_jcc(CPU_JIT_t* jit, uint8_t cc) {
+	jit_emit8(jit, 0x0F);
+	jit_emit8(jit, 0x80 | cc);
+	jit_emit32(jit, 0);
+	return jit->p - 4;
+}
+
+uint8_t* jit_jmp(CPU_JIT_t* jit) {
+	jit_emit8(jit, 0xE9);
+	jit_emit32(jit, 0);
+	return jit->p - 4;
+}
+
+//load the CPU_t pointer into the first argument register and call a C function
+void jit_call(CPU_JIT_t* jit, void* func) {
+#ifdef _WIN32
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x89); jit_emit8(jit, 0xD9); //mov rcx, rbx
+#else
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x89); jit_emit8(jit, 0xDF); //mov rdi, rbx
+#endif
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0xB8); jit_emit64(jit, (uint64_t)(uintptr_t)func); //mov rax, func
+	jit_emit8(jit, 0xFF); jit_emit8(jit, 0xD0); //call rax
+}
+
+void jit_store8(CPU_JIT_t* jit, uint32_t ofs, uint8_t value) {
+	jit_emit8(jit, 0xC6); jit_cpuop(jit, 0, ofs); jit_emit8(jit, value);
+}
+
+void jit_store16(CPU_JIT_t* jit, uint32_t ofs, uint16_t value) {
+	jit_emit8(jit, 0x66); jit_emit8(jit, 0xC7); jit_cpuop(jit, 0, ofs); jit_emit16(jit, value);
+}
+
+//movzx hreg, byte/word [rbx + ofs]
+void jit_load8(CPU_JIT_t* jit, uint8_t hreg, uint32_t ofs) {
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0xB6); jit_cpuop(jit, hreg, ofs);
+}
+
+void jit_load16(CPU_JIT_t* jit, uint8_t hreg, uint32_t ofs) {
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0xB7); jit_cpuop(jit, hreg, ofs);
+}
+
+//mov [rbx + ofs], hreg (byte or word)
+void jit_save8(CPU_JIT_t* jit, uint8_t hreg, uint32_t ofs) {
+	jit_emit8(jit, 0x88); jit_cpuop(jit, hreg, ofs);
+}
+
+void jit_save16(CPU_JIT_t* jit, uint8_t hreg, uint32_t ofs) {
+	jit_emit8(jit, 0x66); jit_emit8(jit, 0x89); jit_cpuop(jit, hreg, ofs);
+}
+
+//cmp word [rbx + ofs], value
+void jit_cmp16(CPU_JIT_t* jit, uint32_t ofs, uint16_t value) {
+	jit_emit8(jit, 0x66); jit_emit8(jit, 0x81); jit_cpuop(jit, 7, ofs); jit_emit16(jit, value);
+}
+
+//add instructions run natively to totalexec and the cycles they took to cycles
+void jit_count(CPU_JIT_t* jit, uint8_t count, uint32_t cycles) {
+	if (!count) return;
+	jit_emit8(jit, 0x81); jit_cpuop(jit, 0, JIT_CPU(cycles)); jit_emit32(jit, cycles);
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x83); jit_cpuop(jit, 0, JIT_CPU(totalexec)); jit_emit8(jit, count);
+}
+
+//an instruction run natively that hasn't been counted yet
+void jit_pend(CPU_JIT_t* jit, CPU_DECODED_t* dec) {
+	jit->pending++;
+	jit->pendcycles += dec->cycles;
+}
+
+void jit_unpend(CPU_JIT_t* jit, CPU_DECODED_t* dec) {
+	jit->pending--;
+	jit->pendcycles -= dec->cycles;
+}
+
+void jit_sync(CPU_JIT_t* jit) {
+	jit_count(jit, jit->pending, jit->pendcycles);
+	jit->pending = 0;
+	jit->pendcycles = 0;
+}
+
+//return to cpu_exec_jit when the condition is true, first setting IP if the instruction left it alone
+void jit_exitIf(CPU_JIT_t* jit, uint8_t cc, uint8_t setip, uint16_t ip) {
+	uint8_t* skip;
+
+	if (!setip && !jit->pending) {
+		jit_link(jit_jcc(jit, cc), jit->exit);
+		return;
+	}
+
+	skip = jit_jcc(jit, cc ^ 1);
+	jit_count(jit, jit->pending, jit->pendcycles);
+	if (setip) {
+		jit_store16(jit, JIT_CPU(ip), ip);
+	}
+	jit_link(jit_jmp(jit), jit->exit);
+	jit_patch(jit, skip);
+}
+
+//exit if the block's code has been written to since it was translated
+void jit_checkCode(CPU_JIT_t* jit, uint8_t setip, uint16_t ip) {
+	CPU_BLOCK_t* block = jit->block;
+
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0xB8); jit_emit64(jit, (uint64_t)(uintptr_t)&jit->cpu->memory->codeGen[block->page]); //mov rax, &gen
+	jit_emit8(jit, 0x81); jit_emit8(jit, 0x38); jit_emit32(jit, block->gen); //cmp dword [rax], gen
+	jit_exitIf(jit, JIT_CC_NE, setip, ip);
+	if (block->page2 != block->page) {
+		jit_emit8(jit, 0x48); jit_emit8(jit, 0xB8); jit_emit64(jit, (uint64_t)(uintptr_t)&jit->cpu->memory->codeGen[block->page2]);
+		jit_emit8(jit, 0x81); jit_emit8(jit, 0x38); jit_emit32(jit, block->gen2);
+		jit_exitIf(jit, JIT_CC_NE, setip, ip);
+	}
+}
+
+//exit unless what's left of the cycle budget covers the given number of cycles, it can already be overspent
+void jit_budget(CPU_JIT_t* jit, uint32_t cycles) {
+	jit_emit8(jit, 0x44); jit_emit8(jit, 0x89); jit_emit8(jit, 0xE0); //mov eax, r12d
+	jit_emit8(jit, 0x2B); jit_cpuop(jit, 0, JIT_CPU(cycles)); //sub eax, [cycles]
+	jit_emit8(jit, 0x3D); jit_emit32(jit, cycles); //cmp eax, cycles
+	jit_link(jit_jcc(jit, JIT_CC_L), jit->exit);
+}
+
+void jit_loop(CPU_JIT_t* jit, uint32_t cycles, uint8_t* target) {
+	jit_budget(jit, cycles);
+	jit_link(jit_jmp(jit), target);
+}
+
+//jump to the end of the block, looping back to the top when that's where the guest code goes
+void jit_branch(CPU_JIT_t* jit, uint16_t target) {
+	jit_store16(jit, JIT_CPU(ip), target);
+	if (target == jit->block->ip) {
+		jit_loop(jit, jit->block->cycles, jit->top);
+	}
+	else {
+		jit_link(jit_jmp(jit), jit->exit);
+	}
+}
+
+//effective address of a ModR/M memory operand into EBP, the same way getea works
+void jit_ea(CPU_JIT_t* jit, CPU_DECODED_t* dec) {
+	static const uint8_t base1[8] = { regbx, regbx, regbp, regbp, regsi, regdi, regbp, regbx };
+	static const uint8_t base2[8] = { regsi, regdi, regsi, regdi, 0xFF, 0xFF, 0xFF, 0xFF };
+	uint8_t mode = dec->addrbyte >> 6, rm = dec->addrbyte & 7;
+
+	if ((mode == 0) && (rm == 6)) {
+		jit_emit8(jit, 0xBD); jit_emit32(jit, dec->disp16); //mov ebp, disp16
+	}
+	else {
+		jit_load16(jit, 5, JIT_REG16(base1[rm])); //movzx ebp, word [base]
+		if (base2[rm] != 0xFF) {
+			jit_emit8(jit, 0x66); jit_emit8(jit, 0x03); jit_cpuop(jit, 5, JIT_REG16(base2[rm])); //add bp, [index]
+		}
+		if (mode && dec->disp16) {
+			jit_emit8(jit, 0x66); jit_emit8(jit, 0x81); jit_emit8(jit, 0xC5); jit_emit16(jit, dec->disp16); //add bp, disp16
+		}
+	}
+	jit_load16(jit, 0, JIT_SEG(dec->useseg));
+	jit_emit8(jit, 0xC1); jit_emit8(jit, 0xE0); jit_emit8(jit, 0x04); //shl eax, 4
+	jit_emit8(jit, 0x01); jit_emit8(jit, 0xC5); //add ebp, eax
+}
+
+//linear address EBP + offset, wrapped to the memory range, into EAX
+void jit_addr(CPU_JIT_t* jit, uint8_t offset) {
+	jit_emit8(jit, 0x8D); jit_emit8(jit, 0x45); jit_emit8(jit, offset); //lea eax, [rbp + offset]
+	jit_emit8(jit, 0x25); jit_emit32(jit, MEMORY_MASK); //and eax, MEMORY_MASK
+}
+
+//host pointer to the byte at EAX in RDX through a page table, ZF is set when the page isn't plain memory. EAX is left alone for the slow path
+void jit_page(CPU_JIT_t* jit, uint8_t** table) {
+	jit_emit8(jit, 0x89); jit_emit8(jit, 0xC1); //mov ecx, eax
+	jit_emit8(jit, 0xC1); jit_emit8(jit, 0xE9); jit_emit8(jit, MEMORY_PAGE_SHIFT); //shr ecx, MEMORY_PAGE_SHIFT
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0xBA); jit_emit64(jit, (uint64_t)(uintptr_t)table); //mov rdx, table
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x8B); jit_emit8(jit, 0x14); jit_emit8(jit, 0xCA); //mov rdx, [rdx + rcx * 8]
+	jit_emit8(jit, 0x89); jit_emit8(jit, 0xC1); //mov ecx, eax
+	jit_emit8(jit, 0x81); jit_emit8(jit, 0xE1); jit_emit32(jit, MEMORY_PAGE_MASK); //and ecx, MEMORY_PAGE_MASK
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x85); jit_emit8(jit, 0xD2); //test rdx, rdx
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x8D); jit_emit8(jit, 0x14); jit_emit8(jit, 0x0A); //lea rdx, [rdx + rcx], leaves the flags alone
+}
+
+//read the byte at EBP + offset into [rbx + ofs], directly from RAM when it's mapped there
+void jit_read8(CPU_JIT_t* jit, uint8_t offset, uint32_t ofs) {
+	uint8_t *slow, *done;
+
+	jit_addr(jit, offset);
+	jit_page(jit, jit->cpu->memory->pageRead);
+	slow = jit_jcc(jit, JIT_CC_E);
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0xB6); jit_emit8(jit, 0x02); //movzx eax, byte [rdx]
+	done = jit_jmp(jit);
+	jit_patch(jit, slow);
+#ifdef _WIN32
+	jit_emit8(jit, 0x89); jit_emit8(jit, 0xC2); //mov edx, eax
+#else
+	jit_emit8(jit, 0x89); jit_emit8(jit, 0xC6); //mov esi, eax
+#endif
+	jit_call(jit, (void*)cpu_read);
+	jit_patch(jit, done);
+	jit_save8(jit, 0, ofs);
+}
+
+//write a byte from [rbx + ofs] (or an immediate) to EBP + offset, RAM is written directly unless there's cached code in the page
+void jit_write8(CPU_JIT_t* jit, uint8_t offset, uint8_t isimm, uint32_t ofs, uint8_t value) {
+	uint8_t *slow, *slow2, *done;
+
+	jit_addr(jit, offset);
+	jit_emit8(jit, 0x89); jit_emit8(jit, 0xC1); //mov ecx, eax
+	jit_emit8(jit, 0xC1); jit_emit8(jit, 0xE9); jit_emit8(jit, MEMORY_CODE_SHIFT); //shr ecx, MEMORY_CODE_SHIFT
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0xBA); jit_emit64(jit, (uint64_t)(uintptr_t)jit->cpu->memory->codePage); //mov rdx, codePage
+	jit_emit8(jit, 0x80); jit_emit8(jit, 0x3C); jit_emit8(jit, 0x0A); jit_emit8(jit, 0x00); //cmp byte [rdx + rcx], 0
+	slow = jit_jcc(jit, JIT_CC_NE);
+	jit_page(jit, jit->cpu->memory->pageWrite);
+	slow2 = jit_jcc(jit, JIT_CC_E);
+	if (isimm) {
+		jit_emit8(jit, 0xB1); jit_emit8(jit, value); //mov cl, value
+	}
+	else {
+		jit_load8(jit, 1, ofs);
+	}
+	jit_emit8(jit, 0x88); jit_emit8(jit, 0x0A); //mov [rdx], cl
+	done = jit_jmp(jit);
+	jit_patch(jit, slow);
+	jit_patch(jit, slow2);
+#ifdef _WIN32
+	jit_emit8(jit, 0x89); jit_emit8(jit, 0xC2); //mov edx, eax
+	if (isimm) {
+		jit_emit8(jit, 0x41); jit_emit8(jit, 0xB8); jit_emit32(jit, value); //mov r8d, value
+	}
+	else {
+		jit_emit8(jit, 0x44); jit_load8(jit, 0, ofs); //movzx r8d, byte [rbx + ofs]
+	}
+#else
+	jit_emit8(jit, 0x89); jit_emit8(jit, 0xC6); //mov esi, eax
+	if (isimm) {
+		jit_emit8(jit, 0xBA); jit_emit32(jit, value); //mov edx, value
+	}
+	else {
+		jit_load8(jit, 2, ofs);
+	}
+#endif
+	jit_call(jit, (void*)cpu_write);
+	jit_patch(jit, done);
+}
+
+/*
+	make sure the flag fields hold the guest flags before native code reads them or only sets
+	some of them. they can still be lazy in flagop when an interpreter handler set them last.
+*/
+void jit_flags(CPU_JIT_t* jit) {
+	uint8_t* skip;
+
+	if (jit->flagsync) return;
+	jit_emit8(jit, 0x80); jit_cpuop(jit, 7, JIT_CPU(flagop)); jit_emit8(jit, CPU_FLAGS_NONE); //cmp byte [flagop], CPU_FLAGS_NONE
+	skip = jit_jcc(jit, JIT_CC_E);
+	jit_call(jit, (void*)cpu_flagsSync);
+	jit_patch(jit, skip);
+	jit->flagsync = 1;
+}
+
+/*
+	ALU operation on [rbx + dst] with either [rbx + src] or an immediate, setting the guest
+	flags from the host's. Only used where the interpreter's flags match the hardware:
+	ADD, SUB and CMP set all six, the logic ops clear CF and OF and leave AF alone.
+	op is the ModR/M reg field of the 80-83 group, 8 means TEST.
+*/
+void jit_alu(CPU_JIT_t* jit, uint8_t op, uint8_t wide, uint32_t dst, uint8_t isimm, uint32_t src, uint16_t imm) {
+	if ((op == 0) || (op == 5) || (op == 7)) {
+		if (!jit->flagsync) {
+			jit_store8(jit, JIT_CPU(flagop), CPU_FLAGS_NONE); //all six are stored below
+			jit->flagsync = 1;
+		}
+	}
+	else {
+		jit_flags(jit);
+	}
+
+	if (wide) {
+		jit_load16(jit, 0, dst);
+		jit_emit8(jit, 0x66);
+	}
+	else {
+		jit_load8(jit, 0, dst);
+	}
+
+	if (isimm) {
+		if (op == 8) {
+			jit_emit8(jit, wide ? 0xA9 : 0xA8); //test ax/al, imm
+		}
+		else {
+			jit_emit8(jit, wide ? 0x81 : 0x80); //op ax/al, imm
+			jit_emit8(jit, 0xC0 | (op << 3));
+		}
+		if (wide) jit_emit16(jit, imm);
+		else jit_emit8(jit, (uint8_t)imm);
+	}
+	else {
+		if (op == 8) {
+			jit_emit8(jit, wide ? 0x85 : 0x84); //test ax/al, [src]
+		}
+		else {
+			jit_emit8(jit, (op << 3) | (wide ? 3 : 2)); //op ax/al, [src]
+		}
+		jit_cpuop(jit, 0, src);
+	}
+
+	if (op < 7) {
+		if (wide) jit_save16(jit, 0, dst);
+		else jit_save8(jit, 0, dst);
+	}
+
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_B); jit_cpuop(jit, 0, JIT_CPU(cf)); //setc [cf]
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_O); jit_cpuop(jit, 0, JIT_CPU(of)); //seto [of]
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_E); jit_cpuop(jit, 0, JIT_CPU(zf)); //setz [zf]
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_S); jit_cpuop(jit, 0, JIT_CPU(sf)); //sets [sf]
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_P); jit_cpuop(jit, 0, JIT_CPU(pf)); //setp [pf]
+	if ((op == 0) || (op == 5) || (op == 7)) {
+		jit_emit8(jit, 0x9F); //lahf
+		jit_emit8(jit, 0xC0); jit_emit8(jit, 0xEC); jit_emit8(jit, 0x04); //shr ah, 4
+		jit_emit8(jit, 0x80); jit_emit8(jit, 0xE4); jit_emit8(jit, 0x01); //and ah, 1
+		jit_save8(jit, 4, JIT_CPU(af)); //mov [af], ah
+	}
+}
+
+//INC/DEC of a word register, CF is left alone
+void jit_incdec(CPU_JIT_t* jit, uint8_t dec, uint32_t reg) {
+	jit_flags(jit);
+	jit_load16(jit, 0, reg);
+	jit_emit8(jit, 0x66); jit_emit8(jit, 0xFF); jit_emit8(jit, dec ? 0xC8 : 0xC0); //inc/dec ax
+	jit_save16(jit, 0, reg);
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_O); jit_cpuop(jit, 0, JIT_CPU(of));
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_E); jit_cpuop(jit, 0, JIT_CPU(zf));
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_S); jit_cpuop(jit, 0, JIT_CPU(sf));
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x90 | JIT_CC_P); jit_cpuop(jit, 0, JIT_CPU(pf));
+	jit_emit8(jit, 0x9F);
+	jit_emit8(jit, 0xC0); jit_emit8(jit, 0xEC); jit_emit8(jit, 0x04);
+	jit_emit8(jit, 0x80); jit_emit8(jit, 0xE4); jit_emit8(jit, 0x01);
+	jit_save8(jit, 4, JIT_CPU(af));
+}
+
+//conditional jump 70-7F, leaves the condition true in the host's NE
+void jit_condition(CPU_JIT_t* jit, uint8_t opcode) {
+	static const uint8_t flagofs[8] = { 0, 1, 2, 0xFF, 3, 4, 0xFF, 0xFF };
+	uint32_t flag[5];
+
+	flag[0] = JIT_CPU(of);
+	flag[1] = JIT_CPU(cf);
+	flag[2] = JIT_CPU(zf);
+	flag[3] = JIT_CPU(sf);
+	flag[4] = JIT_CPU(pf);
+
+	switch ((opcode >> 1) & 7) {
+	case 3: //BE: CF or ZF
+		jit_emit8(jit, 0x8A); jit_cpuop(jit, 0, JIT_CPU(cf)); //mov al, [cf]
+		jit_emit8(jit, 0x0A); jit_cpuop(jit, 0, JIT_CPU(zf)); //or al, [zf]
+		break;
+	case 6: //L: SF != OF
+		jit_emit8(jit, 0x8A); jit_cpuop(jit, 0, JIT_CPU(sf));
+		jit_emit8(jit, 0x3A); jit_cpuop(jit, 0, JIT_CPU(of)); //cmp al, [of]
+		break;
+	case 7: //LE: ZF or SF != OF
+		jit_emit8(jit, 0x8A); jit_cpuop(jit, 0, JIT_CPU(sf));
+		jit_emit8(jit, 0x32); jit_cpuop(jit, 0, JIT_CPU(of)); //xor al, [of]
+		jit_emit8(jit, 0x0A); jit_cpuop(jit, 0, JIT_CPU(zf));
+		break;
+	default:
+		jit_emit8(jit, 0x80); jit_cpuop(jit, 7, flag[flagofs[(opcode >> 1) & 7]]); jit_emit8(jit, 0x00); //cmp byte [flag], 0
+		break;
+	}
+}
+
+/*
+	Emit an instruction as native code. Returns 0 without emitting anything if it
+	isn't one that's handled here.
+*/
+uint8_t jit_native(CPU_JIT_t* jit, CPU_DECODED_t* dec, uint8_t last) {
+	uint8_t opcode = dec->opcode, mode = dec->addrbyte >> 6, reg = (dec->addrbyte >> 3) & 7, rm = dec->addrbyte & 7;
+	uint16_t next = dec->ip + dec->len, target;
+	uint8_t* taken;
+
+	switch (opcode) {
+	case 0x00: case 0x01: case 0x02: case 0x03: case 0x08: case 0x09: case 0x0A: case 0x0B:
+	case 0x20: case 0x21: case 0x22: case 0x23: case 0x28: case 0x29: case 0x2A: case 0x2B:
+	case 0x30: case 0x31: case 0x32: case 0x33: case 0x38: case 0x39: case 0x3A: case 0x3B:
+		if (mode != 3) return 0;
+		if (opcode & 1) {
+			if (opcode & 2) jit_alu(jit, opcode >> 3, 1, JIT_REG16(reg), 0, JIT_REG16(rm), 0);
+			else jit_alu(jit, opcode >> 3, 1, JIT_REG16(rm), 0, JIT_REG16(reg), 0);
+		}
+		else {
+			if (opcode & 2) jit_alu(jit, opcode >> 3, 0, JIT_REG8(reg), 0, JIT_REG8(rm), 0);
+			else jit_alu(jit, opcode >> 3, 0, JIT_REG8(rm), 0, JIT_REG8(reg), 0);
+		}
+		break;
+	case 0x04: case 0x0C: case 0x24: case 0x2C: case 0x34: case 0x3C:
+		jit_alu(jit, opcode >> 3, 0, JIT_REG8(regal), 1, 0, dec->imm);
+		break;
+	case 0x05: case 0x0D: case 0x25: case 0x2D: case 0x35: case 0x3D:
+		jit_alu(jit, opcode >> 3, 1, JIT_REG16(regax), 1, 0, dec->imm);
+		break;
+	case 0x40: case 0x41: case 0x42: case 0x43: case 0x44: case 0x45: case 0x46: case 0x47:
+	case 0x48: case 0x49: case 0x4A: case 0x4B: case 0x4C: case 0x4D: case 0x4E: case 0x4F:
+		jit_incdec(jit, opcode & 8, JIT_REG16(opcode & 7));
+		break;
+	case 0x80: case 0x82:
+		if ((mode != 3) || (reg == 2) || (reg == 3)) return 0;
+		jit_alu(jit, reg, 0, JIT_REG8(rm), 1, 0, dec->imm);
+		break;
+	case 0x81: case 0x83:
+		if ((mode != 3) || (reg == 2) || (reg == 3)) return 0;
+		jit_alu(jit, reg, 1, JIT_REG16(rm), 1, 0, (opcode == 0x81) ? dec->imm : signext(dec->imm));
+		break;
+	case 0x84: case 0x85:
+		if (mode != 3) return 0;
+		if (opcode & 1) jit_alu(jit, 8, 1, JIT_REG16(reg), 0, JIT_REG16(rm), 0);
+		else jit_alu(jit, 8, 0, JIT_REG8(reg), 0, JIT_REG8(rm), 0);
+		break;
+	case 0xA8:
+		jit_alu(jit, 8, 0, JIT_REG8(regal), 1, 0, dec->imm);
+		break;
+	case 0xA9:
+		jit_alu(jit, 8, 1, JIT_REG16(regax), 1, 0, dec->imm);
+		break;
+	case 0x88: case 0x8A: case 0xC6:
+		if (mode == 3) {
+			if (opcode == 0xC6) {
+				jit_store8(jit, JIT_REG8(rm), (uint8_t)dec->imm);
+			}
+			else {
+				jit_load8(jit, 0, JIT_REG8((opcode == 0x88) ? reg : rm));
+				jit_save8(jit, 0, JIT_REG8((opcode == 0x88) ? rm : reg));
+			}
+			break;
+		}
+		if (dec->reptype) return 0;
+		jit_ea(jit, dec);
+		if (opcode == 0x8A) {
+			jit_read8(jit, 0, JIT_REG8(reg));
+			break;
+		}
+		jit_write8(jit, 0, opcode == 0xC6, JIT_REG8(reg), (uint8_t)dec->imm);
+		jit_pend(jit, dec);
+		jit_checkCode(jit, 1, next);
+		jit_unpend(jit, dec);
+		break;
+	case 0x89: case 0x8B: case 0xC7:
+		if (mode == 3) {
+			if (opcode == 0xC7) {
+				jit_store16(jit, JIT_REG16(rm), dec->imm);
+			}
+			else {
+				jit_load16(jit, 0, JIT_REG16((opcode == 0x89) ? reg : rm));
+				jit_save16(jit, 0, JIT_REG16((opcode == 0x89) ? rm : reg));
+			}
+			break;
+		}
+		if (dec->reptype) return 0;
+		jit_ea(jit, dec);
+		if (opcode == 0x8B) {
+			jit_read8(jit, 0, JIT_REG16(reg));
+			jit_read8(jit, 1, JIT_REG16(reg) + 1);
+			break;
+		}
+		jit_write8(jit, 0, opcode == 0xC7, JIT_REG16(reg), (uint8_t)dec->imm);
+		jit_write8(jit, 1, opcode == 0xC7, JIT_REG16(reg) + 1, (uint8_t)(dec->imm >> 8));
+		jit_pend(jit, dec);
+		jit_checkCode(jit, 1, next);
+		jit_unpend(jit, dec);
+		break;
+	case 0xA0: case 0xA1: case 0xA2: case 0xA3:
+		if (dec->reptype) return 0;
+		jit_emit8(jit, 0xBD); jit_emit32(jit, dec->imm); //mov ebp, offset
+		jit_load16(jit, 0, JIT_SEG(dec->useseg));
+		jit_emit8(jit, 0xC1); jit_emit8(jit, 0xE0); jit_emit8(jit, 0x04); //shl eax, 4
+		jit_emit8(jit, 0x01); jit_emit8(jit, 0xC5); //add ebp, eax
+		switch (opcode) {
+		case 0xA0:
+			jit_read8(jit, 0, JIT_REG8(regal));
+			break;
+		case 0xA1:
+			jit_read8(jit, 0, JIT_REG16(regax));
+			jit_read8(jit, 1, JIT_REG16(regax) + 1);
+			break;
+		case 0xA2:
+			jit_write8(jit, 0, 0, JIT_REG8(regal), 0);
+			break;
+		case 0xA3:
+			jit_write8(jit, 0, 0, JIT_REG16(regax), 0);
+			jit_write8(jit, 1, 0, JIT_REG16(regax) + 1, 0);
+			break;
+		}
+		if (opcode & 2) {
+			jit_pend(jit, dec);
+			jit_checkCode(jit, 1, next);
+			jit_unpend(jit, dec);
+		}
+		break;
+	case 0x90:
+		break;
+	case 0x91: case 0x92: case 0x93: case 0x94: case 0x95: case 0x96: case 0x97:
+		jit_load16(jit, 0, JIT_REG16(regax));
+		jit_load16(jit, 1, JIT_REG16(opcode & 7));
+		jit_save16(jit, 1, JIT_REG16(regax));
+		jit_save16(jit, 0, JIT_REG16(opcode & 7));
+		break;
+	case 0xB0: case 0xB1: case 0xB2: case 0xB3: case 0xB4: case 0xB5: case 0xB6: case 0xB7:
+		jit_store8(jit, JIT_REG8(opcode & 7), (uint8_t)dec->imm);
+		break;
+	case 0xB8: case 0xB9: case 0xBA: case 0xBB: case 0xBC: case 0xBD: case 0xBE: case 0xBF:
+		jit_store16(jit, JIT_REG16(opcode & 7), dec->imm);
+		break;
+	case 0xF5:
+		jit_flags(jit);
+		jit_emit8(jit, 0x80); jit_cpuop(jit, 6, JIT_CPU(cf)); jit_emit8(jit, 0x01); //xor byte [cf], 1
+		break;
+	case 0xF8: case 0xF9:
+		jit_flags(jit);
+		jit_store8(jit, JIT_CPU(cf), opcode & 1);
+		break;
+	case 0xFA: //STI goes through its handler so a waiting interrupt gets taken after it
+		jit_store8(jit, JIT_CPU(ifl), 0);
+		break;
+	case 0xFC: case 0xFD:
+		jit_store8(jit, JIT_CPU(df), opcode & 1);
+		break;
+
+	case 0x70: case 0x71: case 0x72: case 0x73: case 0x74: case 0x75: case 0x76: case 0x77:
+	case 0x78: case 0x79: case 0x7A: case 0x7B: case 0x7C: case 0x7D: case 0x7E: case 0x7F:
+	case 0xE2:
+		if (!last) return 0;
+		jit_pend(jit, dec);
+		jit_sync(jit);
+		if (opcode == 0xE2) {
+			jit_emit8(jit, 0x66); jit_emit8(jit, 0x83); jit_cpuop(jit, 5, JIT_REG16(regcx)); jit_emit8(jit, 0x01); //sub word [cx], 1
+			taken = jit_jcc(jit, JIT_CC_NE);
+		}
+		else {
+			jit_flags(jit);
+			jit_condition(jit, opcode);
+			taken = jit_jcc(jit, (opcode & 1) ? JIT_CC_E : JIT_CC_NE);
+		}
+		jit_branch(jit, next);
+		jit_patch(jit, taken);
+		jit_emit8(jit, 0x83); jit_cpuop(jit, 0, JIT_CPU(cycles)); jit_emit8(jit, CPU_CYCLES_TAKEN); //add dword [cycles], taken
+		jit_branch(jit, next + signext(dec->imm));
+		jit->ended = 1;
+		return 1;
+	case 0xE9: case 0xEB:
+		if (!last) return 0;
+		jit_pend(jit, dec);
+		jit_sync(jit);
+		target = next + ((opcode == 0xE9) ? dec->imm : signext(dec->imm));
+		jit_branch(jit, target);
+		jit->ended = 1;
+		return 1;
+
+	default:
+		return 0;
+	}
+
+	jit_pend(jit, dec);
+	return 1;
+}
+
+//store the decoded fields the way cpu_loaddecoded would and call the interpreter's handler
+void jit_handler(CPU_JIT_t* jit, CPU_DECODED_t* dec, uint32_t rest, uint8_t last) {
+	uint8_t flags = cpu_decodeflags[dec->opcode];
+	uint16_t next = dec->ip + dec->len;
+	uint8_t *start, *skip;
+	uint8_t string;
+
+	string = ((dec->opcode >= 0x6C) && (dec->opcode <= 0x6F)) || ((dec->opcode >= 0xA4) && (dec->opcode <= 0xA7)) || ((dec->opcode >= 0xAA) && (dec->opcode <= 0xAF));
+
+	jit_sync(jit);
+	start = jit->p;
+	jit_store16(jit, JIT_CPU(firstip), dec->ip);
+	jit_store8(jit, JIT_CPU(opcode), dec->opcode);
+	jit_store8(jit, JIT_CPU(segoverride), dec->segoverride);
+	jit_store8(jit, JIT_CPU(reptype), dec->reptype);
+	jit_load16(jit, 0, JIT_SEG(dec->useseg));
+	jit_save16(jit, 0, JIT_CPU(useseg));
+	if ((dec->opcode == 0x8C) || (dec->opcode == 0x8E)) { //segment register 4 and up overlaps savecs, saveip...
+		jit_load16(jit, 0, JIT_SEG(regcs));
+		jit_save16(jit, 0, JIT_CPU(savecs));
+		jit_store16(jit, JIT_CPU(saveip), dec->ip + dec->prefixlen);
+	}
+	if (flags & CPU_DEC_MODRM) {
+		jit_store8(jit, JIT_CPU(addrbyte), dec->addrbyte);
+		jit_store8(jit, JIT_CPU(mode), dec->addrbyte >> 6);
+		jit_store8(jit, JIT_CPU(reg), (dec->addrbyte >> 3) & 7);
+		jit_store8(jit, JIT_CPU(rm), dec->addrbyte & 7);
+		jit_store16(jit, JIT_CPU(disp16), dec->disp16);
+	}
+	if (flags & (CPU_DEC_IMM8 | CPU_DEC_IMM16 | CPU_DEC_GRP3)) {
+		jit_store16(jit, JIT_CPU(imm), dec->imm);
+	}
+	if (flags & (CPU_DEC_IMM2_8 | CPU_DEC_IMM2_16)) {
+		jit_store16(jit, JIT_CPU(imm2), dec->imm2);
+	}
+	if (string && dec->reptype) {
+		jit_store16(jit, JIT_CPU(repcycles), dec->cycles);
+	}
+	jit_store16(jit, JIT_CPU(ip), next);
+	jit_count(jit, 1, dec->cycles); //before the call like cpu_loaddecoded, a bulk REP works out how far it can go from it
+	jit_call(jit, (void*)cpu_handlers[dec->opcode]);
+	jit->flagsync = 0;
+
+	//trap flag, HLT, an interrupt to take, or the handler wrote over this block's code or changed CS
+	jit_load8(jit, 0, JIT_CPU(intr));
+	jit_emit8(jit, 0x22); jit_cpuop(jit, 0, JIT_CPU(ifl)); //and al, [ifl]
+	jit_emit8(jit, 0x66); jit_emit8(jit, 0x0B); jit_cpuop(jit, 0, JIT_CPU(trap_toggle)); //or ax, [trap_toggle]
+	jit_emit8(jit, 0x0A); jit_cpuop(jit, 0, JIT_CPU(tf)); //or al, [tf]
+	jit_emit8(jit, 0x0A); jit_cpuop(jit, 0, JIT_CPU(hltstate)); //or al, [hltstate]
+	jit_emit8(jit, 0x85); jit_emit8(jit, 0xC0); //test eax, eax
+	jit_exitIf(jit, JIT_CC_NE, 0, 0);
+	jit_checkCode(jit, 0, 0);
+	jit_cmp16(jit, JIT_SEG(regcs), jit->block->cs);
+	jit_exitIf(jit, JIT_CC_NE, 0, 0);
+
+	//string instructions with REP go back to themselves until done
+	if (string && dec->reptype) {
+		jit_cmp16(jit, JIT_CPU(ip), dec->ip);
+		skip = jit_jcc(jit, JIT_CC_NE);
+		jit_loop(jit, rest, start);
+		jit_patch(jit, skip);
+	}
+
+	//REP iterations and shifts by more than one add cycles of their own, the rest of the block might not fit anymore
+	if (!last && (string || (dec->opcode == 0xC0) || (dec->opcode == 0xC1) || (dec->opcode == 0xD2) || (dec->opcode == 0xD3))) {
+		jit_budget(jit, rest - dec->cycles);
+	}
+
+	if (last) {
+		jit_cmp16(jit, JIT_CPU(ip), jit->block->ip);
+		jit_exitIf(jit, JIT_CC_NE, 0, 0);
+		jit_loop(jit, jit->block->cycles, jit->top);
+		jit->ended = 1;
+	}
+	else {
+		jit_cmp16(jit, JIT_CPU(ip), next);
+		jit_exitIf(jit, JIT_CC_NE, 0, 0);
+	}
+}
+
+void cpu_jitFlush(CPU_t* cpu) {
+	if (cpu->jitbuf == NULL) {
+#ifdef _WIN32
+		cpu->jitbuf = (uint8_t*)VirtualAlloc(NULL, CPU_JIT_BUFSIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+		cpu->jitbuf = (uint8_t*)mmap(NULL, CPU_JIT_BUFSIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (cpu->jitbuf == (uint8_t*)MAP_FAILED) {
+			cpu->jitbuf = NULL;
+		}
+#endif
+		if (cpu->jitbuf == NULL) {
+			debug_log(DEBUG_ERROR, "[CPU] Unable to allocate JIT code buffer, running without it\r\n");
+		}
+	}
+	cpu->jitpos = 0;
+}
+
+void cpu_jitCompile(CPU_t* cpu, CPU_BLOCK_t* block) {
+	CPU_JIT_t jit;
+	CPU_DECODED_t* dec;
+	uint8_t* entry;
+	uint32_t i, rest;
+	uint8_t n;
+
+	if (cpu->jitbuf == NULL) {
+		return;
+	}
+
+	if ((cpu->jitpos + CPU_JIT_BLOCKSIZE) > CPU_JIT_BUFSIZE) {
+		for (i = 0; i < CPU_BLOCK_COUNT; i++) {
+			cpu->blocks[i].code = NULL;
+			cpu->blocks[i].hits = 0;
+		}
+		cpu->jitpos = 0;
+	}
+
+	jit.cpu = cpu;
+	jit.block = block;
+	jit.p = cpu->jitbuf + cpu->jitpos;
+	jit.pending = 0;
+	jit.pendcycles = 0;
+	jit.ended = 0;
+	jit.flagsync = 0;
+
+	jit.exit = jit.p;
+#ifdef _WIN32
+	jit_emit8(&jit, 0x48); jit_emit8(&jit, 0x83); jit_emit8(&jit, 0xC4); jit_emit8(&jit, 0x20); //add rsp, 32
+#endif
+	jit_emit8(&jit, 0x41); jit_emit8(&jit, 0x5C); //pop r12
+	jit_emit8(&jit, 0x5D); //pop rbp
+	jit_emit8(&jit, 0x5B); //pop rbx
+	jit_emit8(&jit, 0xC3); //ret
+
+	entry = jit.p;
+	jit_emit8(&jit, 0x53); //push rbx
+	jit_emit8(&jit, 0x55); //push rbp
+	jit_emit8(&jit, 0x41); jit_emit8(&jit, 0x54); //push r12
+#ifdef _WIN32
+	jit_emit8(&jit, 0x48); jit_emit8(&jit, 0x83); jit_emit8(&jit, 0xEC); jit_emit8(&jit, 0x20); //sub rsp, 32
+	jit_emit8(&jit, 0x48); jit_emit8(&jit, 0x89); jit_emit8(&jit, 0xCB); //mov rbx, rcx
+	jit_emit8(&jit, 0x41); jit_emit8(&jit, 0x89); jit_emit8(&jit, 0xD4); //mov r12d, edx
+#else
+	jit_emit8(&jit, 0x48); jit_emit8(&jit, 0x89); jit_emit8(&jit, 0xFB); //mov rbx, rdi
+	jit_emit8(&jit, 0x41); jit_emit8(&jit, 0x89); jit_emit8(&jit, 0xF4); //mov r12d, esi
+#endif
+	jit.top = jit.p;
+
+	rest = block->cycles;
+	for (n = 0; n < block->count; n++) {
+		dec = &block->ins[n];
+		if (!jit_native(&jit, dec, (n + 1) == block->count)) {
+			jit_handler(&jit, dec, rest, (n + 1) == block->count);
+		}
+		rest -= dec->cycles;
+	}
+
+	if (!jit.ended) {
+		dec = &block->ins[block->count - 1];
+		jit_sync(&jit);
+		jit_store16(&jit, JIT_CPU(ip), dec->ip + dec->len);
+		jit_link(jit_jmp(&jit), jit.exit);
+	}
+
+	cpu->jitpos = ((uint32_t)(jit.p - cpu->jitbuf) + 15) & ~15;
+	block->code = (void (*)(void*, uint32_t))entry;
+}
+
+#endif
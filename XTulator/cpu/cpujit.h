@@ -0,0 +1,47 @@
+/*
+  XTulator: A portable, open-source 80186 PC emulator.
+  Copyright (C)2020 Mike Chambers
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef _CPUJIT_H_
+#define _CPUJIT_H_
+
+#include <stdint.h>
+#include "cpu.h"
+
+#define CPU_JIT_BUFSIZE		(8 * 1024 * 1024)	//Size of the native code buffer
+#define CPU_JIT_BLOCKSIZE	(CPU_BLOCK_MAX * 640 + 128)	//Worst case native code size of one block
+
+typedef struct {
+	CPU_t* cpu;
+	CPU_BLOCK_t* block;
+	uint8_t* p; //next byte to emit
+	uint8_t* exit; //common exit that returns to cpu_exec_jit
+	uint8_t* top; //first instruction of the block, target when the block loops on itself
+	uint8_t pending; //instructions run natively that haven't been added to totalexec yet
+	uint32_t pendcycles; //and the cycles they took
+	uint8_t ended; //the block's last instruction has already emitted its own exit
+	uint8_t flagsync; //the flag fields are known to hold the guest flags, with nothing left lazy in flagop
+} CPU_JIT_t;
+
+extern const uint8_t byteregtable[8];
+extern void (* const cpu_handlers[256])(CPU_t* cpu);
+
+void cpu_jitFlush(CPU_t* cpu);
+void cpu_jitCompile(CPU_t* cpu, CPU_BLOCK_t* block);
+
+#endif
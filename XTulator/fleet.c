@@ -0,0 +1,224 @@
+/*
+  XTulator: A portable, open-source 80186 PC emulator.
+  Copyright (C)2020 Mike Chambers
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+	Fleet mode: boot one template machine until the guest writes to the fleet port,
+	then fork() worker processes from it. The workers share guest RAM and ROM with
+	the template copy-on-write, send disk writes to their own overlay files and get
+	their job typed into the BIOS keyboard buffer. A worker ends when the guest
+	writes to the fleet port again, and the value written is its exit code.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+#include "config.h"
+#include "machine.h"
+#include "ports.h"
+#include "cpu/cpu.h"
+#include "modules/disk/biosdisk.h"
+#include "debuglog.h"
+#include "fleet.h"
+
+uint32_t fleet_workers = 0; //0 means fleet mode is off
+uint16_t fleet_port = 0xE9;
+char* fleet_jobfile = NULL;
+
+int fleet_worker = -1; //index of this worker process, -1 in the template
+int fleet_exitcode = 0;
+
+volatile uint8_t fleet_doFork = 0;
+char fleet_job[FLEET_JOB_LEN + 1];
+uint16_t fleet_jobpos = 0, fleet_joblen = 0;
+
+//US layout scan codes for the printable characters, in the order they sit on each key row
+const char* fleet_keyrows[4][2] = {
+	{ "1234567890-=", "!@#$%^&*()_+" },
+	{ "qwertyuiop[]", "QWERTYUIOP{}" },
+	{ "asdfghjkl;'`", "ASDFGHJKL:\"~" },
+	{ "\\zxcvbnm,./", "|ZXCVBNM<>?" }
+};
+const uint8_t fleet_keyrowbase[4] = { 0x02, 0x10, 0x1E, 0x2B };
+
+uint8_t fleet_scancode(char c) {
+	int row, shift;
+	char* pos;
+
+	switch (c) {
+	case ' ': return 0x39;
+	case '\r': return 0x1C;
+	case '\t': return 0x0F;
+	case '\b': return 0x0E;
+	case 0x1B: return 0x01;
+	}
+	for (row = 0; row < 4; row++) {
+		for (shift = 0; shift < 2; shift++) {
+			pos = strchr(fleet_keyrows[row][shift], c);
+			if ((pos != NULL) && (c != 0)) {
+				return fleet_keyrowbase[row] + (uint8_t)(pos - fleet_keyrows[row][shift]);
+			}
+		}
+	}
+	return 0x00;
+}
+
+void fleet_portWrite(void* dummy, uint16_t port, uint8_t value) {
+	if (fleet_worker < 0) {
+		fleet_doFork = 1; //forked from the main loop once the current CPU slice ends
+	}
+	else {
+		fleet_exitcode = value;
+		running = 0;
+	}
+}
+
+/* move as much of the job as fits into the BIOS keyboard buffer, the rest goes in as the guest reads keys */
+void fleet_feedKeys(CPU_t* cpu) {
+	uint16_t head, tail, start, end, next;
+	uint8_t c;
+
+	head = cpu_readw(cpu, 0x41A);
+	tail = cpu_readw(cpu, 0x41C);
+	start = cpu_readw(cpu, 0x480);
+	end = cpu_readw(cpu, 0x482);
+	if ((start == 0) || (end <= start)) { //BIOS didn't set up the buffer bounds, use the standard ones
+		start = 0x1E;
+		end = 0x3E;
+	}
+
+	while (fleet_jobpos < fleet_joblen) {
+		next = tail + 2;
+		if (next >= end) next = start;
+		if (next == head) break; //buffer full
+		c = (uint8_t)fleet_job[fleet_jobpos++];
+		cpu_writew(cpu, 0x400 + tail, ((uint16_t)fleet_scancode(c) << 8) | c);
+		tail = next;
+	}
+	cpu_writew(cpu, 0x41C, tail);
+}
+
+/* line <worker> of the job file, with its line ending turned into an Enter keystroke */
+void fleet_loadJob(int worker) {
+	FILE* file;
+	int line = 0;
+
+	fleet_joblen = 0;
+	if (fleet_jobfile == NULL) return;
+	file = fopen(fleet_jobfile, "r");
+	if (file == NULL) {
+		debug_log(DEBUG_ERROR, "[FLEET] Unable to open job file %s\r\n", fleet_jobfile);
+		return;
+	}
+	while (fgets(fleet_job, FLEET_JOB_LEN, file) != NULL) {
+		if (line++ == worker) {
+			fleet_joblen = (uint16_t)strcspn(fleet_job, "\r\n");
+			fleet_job[fleet_joblen++] = '\r';
+			break;
+		}
+	}
+	fclose(file);
+	fleet_jobpos = 0;
+}
+
+void fleet_startWorker(MACHINE_t* machine, int worker) {
+	char name[1024];
+	uint8_t i;
+
+	fleet_worker = worker;
+	for (i = 0; i < 4; i++) {
+		if (!machine->biosdisk.disk[i].inserted) continue;
+		snprintf(name, sizeof(name), "%s.fleet%d", machine->biosdisk.disk[i].filename, worker);
+		if (biosdisk_overlay(&machine->biosdisk, i, name)) {
+			exit(-1);
+		}
+	}
+	fleet_loadJob(worker);
+}
+
+/* called in the template once the guest has asked for the snapshot. returns in the workers only */
+void fleet_fork(MACHINE_t* machine) {
+#ifdef _WIN32
+	debug_log(DEBUG_ERROR, "[FLEET] Fleet mode needs fork() and isn't available in this build\r\n");
+	fleet_exitcode = -1;
+	running = 0;
+#else
+	pid_t* pids, pid;
+	uint32_t i, count, failed = 0;
+	int status;
+
+	pids = (pid_t*)malloc(sizeof(pid_t) * fleet_workers);
+	if (pids == NULL) {
+		fleet_exitcode = -1;
+		running = 0;
+		return;
+	}
+
+	debug_log(DEBUG_INFO, "[FLEET] Snapshot reached, starting %lu workers\r\n", fleet_workers);
+	fflush(NULL); //don't let every worker inherit the same pending output
+	for (count = 0; count < fleet_workers; count++) {
+		pid = fork();
+		if (pid == 0) {
+			free(pids);
+			fleet_startWorker(machine, (int)count);
+			return;
+		}
+		if (pid < 0) {
+			debug_log(DEBUG_ERROR, "[FLEET] Unable to fork worker %lu\r\n", count);
+			break;
+		}
+		pids[count] = pid;
+	}
+
+	//the template now only waits for its workers
+	while ((pid = wait(&status)) > 0) {
+		for (i = 0; i < count; i++) {
+			if (pids[i] == pid) break;
+		}
+		if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+			failed++;
+		}
+		debug_log(DEBUG_INFO, "[FLEET] Worker %lu exited with code %d\r\n", i, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+	}
+	free(pids);
+
+	fleet_exitcode = (failed || (count < fleet_workers)) ? 1 : 0;
+	running = 0;
+#endif
+}
+
+void fleet_service(MACHINE_t* machine) {
+	if (fleet_doFork) {
+		fleet_doFork = 0;
+		fleet_fork(machine);
+	}
+	if (fleet_jobpos < fleet_joblen) {
+		fleet_feedKeys(&machine->CPU);
+	}
+}
+
+void fleet_init(MACHINE_t* machine) {
+	debug_log(DEBUG_INFO, "[FLEET] Booting template machine, %lu workers will fork on a write to port 0x%03X\r\n", fleet_workers, fleet_port);
+	ports_cbRegister(&machine->ports, fleet_port, 1, NULL, NULL, (void*)fleet_portWrite, NULL, NULL);
+}
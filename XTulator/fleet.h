@@ -0,0 +1,18 @@
+#ifndef _FLEET_H_
+#define _FLEET_H_
+
+#include <stdint.h>
+#include "machine.h"
+
+#define FLEET_JOB_LEN	1024	//Longest job line, in keystrokes
+
+extern uint32_t fleet_workers;
+extern uint16_t fleet_port;
+extern char* fleet_jobfile;
+extern int fleet_worker;
+extern int fleet_exitcode;
+
+void fleet_init(MACHINE_t* machine);
+void fleet_service(MACHINE_t* machine);
+
+#endif
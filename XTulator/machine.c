@@ -143,63 +143,63 @@ uint8_t mac[6] = { 0xac, 0xde, 0x48, 0x88, 0xbb, 0xab };
 int machine_init_generic_xt(MACHINE_t* machine) {
 	if (machine == NULL) return -1;
 
-	i8259_init(&machine->i8259);
-	i8253_init(&machine->i8253, &machine->i8259, &machine->pcspeaker);
-	i8237_init(&machine->i8237, &machine->CPU);
-	i8255_init(&machine->i8255, &machine->KeyState, &machine->pcspeaker);
-	pcspeaker_init(&machine->pcspeaker);
+	i8259_init(&machine->i8259, &machine->ports);
+	i8253_init(&machine->i8253, &machine->i8259, &machine->pcspeaker, &machine->ports, &machine->timing);
+	i8237_init(&machine->i8237, &machine->CPU, &machine->ports);
+	i8255_init(&machine->i8255, &machine->KeyState, &machine->pcspeaker, &machine->ports, &machine->timing);
+	pcspeaker_init(&machine->pcspeaker, &machine->timing);
 
 	//check machine HW flags and init devices accordingly
 	if ((machine->hwflags & MACHINE_HW_BLASTER) && !(machine->hwflags & MACHINE_HW_SKIP_BLASTER)) {
-		blaster_init(&machine->blaster, &machine->i8237, &machine->i8259, 0x220, 1, 5);
-		OPL3_init(&machine->OPL3);
+		blaster_init(&machine->blaster, &machine->i8237, &machine->i8259, &machine->ports, &machine->timing, 0x220, 1, 5);
+		OPL3_init(&machine->OPL3, &machine->ports);
 		machine->mixBlaster = 1;
 		machine->mixOPL = 1;
 	}
 	else if ((machine->hwflags & MACHINE_HW_OPL) && !(machine->hwflags & MACHINE_HW_SKIP_OPL)) { //else if because some games won't detect an SB without seeing the OPL, so if SB enabled then OPL already is
-		//opl2_init(&machine->OPL2);
-		OPL3_init(&machine->OPL3);
+		//opl2_init(&machine->OPL2, &machine->ports, &machine->timing);
+		OPL3_init(&machine->OPL3, &machine->ports);
 		machine->mixOPL = 1;
 	}
 	if ((machine->hwflags & MACHINE_HW_RTC) && !(machine->hwflags & MACHINE_HW_SKIP_RTC)) {
-		rtc_init(&machine->CPU);
+		rtc_init(&machine->ports);
 	}
 
 	if ((machine->hwflags & MACHINE_HW_UART0_NONE) && !(machine->hwflags & MACHINE_HW_SKIP_UART0)) {
-		uart_init(&machine->UART[0], &machine->i8259, 0x3F8, 4, NULL, NULL, NULL, NULL);
+		uart_init(&machine->UART[0], &machine->i8259, &machine->ports, 0x3F8, 4, NULL, NULL, NULL, NULL);
 	}
 	else if ((machine->hwflags & MACHINE_HW_UART0_MOUSE) && !(machine->hwflags & MACHINE_HW_SKIP_UART0)) {
-		uart_init(&machine->UART[0], &machine->i8259, 0x3F8, 4, NULL, NULL, (void*)mouse_togglereset, NULL);
-		mouse_init(&machine->UART[0]);
-		timing_addTimer(mouse_rxpoll, NULL, baudrate / 9, TIMING_ENABLED);
+		uart_init(&machine->UART[0], &machine->i8259, &machine->ports, 0x3F8, 4, NULL, NULL, (void*)mouse_togglereset, &machine->mouse);
+		mouse_init(&machine->mouse, &machine->UART[0]);
+		timing_addTimer(&machine->timing, mouse_rxpoll, &machine->mouse, baudrate / 9, TIMING_ENABLED);
 	}
 #ifdef ENABLE_TCP_MODEM
 	else if ((machine->hwflags & MACHINE_HW_UART0_TCPMODEM) && !(machine->hwflags & MACHINE_HW_SKIP_UART0)) {
-		uart_init(&machine->UART[0], &machine->i8259, 0x3F8, 4, (void*)tcpmodem_tx, &machine->tcpmodem[0], NULL, NULL);
-		tcpmodem_init(&machine->tcpmodem[0], &machine->UART[0], 23);
-		timing_addTimer(tcpmodem_rxpoll, &machine->tcpmodem[0], baudrate / 9, TIMING_ENABLED);
+		uart_init(&machine->UART[0], &machine->i8259, &machine->ports, 0x3F8, 4, (void*)tcpmodem_tx, &machine->tcpmodem[0], NULL, NULL);
+		tcpmodem_init(&machine->tcpmodem[0], &machine->UART[0], &machine->timing, 23);
+		timing_addTimer(&machine->timing, tcpmodem_rxpoll, &machine->tcpmodem[0], baudrate / 9, TIMING_ENABLED);
 	}
 #endif
 
 	if ((machine->hwflags & MACHINE_HW_UART1_NONE) && !(machine->hwflags & MACHINE_HW_SKIP_UART1)) {
-		uart_init(&machine->UART[1], &machine->i8259, 0x2F8, 3, NULL, NULL, NULL, NULL);
+		uart_init(&machine->UART[1], &machine->i8259, &machine->ports, 0x2F8, 3, NULL, NULL, NULL, NULL);
 	}
 	else if ((machine->hwflags & MACHINE_HW_UART1_MOUSE) && !(machine->hwflags & MACHINE_HW_SKIP_UART1)) {
-		uart_init(&machine->UART[1], &machine->i8259, 0x2F8, 3, NULL, NULL, (void*)mouse_togglereset, NULL);
-		mouse_init(&machine->UART[1]);
-		timing_addTimer(mouse_rxpoll, NULL, baudrate / 9, TIMING_ENABLED);
+		uart_init(&machine->UART[1], &machine->i8259, &machine->ports, 0x2F8, 3, NULL, NULL, (void*)mouse_togglereset, &machine->mouse);
+		mouse_init(&machine->mouse, &machine->UART[1]);
+		timing_addTimer(&machine->timing, mouse_rxpoll, &machine->mouse, baudrate / 9, TIMING_ENABLED);
 	}
 #ifdef ENABLE_TCP_MODEM
 	else if ((machine->hwflags & MACHINE_HW_UART1_TCPMODEM) && !(machine->hwflags & MACHINE_HW_SKIP_UART1)) {
-		uart_init(&machine->UART[1], &machine->i8259, 0x2F8, 3, (void*)tcpmodem_tx, &machine->tcpmodem[1], NULL, NULL);
-		tcpmodem_init(&machine->tcpmodem[1], &machine->UART[1], 23);
-		timing_addTimer(tcpmodem_rxpoll, &machine->tcpmodem[1], baudrate / 9, TIMING_ENABLED);
+		uart_init(&machine->UART[1], &machine->i8259, &machine->ports, 0x2F8, 3, (void*)tcpmodem_tx, &machine->tcpmodem[1], NULL, NULL);
+		tcpmodem_init(&machine->tcpmodem[1], &machine->UART[1], &machine->timing, 23);
+		timing_addTimer(&machine->timing, tcpmodem_rxpoll, &machine->tcpmodem[1], baudrate / 9, TIMING_ENABLED);
 	}
 #endif
 
 #ifdef USE_NE2000
 	if (machine->hwflags & MACHINE_HW_NE2000) {
-		ne2000_init(&machine->ne2000, &machine->i8259, 0x300, 2, (uint8_t*)&mac);
+		ne2000_init(&machine->ne2000, &machine->i8259, &machine->ports, &machine->timing, 0x300, 2, (uint8_t*)&mac);
 		if (machine->pcap_if > -1) {
 			if (pcap_init(&machine->ne2000, machine->pcap_if)) {
 				return -1;
@@ -209,19 +209,20 @@ int machine_init_generic_xt(MACHINE_t* machine) {
 #endif
 
 	cpu_reset(&machine->CPU);
+	cpu_connectPIC(&machine->CPU, &machine->i8259);
 #ifndef USE_DISK_HLE
-	fdc_init(&fdc, &machine->CPU, &i8259, &i8237);
-	fdc_insert(&fdc, 0, "dos622.img");
+	fdc_init(&machine->fdc, &machine->CPU, &machine->i8259, &machine->i8237, &machine->ports, &machine->timing);
+	fdc_insert(&machine->fdc, 0, "dos622.img");
 #else
-	biosdisk_init(&machine->CPU);
+	biosdisk_init(&machine->biosdisk, &machine->CPU);
 #endif
 
 	switch (videocard) {
 	case VIDEO_CARD_CGA:
-		if (cga_init()) return -1;
+		if (cga_init(&machine->cga, &machine->ports, &machine->memory, &machine->timing)) return -1;
 		break;
 	case VIDEO_CARD_VGA:
-		if (vga_init()) return -1;
+		if (vga_init(&machine->vga, &machine->ports, &machine->memory, &machine->timing)) return -1;
 		break;
 	}
 
@@ -260,7 +261,7 @@ int machine_init(MACHINE_t* machine, char* id) {
 			return -1;
 		}
 		if (machine_mem[num][i].memtype == MACHINE_MEM_RAM) {
-			memory_mapRegister(machine_mem[num][i].start, machine_mem[num][i].size, temp, temp);
+			memory_mapRegister(&machine->memory, machine_mem[num][i].start, machine_mem[num][i].size, temp, temp);
 		} else if (machine_mem[num][i].memtype == MACHINE_MEM_ROM) {
 			int ret;
 			ret = utility_loadFile(temp, machine_mem[num][i].size, machine_mem[num][i].filename);
@@ -268,7 +269,7 @@ int machine_init(MACHINE_t* machine, char* id) {
 				debug_log(DEBUG_ERROR, "[MACHINE] Could not open file, or size is less than expected: %s\r\n", machine_mem[num][i].filename);
 				return -1;
 			}
-			memory_mapRegister(machine_mem[num][i].start, machine_mem[num][i].size, temp, NULL);
+			memory_mapRegister(&machine->memory, machine_mem[num][i].start, machine_mem[num][i].size, temp, NULL);
 		}
 		i++;
 	}
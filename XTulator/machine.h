@@ -4,6 +4,9 @@
 #include "config.h"
 #include <stdint.h>
 #include "cpu/cpu.h"
+#include "memory.h"
+#include "ports.h"
+#include "timing.h"
 #include "chipset/i8259.h"
 #include "chipset/i8253.h"
 #include "chipset/i8237.h"
@@ -16,7 +19,11 @@
 #include "modules/audio/blaster.h"
 #include "modules/audio/pcspeaker.h"
 #include "modules/disk/fdc.h"
+#include "modules/disk/biosdisk.h"
 #include "modules/input/input.h"
+#include "modules/input/mouse.h"
+#include "modules/video/cga.h"
+#include "modules/video/vga.h"
 
 #define MACHINE_MEM_RAM			0
 #define MACHINE_MEM_ROM			1
@@ -48,6 +55,9 @@
 
 typedef struct {
 	CPU_t CPU;
+	MEMORY_t memory;
+	PORTS_t ports;
+	TIMING_t timing;
 	I8259_t i8259;
 	I8253_t i8253;
 	I8237_t i8237;
@@ -66,7 +76,11 @@ typedef struct {
 	NE2000_t ne2000;
 #endif
 	KEYSTATE_t KeyState;
+	MOUSE_t mouse;
 	FDC_t fdc;
+	BIOSDISK_t biosdisk;
+	VGA_t vga;
+	CGA_t cga;
 	uint64_t hwflags;
 	int pcap_if;
 } MACHINE_t;
@@ -29,6 +29,7 @@
 #include "menus.h"
 #include "utility.h"
 #include "debuglog.h"
+#include "fleet.h"
 #include "cpu/cpu.h"
 #include "chipset/i8259.h"
 #include "modules/disk/biosdisk.h"
@@ -42,8 +43,8 @@ char* usemachine = "generic_xt"; //default
 
 char title[64]; //assuming 64 isn't safe if somebody starts messing with STR_TITLE and STR_VERSION
 
-uint64_t ops = 0;
-uint32_t baudrate = 115200, ramsize = 640, instructionsperloop = 100, cpuLimitTimer;
+uint64_t ops = 0, cycles = 0;
+uint32_t baudrate = 115200, ramsize = 640, cyclesperloop = 1000, cpuLimitTimer;
 uint8_t videocard = 0xFF, showMIPS = 0;
 volatile uint8_t goCPU = 1, limitCPU = 0;
 volatile double speed = 0;
@@ -53,11 +54,13 @@ volatile uint8_t running = 1;
 MACHINE_t machine;
 
 void optimer(void* dummy) {
-	ops /= 10000;
+	ops = (machine.CPU.totalexec - ops) / 10000;
+	cycles /= 10000;
 	if (showMIPS) {
-		debug_log(DEBUG_INFO, "%llu.%llu MIPS          \r", ops / 10, ops % 10);
+		debug_log(DEBUG_INFO, "%llu.%llu MIPS, %llu.%llu MHz          \r", ops / 10, ops % 10, cycles / 10, cycles % 10);
 	}
-	ops = 0;
+	ops = machine.CPU.totalexec;
+	cycles = 0;
 }
 
 void cputimer(void* dummy) {
@@ -67,16 +70,16 @@ void cputimer(void* dummy) {
 void setspeed(double mhz) {
 	if (mhz > 0) {
 		speed = mhz;
-		instructionsperloop = (uint32_t)((speed * 1000000.0) / 140000.0);
+		cyclesperloop = (uint32_t)((speed * 1000000.0) / 10000.0); //cputimer runs at 10 KHz
 		limitCPU = 1;
-		debug_log(DEBUG_INFO, "[MACHINE] Throttling speed to approximately a %.02f MHz 8088 (%lu instructions/sec)\r\n", speed, instructionsperloop * 10000);
-		timing_timerEnable(cpuLimitTimer);
+		debug_log(DEBUG_INFO, "[MACHINE] Throttling speed to %.02f MHz (%lu clock cycles every 100 us)\r\n", speed, cyclesperloop);
+		timing_timerEnable(&machine.timing, cpuLimitTimer);
 	}
 	else {
 		speed = 0;
-		instructionsperloop = 100;
+		cyclesperloop = 1000;
 		limitCPU = 0;
-		timing_timerDisable(cpuLimitTimer);
+		timing_timerDisable(&machine.timing, cpuLimitTimer);
 	}
 }
 
@@ -87,19 +90,21 @@ int main(int argc, char *argv[]) {
 	printf("%s (c)2020 Mike Chambers\r\n", title);
 	printf("[A portable, open source 80186 PC emulator]\r\n\r\n");
 
-	ports_init();
-	timing_init();
-	memory_init();
+	ports_init(&machine.ports);
+	timing_init(&machine.timing);
+	memory_init(&machine.memory);
+	cpu_connectBus(&machine.CPU, &machine.memory, &machine.ports);
 #ifdef _WIN32
 	menus_setMachine(&machine);
 #endif
 
 	machine.pcap_if = -1;
+	machine.biosdisk.bootdrive = 0xFF;
 	if (args_parse(&machine, argc, argv)) {
 		return -1;
 	}
 
-	if (sdlconsole_init(title)) {
+	if (sdlconsole_init(title, &machine)) {
 		debug_log(DEBUG_ERROR, "[ERROR] SDL initialization failure\r\n");
 		return -1;
 	}
@@ -113,53 +118,73 @@ int main(int argc, char *argv[]) {
 		return -1;
 	}
 
-	if (bootdrive == 0xFF) {
-		if (biosdisk[2].inserted) {
-			bootdrive = 0x80;
+	if (fleet_workers > 0) {
+		fleet_init(&machine);
+	}
+
+	if (machine.biosdisk.bootdrive == 0xFF) {
+		if (machine.biosdisk.disk[2].inserted) {
+			machine.biosdisk.bootdrive = 0x80;
 		}
 		else {
-			bootdrive = 0x00;
+			machine.biosdisk.bootdrive = 0x00;
 		}
 	}
 
-	timing_addTimer(optimer, NULL, 10, TIMING_ENABLED);
-	cpuLimitTimer = timing_addTimer(cputimer, NULL, 10000, TIMING_DISABLED);
+	timing_addTimer(&machine.timing, optimer, NULL, 10, TIMING_ENABLED);
+	cpuLimitTimer = timing_addTimer(&machine.timing, cputimer, NULL, 10000, TIMING_DISABLED);
 	if (speed > 0) {
 		setspeed(speed);
 	}
 	while (running) {
 		static uint32_t curloop = 0;
+		static int32_t cyclesleft = 0;
+		uint32_t ran;
 		if (limitCPU == 0) {
 			goCPU = 1;
 		}
 		if (goCPU) {
-			cpu_interruptCheck(&machine.CPU, &machine.i8259);
-			cpu_exec(&machine.CPU, instructionsperloop);
-			ops += instructionsperloop;
+			//whatever the last instruction ran over the budget is taken out of the next one
+			cyclesleft += cyclesperloop;
+			if (cyclesleft > 0) {
+				ran = cpu_exec(&machine.CPU, (uint32_t)cyclesleft);
+				cyclesleft -= (int32_t)ran;
+				cycles += ran;
+			}
 			goCPU = 0;
 		}
-		timing_loop();
-		sdlaudio_updateSampleTiming();
+		timing_loop(&machine.timing);
+		if (fleet_workers > 0) {
+			fleet_service(&machine);
+		}
+		//fleet workers are forked without the audio and video threads, so they run headless
+		if (fleet_worker < 0) {
+			sdlaudio_updateSampleTiming();
+		}
+		//a halted CPU has nothing to do until an interrupt can come in, so let the host sleep rather than spin
+		if (machine.CPU.hltstate && !(machine.CPU.ifl && machine.CPU.intr)) {
+			timing_idle(&machine.timing, 1000);
+		}
 		if (++curloop == 100) {
-			switch (sdlconsole_loop()) {
-			case SDLCONSOLE_EVENT_KEY:
-				machine.KeyState.scancode = sdlconsole_getScancode();
-				machine.KeyState.isNew = 1;
-				i8259_doirq(&machine.i8259, 1);
-				break;
-			case SDLCONSOLE_EVENT_QUIT:
-				running = 0;
-				break;
-			case SDLCONSOLE_EVENT_DEBUG_1:
-				break;
-			case SDLCONSOLE_EVENT_DEBUG_2:
-				break;
+			if (fleet_worker < 0) {
+				switch (sdlconsole_loop()) {
+				case SDLCONSOLE_EVENT_KEY:
+					machine.KeyState.scancode = sdlconsole_getScancode();
+					machine.KeyState.isNew = 1;
+					i8259_doirq(&machine.i8259, 1);
+					break;
+				case SDLCONSOLE_EVENT_QUIT:
+					running = 0;
+					break;
+				case SDLCONSOLE_EVENT_DEBUG_1:
+					break;
+				case SDLCONSOLE_EVENT_DEBUG_2:
+					break;
+				}
 			}
-
-
 			curloop = 0;
 		}
 	}
 
-	return 0;
+	return fleet_exitcode;
 }
@@ -25,71 +25,118 @@
 #include "modules/video/cga.h"
 #include "modules/video/vga.h"
 #include "utility.h"
+#include "debuglog.h"
 #include "memory.h"
 
-uint8_t* memory_mapRead[MEMORY_RANGE];
-uint8_t* memory_mapWrite[MEMORY_RANGE];
-uint8_t (*memory_mapReadCallback[MEMORY_RANGE])(void* udata, uint32_t addr);
-void (*memory_mapWriteCallback[MEMORY_RANGE])(void* udata, uint32_t addr, uint8_t value);
-void* memory_udata[MEMORY_RANGE];
-
 void cpu_write(CPU_t* cpu, uint32_t addr32, uint8_t value) {
-	addr32 &= MEMORY_MASK;
+	MEMORY_t* memory = cpu->memory;
+	uint32_t page;
 
-	if (memory_mapWrite[addr32] != NULL) {
-		*(memory_mapWrite[addr32]) = value;
+	addr32 &= MEMORY_MASK;
+	page = addr32 >> MEMORY_PAGE_SHIFT;
+
+	if (memory->pageWrite[page] != NULL) {
+		memory->pageWrite[page][addr32 & MEMORY_PAGE_MASK] = value;
+#ifdef CPU_BLOCK_CACHE
+		if (memory->codePage[addr32 >> MEMORY_CODE_SHIFT]) {
+			memory->codePage[addr32 >> MEMORY_CODE_SHIFT] = 0;
+			memory->codeGen[addr32 >> MEMORY_CODE_SHIFT]++;
+		}
+#endif
 	}
-	else if (memory_mapWriteCallback[addr32] != NULL) {
-		(*memory_mapWriteCallback[addr32])(memory_udata[addr32], addr32, value);
+	else if (memory->pageWriteCallback[page] != NULL) {
+		(*memory->pageWriteCallback[page])(memory->pageUdata[page], addr32, value);
 	}
 }
 
 uint8_t cpu_read(CPU_t* cpu, uint32_t addr32) {
+	MEMORY_t* memory = cpu->memory;
+	uint32_t page;
+
 	addr32 &= MEMORY_MASK;
+	page = addr32 >> MEMORY_PAGE_SHIFT;
 
-	if (memory_mapRead[addr32] != NULL) {
-		return *(memory_mapRead[addr32]);
+	if (memory->pageRead[page] != NULL) {
+		return memory->pageRead[page][addr32 & MEMORY_PAGE_MASK];
 	}
 
-	if (memory_mapReadCallback[addr32] != NULL) {
-		return (*memory_mapReadCallback[addr32])(memory_udata[addr32], addr32);
+	if (memory->pageReadCallback[page] != NULL) {
+		return (*memory->pageReadCallback[page])(memory->pageUdata[page], addr32);
 	}
 
 	return 0xFF;
 }
 
-void memory_mapRegister(uint32_t start, uint32_t len, uint8_t* readb, uint8_t* writeb) {
+//Code in pages backed by plain memory can be read without side effects, so it can be cached
+uint8_t memory_isDirectPage(MEMORY_t* memory, uint32_t page) {
+	return memory->pageRead[page >> (MEMORY_PAGE_SHIFT - MEMORY_CODE_SHIFT)] != NULL;
+}
+
+//Pages covered by a mapping, anything cached from them is thrown out since what's behind them changed
+uint8_t memory_mapPages(MEMORY_t* memory, uint32_t start, uint32_t len, uint32_t* first, uint32_t* last) {
 	uint32_t i;
-	for (i = 0; i < len; i++) {
-		if ((start + i) >= MEMORY_RANGE) {
-			break;
-		}
-		memory_mapRead[start + i] = (readb == NULL) ? NULL : readb + i;
-		memory_mapWrite[start + i] = (writeb == NULL) ? NULL : writeb + i;
+
+	if ((len == 0) || (start >= MEMORY_RANGE)) {
+		return 0;
+	}
+	if ((start + len) > MEMORY_RANGE) {
+		len = MEMORY_RANGE - start;
+	}
+	if ((start & MEMORY_PAGE_MASK) || (len & MEMORY_PAGE_MASK)) {
+		debug_log(DEBUG_ERROR, "[MEMORY] Mapping at %05X, length %05X isn't aligned to %lu byte pages, rounding it in\r\n", start, len, (uint32_t)1 << MEMORY_PAGE_SHIFT);
+	}
+
+	*first = (start + MEMORY_PAGE_MASK) >> MEMORY_PAGE_SHIFT;
+	*last = (start + len) >> MEMORY_PAGE_SHIFT;
+	for (i = *first << (MEMORY_PAGE_SHIFT - MEMORY_CODE_SHIFT); i < (*last << (MEMORY_PAGE_SHIFT - MEMORY_CODE_SHIFT)); i++) {
+		memory->codePage[i] = 0;
+		memory->codeGen[i]++;
 	}
+	return *first < *last;
 }
 
-void memory_mapCallbackRegister(uint32_t start, uint32_t count, uint8_t(*readb)(void*, uint32_t), void (*writeb)(void*, uint32_t, uint8_t), void* udata) {
-	uint32_t i;
-	for (i = 0; i < count; i++) {
-		if ((start + i) >= MEMORY_RANGE) {
-			break;
-		}
-		memory_mapReadCallback[start + i] = readb;
-		memory_mapWriteCallback[start + i] = writeb;
-		memory_udata[start + i] = udata;
+void memory_mapRegister(MEMORY_t* memory, uint32_t start, uint32_t len, uint8_t* readb, uint8_t* writeb) {
+	uint32_t page, first, last, ofs;
+
+	if (!memory_mapPages(memory, start, len, &first, &last)) {
+		return;
+	}
+
+	for (page = first; page < last; page++) {
+		ofs = (page << MEMORY_PAGE_SHIFT) - start;
+		memory->pageRead[page] = (readb == NULL) ? NULL : readb + ofs;
+		memory->pageWrite[page] = (writeb == NULL) ? NULL : writeb + ofs;
 	}
 }
 
-int memory_init() {
+void memory_mapCallbackRegister(MEMORY_t* memory, uint32_t start, uint32_t count, uint8_t(*readb)(void*, uint32_t), void (*writeb)(void*, uint32_t, uint8_t), void* udata) {
+	uint32_t page, first, last;
+
+	if (!memory_mapPages(memory, start, count, &first, &last)) {
+		return;
+	}
+
+	for (page = first; page < last; page++) {
+		memory->pageReadCallback[page] = readb;
+		memory->pageWriteCallback[page] = writeb;
+		memory->pageUdata[page] = udata;
+	}
+}
+
+int memory_init(MEMORY_t* memory) {
 	uint32_t i;
 
-	for (i = 0; i < MEMORY_RANGE; i++) {
-		memory_mapRead[i] = NULL;
-		memory_mapWrite[i] = NULL;
-		memory_mapReadCallback[i] = NULL;
-		memory_mapWriteCallback[i] = NULL;
-		memory_udata[i] = NULL;
+	for (i = 0; i < MEMORY_PAGES; i++) {
+		memory->pageRead[i] = NULL;
+		memory->pageWrite[i] = NULL;
+		memory->pageReadCallback[i] = NULL;
+		memory->pageWriteCallback[i] = NULL;
+		memory->pageUdata[i] = NULL;
+	}
+
+	for (i = 0; i < MEMORY_CODE_PAGES; i++) {
+		memory->codePage[i] = 0;
+		memory->codeGen[i] = 0;
 	}
 
 	return 0;
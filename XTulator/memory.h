@@ -6,8 +6,29 @@
 #define MEMORY_RANGE		0x100000
 #define MEMORY_MASK			0x0FFFFF
 
-void memory_mapRegister(uint32_t start, uint32_t len, uint8_t* readb, uint8_t* writeb);
-void memory_mapCallbackRegister(uint32_t start, uint32_t count, uint8_t(*readb)(void*, uint32_t), void (*writeb)(void*, uint32_t, uint8_t), void* udata);
-int memory_init();
+#define MEMORY_PAGE_SHIFT	11	//The memory map is kept in 2 KB pages, mappings should start and end on a page boundary
+#define MEMORY_PAGE_MASK	((1 << MEMORY_PAGE_SHIFT) - 1)
+#define MEMORY_PAGES		(MEMORY_RANGE >> MEMORY_PAGE_SHIFT)
+
+#define MEMORY_CODE_SHIFT	8	//Writes to cached code are tracked in finer 256 byte pages
+#define MEMORY_CODE_PAGES	(MEMORY_RANGE >> MEMORY_CODE_SHIFT)
+
+typedef struct {
+	//Each page either points straight at host memory for reads and/or writes, or has callbacks for the ones that don't
+	uint8_t* pageRead[MEMORY_PAGES];
+	uint8_t* pageWrite[MEMORY_PAGES];
+	uint8_t (*pageReadCallback[MEMORY_PAGES])(void* udata, uint32_t addr);
+	void (*pageWriteCallback[MEMORY_PAGES])(void* udata, uint32_t addr, uint8_t value);
+	void* pageUdata[MEMORY_PAGES];
+
+	//Pages that the CPU has cached decoded code from, and a generation count that is bumped when one is written to
+	uint8_t codePage[MEMORY_CODE_PAGES];
+	uint32_t codeGen[MEMORY_CODE_PAGES];
+} MEMORY_t;
+
+void memory_mapRegister(MEMORY_t* memory, uint32_t start, uint32_t len, uint8_t* readb, uint8_t* writeb);
+void memory_mapCallbackRegister(MEMORY_t* memory, uint32_t start, uint32_t count, uint8_t(*readb)(void*, uint32_t), void (*writeb)(void*, uint32_t, uint8_t), void* udata);
+uint8_t memory_isDirectPage(MEMORY_t* memory, uint32_t page);
+int memory_init(MEMORY_t* memory);
 
 #endif
@@ -112,7 +112,7 @@ void menus_resetCallback(void* dummy) {
 	i8259_doirq(&menus_useMachine->i8259, 1);
 
 	if (menus_resetPos == 3) {
-		timing_timerDisable(menus_resetTimer);
+		timing_timerDisable(&menus_useMachine->timing, menus_resetTimer);
 	}
 }
 
@@ -135,7 +135,7 @@ int menus_init(HWND hwnd) {
 	DrawMenuBar(hwnd);
 
 	menus_oldProc = (WNDPROC)SetWindowLong(hwnd, GWL_WNDPROC, (LONG_PTR)menus_wndProc);
-	menus_resetTimer = timing_addTimer(menus_resetCallback, NULL, 10, TIMING_DISABLED);
+	menus_resetTimer = timing_addTimer(&menus_useMachine->timing, menus_resetCallback, NULL, 10, TIMING_DISABLED);
 
 	return 0;
 }
@@ -171,7 +171,7 @@ void menus_openFloppyFile(uint8_t disk) {
 			return;
 		}
 		wcstombs(filembs, of_dlg.lpstrFile, size + 1);
-		biosdisk_insert(&menus_useMachine->CPU, disk, filembs);
+		biosdisk_insert(&menus_useMachine->biosdisk, &menus_useMachine->CPU, disk, filembs);
 		free(filembs);
 	}
 }
@@ -197,7 +197,7 @@ void menus_openHardFile(uint8_t disk) {
 			return;
 		}
 		wcstombs(filembs, of_dlg.lpstrFile, size + 1);
-		biosdisk_insert(&menus_useMachine->CPU, disk, filembs);
+		biosdisk_insert(&menus_useMachine->biosdisk, &menus_useMachine->CPU, disk, filembs);
 		free(filembs);
 		menus_reset();
 	}
@@ -212,11 +212,11 @@ void menus_changeFloppy1() {
 }
 
 void menus_ejectFloppy0() {
-	biosdisk_eject(&menus_useMachine->CPU, 0);
+	biosdisk_eject(&menus_useMachine->biosdisk, &menus_useMachine->CPU, 0);
 }
 
 void menus_ejectFloppy1() {
-	biosdisk_eject(&menus_useMachine->CPU, 1);
+	biosdisk_eject(&menus_useMachine->biosdisk, &menus_useMachine->CPU, 1);
 }
 
 void menus_insertHard0() {
@@ -228,16 +228,16 @@ void menus_insertHard1() {
 }
 
 void menus_setBootFloppy0() {
-	bootdrive = 0;
+	menus_useMachine->biosdisk.bootdrive = 0;
 }
 
 void menus_setBootHard0() {
-	bootdrive = 2;
+	menus_useMachine->biosdisk.bootdrive = 2;
 }
 
 void menus_reset() {
 	menus_resetPos = 0;
-	timing_timerEnable(menus_resetTimer);
+	timing_timerEnable(&menus_useMachine->timing, menus_resetTimer);
 }
 
 void menus_speed477() {
@@ -81,7 +81,7 @@ void blaster_writecmd(BLASTER_t* blaster, uint8_t value) {
 			blaster->autoinit = 0;
 			blaster->dorecord = (blaster->lastcmd == 0x24) ? 1 : 0;
 			blaster->activedma = 1;
-			timing_timerEnable(blaster->timer);
+			timing_timerEnable(blaster->timing, blaster->timer);
 #ifdef DEBUG_BLASTER
 			debug_log(DEBUG_DETAIL, "[BLASTER] Begin DMA transfer mode with %lu byte blocks\r\n", blaster->dmalen);
 #endif
@@ -90,7 +90,7 @@ void blaster_writecmd(BLASTER_t* blaster, uint8_t value) {
 	case 0x40: //set time constant
 		blaster->timeconst = value;
 		blaster->samplerate = 1000000.0 / (256.0 - (double)value);
-		timing_updateIntervalFreq(blaster->timer, blaster->samplerate);
+		timing_updateIntervalFreq(blaster->timing, blaster->timer, blaster->samplerate);
 		blaster->lastcmd = 0;
 #ifdef DEBUG_BLASTER
 		debug_log(DEBUG_DETAIL, "[BLASTER] Set time constant: %u (Sample rate: %f Hz)\r\n", value, blaster->samplerate);
@@ -117,7 +117,7 @@ void blaster_writecmd(BLASTER_t* blaster, uint8_t value) {
 			blaster->dmacount = 0;
 			blaster->silencedsp = 1;
 			blaster->autoinit = 0;
-			timing_timerEnable(blaster->timer);
+			timing_timerEnable(blaster->timing, blaster->timer);
 		}
 		return;
 	case 0xE0: //DSP identification (returns bitwise NOT of data byte)
@@ -157,7 +157,7 @@ void blaster_writecmd(BLASTER_t* blaster, uint8_t value) {
 		blaster->autoinit = 1;
 		blaster->dorecord = (value == 0x2C) ? 1 : 0;
 		blaster->activedma = 1;
-		timing_timerEnable(blaster->timer);
+		timing_timerEnable(blaster->timing, blaster->timer);
 #ifdef DEBUG_BLASTER
 		debug_log(DEBUG_DETAIL, "[BLASTER] Begin auto-init DMA transfer mode with %lu byte blocks\r\n", blaster->dmalen);
 #endif
@@ -175,7 +175,7 @@ void blaster_writecmd(BLASTER_t* blaster, uint8_t value) {
 		break;
 	case 0xD0: //halt DMA operation, 8-bit
 		blaster->activedma = 0;
-		timing_timerDisable(blaster->timer);
+		timing_timerDisable(blaster->timing, blaster->timer);
 		break;
 	case 0xD1: //speaker on
 		blaster->dspenable = 1;
@@ -185,7 +185,7 @@ void blaster_writecmd(BLASTER_t* blaster, uint8_t value) {
 		break;
 	case 0xD4: //continue DMA operation, 8-bit
 		blaster->activedma = 1;
-		timing_timerEnable(blaster->timer);
+		timing_timerEnable(blaster->timing, blaster->timer);
 		break;
 	case 0xDA: //exit auto-initialize DMA operation, 8-bit
 		blaster->activedma = 0;
@@ -273,7 +273,7 @@ void blaster_generateSample(BLASTER_t* blaster) { //for DMA mode
 		i8259_doirq(blaster->i8259, blaster->irq);
 		if (blaster->autoinit == 0) {
 			blaster->activedma = 0;
-			timing_timerDisable(blaster->timer);
+			timing_timerDisable(blaster->timing, blaster->timer);
 		}
 	}
 
@@ -287,15 +287,16 @@ int16_t blaster_getSample(BLASTER_t* blaster) {
 	return blaster->sample;
 }
 
-void blaster_init(BLASTER_t* blaster, I8237_t* i8237, I8259_t* i8259, uint16_t base, uint8_t dma, uint8_t irq) {
+void blaster_init(BLASTER_t* blaster, I8237_t* i8237, I8259_t* i8259, PORTS_t* ports, TIMING_t* timing, uint16_t base, uint8_t dma, uint8_t irq) {
 	debug_log(DEBUG_INFO, "[BLASTER] Initializing Sound Blaster 2.0 at base port 0x%03X, IRQ %u, DMA %u\r\n", base, irq, dma);
 	memset(blaster, 0, sizeof(BLASTER_t));
 	blaster->i8237 = i8237;
 	blaster->i8259 = i8259;
+	blaster->timing = timing;
 	blaster->dmachan = dma;
 	blaster->irq = irq;
-	ports_cbRegister(base, 16, (void*)blaster_read, NULL, (void*)blaster_write, NULL, blaster);
+	ports_cbRegister(ports, base, 16, (void*)blaster_read, NULL, (void*)blaster_write, NULL, blaster);
 
 	//TODO: error handling
-	blaster->timer = timing_addTimer(blaster_generateSample, blaster, 22050, TIMING_DISABLED);
+	blaster->timer = timing_addTimer(timing, blaster_generateSample, blaster, 22050, TIMING_DISABLED);
 }
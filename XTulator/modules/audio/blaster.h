@@ -4,10 +4,13 @@
 #include <stdint.h>
 #include "../../chipset/i8237.h"
 #include "../../chipset/i8259.h"
+#include "../../ports.h"
+#include "../../timing.h"
 
 typedef struct {
 	I8237_t* i8237;
 	I8259_t* i8259;
+	TIMING_t* timing;
 	uint8_t dspenable;
 	int16_t sample;
 	uint8_t readbuf[16];
@@ -33,6 +36,6 @@ typedef struct {
 void blaster_write(BLASTER_t* blaster, uint16_t addr, uint8_t value);
 uint8_t blaster_read(BLASTER_t* blaster, uint16_t addr);
 int16_t blaster_getSample(BLASTER_t* blaster);
-void blaster_init(BLASTER_t* blaster, I8237_t* i8237, I8259_t* i8259, uint16_t base, uint8_t dma, uint8_t irq);
+void blaster_init(BLASTER_t* blaster, I8237_t* i8237, I8259_t* i8259, PORTS_t* ports, TIMING_t* timing, uint16_t base, uint8_t dma, uint8_t irq);
 
 #endif
@@ -1418,8 +1418,8 @@ void OPL3_write(opl3_chip* chip, uint32_t portnum, uint8_t value) {
     }
 }
 
-void OPL3_init(opl3_chip* chip) {
+void OPL3_init(opl3_chip* chip, PORTS_t* ports) {
     debug_log(DEBUG_INFO, "[OPL] Initializing OPL2\r\n");
     OPL3_Reset(chip, SAMPLE_RATE);
-    ports_cbRegister(0x388, 2, (void*)OPL3_read, NULL, (void*)OPL3_write, NULL, chip);
+    ports_cbRegister(ports, 0x388, 2, (void*)OPL3_read, NULL, (void*)OPL3_write, NULL, chip);
 }
@@ -35,6 +35,7 @@
 
 #include <inttypes.h>
 #include "../../config.h"
+#include "../../ports.h"
 
 #define OPL_WRITEBUF_SIZE   1024
 #define OPL_WRITEBUF_DELAY  2
@@ -158,6 +159,6 @@ void OPL3_GenerateStream(opl3_chip* chip, Bit16s* sndptr, Bit32u numsamples);
 //added for interfacing with XTulator
 int16_t OPL3_getSample(opl3_chip* chip);
 void OPL3_write(opl3_chip* chip, uint32_t portnum, uint8_t value);
-void OPL3_init(opl3_chip* chip);
+void OPL3_init(opl3_chip* chip, PORTS_t* ports);
 
 #endif
@@ -99,7 +99,7 @@ void opl2_writeData(OPL2_t* opl2, uint8_t value) {
 			opl2->oper[op1].attackval = 0;
 			opl2->oper[op1].decayval = 0;
 			opl2->oper[op1].envelope = 0.01;
-			timing_timerEnable(opl2->oper[op1].timer);
+			timing_timerEnable(opl2->timing, opl2->oper[op1].timer);
 #ifdef DEBUG_OPL2
 			debug_log(DEBUG_DETAIL, "[OPL2] Key on channel %u, frequency: %f\r\n", ch, opl2->chan[ch].frequency);
 #endif
@@ -108,8 +108,8 @@ void opl2_writeData(OPL2_t* opl2, uint8_t value) {
 			opl2->chan[ch].on = (value & 0x20) ? 1 : 0;
 			opl2->oper[op1].amplitude = 0;
 			opl2->oper[op2].amplitude = 0;
-			timing_timerDisable(opl2->oper[op1].timer);
-			timing_timerDisable(opl2->oper[op2].timer);
+			timing_timerDisable(opl2->timing, opl2->oper[op1].timer);
+			timing_timerDisable(opl2->timing, opl2->oper[op2].timer);
 		}
 	}
 	else if ((opl2->addr >= 0xE0) && (opl2->addr <= 0xF5)) {
@@ -224,16 +224,17 @@ void opl2_tickOperator(OPL2CB_t* opl2cb) {
 	}
 }
 
-void opl2_init(OPL2_t* opl2) {
+void opl2_init(OPL2_t* opl2, PORTS_t* ports, TIMING_t* timing) {
 	uint8_t i;
 	memset(opl2, 0, sizeof(OPL2_t));
-	ports_cbRegister(0x388, 2, (void*)opl2_read, NULL, (void*)opl2_write, NULL, opl2);
+	opl2->timing = timing;
+	ports_cbRegister(ports, 0x388, 2, (void*)opl2_read, NULL, (void*)opl2_write, NULL, opl2);
 
 	for (i = 0; i < 0x16; i++) {
 		//TODO: add error handling
 		//opl2->oper[i].opdata.chan = i;
 		opl2->oper[i].opdata.op = i;
 		opl2->oper[i].opdata.opl2 = (void*)opl2;
-		opl2->oper[i].timer = timing_addTimer(opl2_tickOperator, &opl2->oper[i].opdata, SAMPLE_RATE, TIMING_DISABLED);
+		opl2->oper[i].timer = timing_addTimer(timing, opl2_tickOperator, &opl2->oper[i].opdata, SAMPLE_RATE, TIMING_DISABLED);
 	}
 }
@@ -2,6 +2,8 @@
 #define _OPL2_H_
 
 #include <stdint.h>
+#include "../../ports.h"
+#include "../../timing.h"
 
 #define VOLUME_CONST	1.2
 
@@ -12,6 +14,7 @@ typedef struct {
 } OPL2CB_t;
 
 typedef struct {
+	TIMING_t* timing;
 	uint8_t addr;
 	uint8_t data[0x100];
 	struct {
@@ -44,6 +47,6 @@ void opl2_write(OPL2_t* opl2, uint16_t portnum, uint8_t value);
 uint8_t opl2_read(OPL2_t* opl2, uint16_t portnum);
 int16_t opl2_generateSample(OPL2_t* opl2);
 void opl2_tickOperator(OPL2CB_t* opl2cb);
-void opl2_init(OPL2_t* opl2);
+void opl2_init(OPL2_t* opl2, PORTS_t* ports, TIMING_t* timing);
 
 #endif
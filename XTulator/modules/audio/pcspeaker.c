@@ -62,10 +62,10 @@ void pcspeaker_callback(PCSPEAKER_t* spk) {
 	if (spk->pcspeaker_amplitude < 0) spk->pcspeaker_amplitude = 0;
 }
 
-void pcspeaker_init(PCSPEAKER_t* spk) {
+void pcspeaker_init(PCSPEAKER_t* spk, TIMING_t* timing) {
 	memset(spk, 0, sizeof(PCSPEAKER_t));
 	spk->pcspeaker_gateSelect = PC_SPEAKER_GATE_DIRECT;
-	timing_addTimer(pcspeaker_callback, spk, SAMPLE_RATE, TIMING_ENABLED);
+	timing_addTimer(timing, pcspeaker_callback, spk, SAMPLE_RATE, TIMING_ENABLED);
 }
 
 int16_t pcspeaker_getSample(PCSPEAKER_t* spk) {
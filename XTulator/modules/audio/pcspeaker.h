@@ -2,6 +2,7 @@
 #define _PCSPEAKER_H_
 
 #include <stdint.h>
+#include "../../timing.h"
 
 #define PC_SPEAKER_GATE_DIRECT	0
 #define PC_SPEAKER_GATE_TIMER2	1
@@ -20,6 +21,6 @@ typedef struct {
 void pcspeaker_setGateState(PCSPEAKER_t* spk, uint8_t gate, uint8_t value);
 void pcspeaker_selectGate(PCSPEAKER_t* spk, uint8_t value);
 int16_t pcspeaker_getSample(PCSPEAKER_t* spk);
-void pcspeaker_init(PCSPEAKER_t* spk);
+void pcspeaker_init(PCSPEAKER_t* spk, TIMING_t* timing);
 
 #endif
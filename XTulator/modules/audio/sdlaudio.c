@@ -105,7 +105,7 @@ int sdlaudio_init(MACHINE_t* machine) {
 
 	sdlaudio_rateFast = (double)(SAMPLE_RATE) * 1.01;
 
-	sdlaudio_timer = timing_addTimer(sdlaudio_generateSample, NULL, SAMPLE_RATE, TIMING_ENABLED);
+	sdlaudio_timer = timing_addTimer(&machine->timing, sdlaudio_generateSample, NULL, SAMPLE_RATE, TIMING_ENABLED);
 
 	SDL_PauseAudio(1);
 	SDL_CondSignal(sdlaudio_canFill);
@@ -132,7 +132,7 @@ void sdlaudio_bufferSample(int16_t val) {
 	}
 
 	if (sdlaudio_bufferpos == SAMPLE_BUFFER) {
-		timing_timerDisable(sdlaudio_timer);
+		timing_timerDisable(&sdlaudio_useMachine->timing, sdlaudio_timer);
 	}
 
 	//SDL_UnlockMutex(sdlaudio_mutex);
@@ -141,10 +141,10 @@ void sdlaudio_bufferSample(int16_t val) {
 
 void sdlaudio_updateSampleTiming() {
 	if (sdlaudio_updateTiming == SDLAUDIO_TIMING_FAST) {
-		timing_updateIntervalFreq(sdlaudio_timer, sdlaudio_rateFast);
+		timing_updateIntervalFreq(&sdlaudio_useMachine->timing, sdlaudio_timer, sdlaudio_rateFast);
 	}
 	else if (sdlaudio_updateTiming == SDLAUDIO_TIMING_NORMAL) {
-		timing_updateIntervalFreq(sdlaudio_timer, SAMPLE_RATE);
+		timing_updateIntervalFreq(&sdlaudio_useMachine->timing, sdlaudio_timer, SAMPLE_RATE);
 		SDL_PauseAudio(0);
 	}
 	sdlaudio_updateTiming = 0;
@@ -156,7 +156,7 @@ void sdlaudio_moveBuffer(int16_t* dst, int len) {
 	memset(dst, 0, len);
 
 	if (sdlaudio_bufferpos < (int)((double)(SAMPLE_BUFFER) * 0.75)) {
-		timing_timerEnable(sdlaudio_timer);
+		timing_timerEnable(&sdlaudio_useMachine->timing, sdlaudio_timer);
 	}
 
 	if ((sdlaudio_bufferpos << 1) < len) {
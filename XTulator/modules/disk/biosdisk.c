@@ -28,73 +28,119 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "biosdisk.h"
 #include "../../cpu/cpu.h"
 #include "../../debuglog.h"
 
-DISK_t biosdisk[4];
-uint8_t biosdisk_sectbuf[512];
-
-uint8_t bootdrive = 0xFF;
-
-uint8_t biosdisk_insert(CPU_t* cpu, uint8_t drivenum, char* filename) {
+uint8_t biosdisk_insert(BIOSDISK_t* biosdisk, CPU_t* cpu, uint8_t drivenum, char* filename) {
 	debug_log(DEBUG_INFO, "[BIOSDISK] Inserting disk %u: %s\r\n", drivenum, filename);
-	if (biosdisk[drivenum].inserted) fclose(biosdisk[drivenum].diskfile);
-	biosdisk[drivenum].inserted = 1;
-	biosdisk[drivenum].diskfile = fopen(filename, "r+b");
-	if (biosdisk[drivenum].diskfile == NULL) {
-		biosdisk[drivenum].inserted = 0;
+	if (biosdisk->disk[drivenum].inserted) biosdisk_eject(biosdisk, cpu, drivenum);
+	biosdisk->disk[drivenum].inserted = 1;
+	biosdisk->disk[drivenum].diskfile = fopen(filename, "r+b");
+	if (biosdisk->disk[drivenum].diskfile == NULL) {
+		biosdisk->disk[drivenum].inserted = 0;
 		debug_log(DEBUG_INFO, "[BIOSDISK] Failed to insert disk %u: %s\r\n", drivenum, filename);
 		return 1;
 	}
-	fseek(biosdisk[drivenum].diskfile, 0L, SEEK_END);
-	biosdisk[drivenum].filesize = ftell(biosdisk[drivenum].diskfile);
-	fseek(biosdisk[drivenum].diskfile, 0L, SEEK_SET);
+	biosdisk->disk[drivenum].filename = (char*)malloc(strlen(filename) + 1);
+	if (biosdisk->disk[drivenum].filename != NULL) {
+		strcpy(biosdisk->disk[drivenum].filename, filename);
+	}
+	fseek(biosdisk->disk[drivenum].diskfile, 0L, SEEK_END);
+	biosdisk->disk[drivenum].filesize = ftell(biosdisk->disk[drivenum].diskfile);
+	fseek(biosdisk->disk[drivenum].diskfile, 0L, SEEK_SET);
 	if (drivenum >= 2) { //it's a hard disk image
-		biosdisk[drivenum].sects = 63;
-		biosdisk[drivenum].heads = 16;
-		biosdisk[drivenum].cyls = biosdisk[drivenum].filesize / (biosdisk[drivenum].sects * biosdisk[drivenum].heads * 512);
-		cpu_write(cpu, 0x475, biosdisk_gethdcount());
+		biosdisk->disk[drivenum].sects = 63;
+		biosdisk->disk[drivenum].heads = 16;
+		biosdisk->disk[drivenum].cyls = biosdisk->disk[drivenum].filesize / (biosdisk->disk[drivenum].sects * biosdisk->disk[drivenum].heads * 512);
+		cpu_write(cpu, 0x475, biosdisk_gethdcount(biosdisk));
 	}
 	else {   //it's a floppy image
-		biosdisk[drivenum].cyls = 80;
-		biosdisk[drivenum].sects = 18;
-		biosdisk[drivenum].heads = 2;
-		if (biosdisk[drivenum].filesize <= 1228800) biosdisk[drivenum].sects = 15;
-		if (biosdisk[drivenum].filesize <= 737280) biosdisk[drivenum].sects = 9;
-		if (biosdisk[drivenum].filesize <= 368640) {
-			biosdisk[drivenum].cyls = 40;
-			biosdisk[drivenum].sects = 9;
+		biosdisk->disk[drivenum].cyls = 80;
+		biosdisk->disk[drivenum].sects = 18;
+		biosdisk->disk[drivenum].heads = 2;
+		if (biosdisk->disk[drivenum].filesize <= 1228800) biosdisk->disk[drivenum].sects = 15;
+		if (biosdisk->disk[drivenum].filesize <= 737280) biosdisk->disk[drivenum].sects = 9;
+		if (biosdisk->disk[drivenum].filesize <= 368640) {
+			biosdisk->disk[drivenum].cyls = 40;
+			biosdisk->disk[drivenum].sects = 9;
 		}
-		if (biosdisk[drivenum].filesize <= 163840) {
-			biosdisk[drivenum].cyls = 40;
-			biosdisk[drivenum].sects = 8;
-			biosdisk[drivenum].heads = 1;
+		if (biosdisk->disk[drivenum].filesize <= 163840) {
+			biosdisk->disk[drivenum].cyls = 40;
+			biosdisk->disk[drivenum].sects = 8;
+			biosdisk->disk[drivenum].heads = 1;
 		}
 	}
 	return 0;
 }
 
-void biosdisk_eject(CPU_t* cpu, uint8_t drivenum) {
-	biosdisk[drivenum].inserted = 0;
+void biosdisk_eject(BIOSDISK_t* biosdisk, CPU_t* cpu, uint8_t drivenum) {
+	DISK_t* disk = &biosdisk->disk[drivenum];
+
+	disk->inserted = 0;
 	if (drivenum >= 2) {
-		cpu_write(cpu, 0x475, biosdisk_gethdcount());
+		cpu_write(cpu, 0x475, biosdisk_gethdcount(biosdisk));
+	}
+	if (disk->diskfile != NULL) fclose(disk->diskfile);
+	if (disk->overlay != NULL) fclose(disk->overlay);
+	if (disk->written != NULL) free(disk->written);
+	if (disk->filename != NULL) free(disk->filename);
+	disk->diskfile = NULL;
+	disk->overlay = NULL;
+	disk->written = NULL;
+	disk->filename = NULL;
+}
+
+/*
+	Stop writing to the disk image and send sector writes to an overlay file instead,
+	leaving the image untouched. The image is reopened read-only so that a process
+	forked from the one that inserted it doesn't share its file position.
+*/
+uint8_t biosdisk_overlay(BIOSDISK_t* biosdisk, uint8_t drivenum, char* filename) {
+	DISK_t* disk = &biosdisk->disk[drivenum];
+
+	if (!disk->inserted || (disk->filename == NULL)) return 1;
+	fclose(disk->diskfile);
+	disk->diskfile = fopen(disk->filename, "rb");
+	disk->overlay = fopen(filename, "w+b");
+	disk->written = (uint8_t*)calloc((disk->filesize >> 12) + 1, 1);
+	if ((disk->diskfile == NULL) || (disk->overlay == NULL) || (disk->written == NULL)) {
+		debug_log(DEBUG_ERROR, "[BIOSDISK] Failed to create overlay for disk %u: %s\r\n", drivenum, filename);
+		disk->inserted = 0;
+		return 1;
+	}
+	debug_log(DEBUG_DETAIL, "[BIOSDISK] Writes to disk %u now go to overlay %s\r\n", drivenum, filename);
+	return 0;
+}
+
+/* file holding the given sector, positioned on it. without an overlay the image is read sequentially as before */
+FILE* biosdisk_sectorFile(DISK_t* disk, uint32_t lba, uint8_t write) {
+	FILE* file;
+
+	if (disk->overlay == NULL) return disk->diskfile;
+	if ((lba >> 3) > (disk->filesize >> 12)) return write ? NULL : disk->diskfile;
+	if (write) {
+		disk->written[lba >> 3] |= 1 << (lba & 7);
 	}
-	if (biosdisk[drivenum].diskfile != NULL) fclose(biosdisk[drivenum].diskfile);
+	file = (disk->written[lba >> 3] & (1 << (lba & 7))) ? disk->overlay : disk->diskfile;
+	fseek(file, lba * 512UL, SEEK_SET);
+	return file;
 }
 
-void biosdisk_read(CPU_t* cpu, uint8_t drivenum, uint16_t dstseg, uint16_t dstoff, uint16_t cyl, uint16_t sect, uint16_t head, uint16_t sectcount) {
+void biosdisk_read(BIOSDISK_t* biosdisk, CPU_t* cpu, uint8_t drivenum, uint16_t dstseg, uint16_t dstoff, uint16_t cyl, uint16_t sect, uint16_t head, uint16_t sectcount) {
 	uint32_t memdest, lba, fileoffset, cursect, sectoffset;
-	if (!sect || !biosdisk[drivenum].inserted) return;
-	lba = ((uint32_t)cyl * (uint32_t)biosdisk[drivenum].heads + (uint32_t)head) * (uint32_t)biosdisk[drivenum].sects + (uint32_t)sect - 1UL;
+	if (!sect || !biosdisk->disk[drivenum].inserted) return;
+	lba = ((uint32_t)cyl * (uint32_t)biosdisk->disk[drivenum].heads + (uint32_t)head) * (uint32_t)biosdisk->disk[drivenum].sects + (uint32_t)sect - 1UL;
 	fileoffset = lba * 512UL;
-	if (fileoffset > biosdisk[drivenum].filesize) return;
-	fseek(biosdisk[drivenum].diskfile, fileoffset, SEEK_SET);
+	if (fileoffset > biosdisk->disk[drivenum].filesize) return;
+	fseek(biosdisk->disk[drivenum].diskfile, fileoffset, SEEK_SET);
 	memdest = ((uint32_t)dstseg << 4) + (uint32_t)dstoff;
 	for (cursect = 0; cursect < sectcount; cursect++) {
-		if (fread(biosdisk_sectbuf, 1, 512, biosdisk[drivenum].diskfile) < 512) break;
+		if (fread(biosdisk->sectbuf, 1, 512, biosdisk_sectorFile(&biosdisk->disk[drivenum], lba + cursect, 0)) < 512) break;
 		for (sectoffset = 0; sectoffset < 512; sectoffset++) {
-			cpu_write(cpu, memdest++, biosdisk_sectbuf[sectoffset]);
+			cpu_write(cpu, memdest++, biosdisk->sectbuf[sectoffset]);
 		}
 	}
 	cpu->regs.byteregs[regal] = cursect;
@@ -102,43 +148,44 @@ void biosdisk_read(CPU_t* cpu, uint8_t drivenum, uint16_t dstseg, uint16_t dstof
 	cpu->regs.byteregs[regah] = 0;
 }
 
-void biosdisk_write(CPU_t* cpu, uint8_t drivenum, uint16_t dstseg, uint16_t dstoff, uint16_t cyl, uint16_t sect, uint16_t head, uint16_t sectcount) {
+void biosdisk_write(BIOSDISK_t* biosdisk, CPU_t* cpu, uint8_t drivenum, uint16_t dstseg, uint16_t dstoff, uint16_t cyl, uint16_t sect, uint16_t head, uint16_t sectcount) {
 	uint32_t memdest, lba, fileoffset, cursect, sectoffset;
-	if (!sect || !biosdisk[drivenum].inserted) return;
-	lba = ((uint32_t)cyl * (uint32_t)biosdisk[drivenum].heads + (uint32_t)head) * (uint32_t)biosdisk[drivenum].sects + (uint32_t)sect - 1UL;
+	if (!sect || !biosdisk->disk[drivenum].inserted) return;
+	lba = ((uint32_t)cyl * (uint32_t)biosdisk->disk[drivenum].heads + (uint32_t)head) * (uint32_t)biosdisk->disk[drivenum].sects + (uint32_t)sect - 1UL;
 	fileoffset = lba * 512UL;
-	if (fileoffset > biosdisk[drivenum].filesize) return;
-	fseek(biosdisk[drivenum].diskfile, fileoffset, SEEK_SET);
+	if (fileoffset > biosdisk->disk[drivenum].filesize) return;
+	fseek(biosdisk->disk[drivenum].diskfile, fileoffset, SEEK_SET);
 	memdest = ((uint32_t)dstseg << 4) + (uint32_t)dstoff;
 	for (cursect = 0; cursect < sectcount; cursect++) {
+		FILE* file;
 		for (sectoffset = 0; sectoffset < 512; sectoffset++) {
-			biosdisk_sectbuf[sectoffset] = cpu_read(cpu, memdest++);
+			biosdisk->sectbuf[sectoffset] = cpu_read(cpu, memdest++);
 		}
-		fwrite(biosdisk_sectbuf, 1, 512, biosdisk[drivenum].diskfile);
+		file = biosdisk_sectorFile(&biosdisk->disk[drivenum], lba + cursect, 1);
+		if (file != NULL) fwrite(biosdisk->sectbuf, 1, 512, file);
 	}
 	cpu->regs.byteregs[regal] = (uint8_t)sectcount;
 	cpu->cf = 0;
 	cpu->regs.byteregs[regah] = 0;
 }
 
-void biosdisk_int19h(CPU_t* cpu, uint8_t intnum) {
+void biosdisk_int19h(CPU_t* cpu, uint8_t intnum, BIOSDISK_t* biosdisk) {
 	if (intnum != 0x19) return;
 	
-	cpu_write(cpu, 0x475, biosdisk_gethdcount());
+	cpu_write(cpu, 0x475, biosdisk_gethdcount(biosdisk));
 
 	//put "STI" and then "JMP -1" code at bootloader location in case nothing gets read from disk
 	cpu_write(cpu, 0x07C00, 0xFB);
 	cpu_write(cpu, 0x07C01, 0xEB);
 	cpu_write(cpu, 0x07C02, 0xFE);
 
-	cpu->regs.byteregs[regdl] = bootdrive;
-	biosdisk_read(cpu, (cpu->regs.byteregs[regdl] & 0x80) ? cpu->regs.byteregs[regdl] - 126 : cpu->regs.byteregs[regdl], 0x0000, 0x7C00, 0, 1, 0, 1);
+	cpu->regs.byteregs[regdl] = biosdisk->bootdrive;
+	biosdisk_read(biosdisk, cpu, (cpu->regs.byteregs[regdl] & 0x80) ? cpu->regs.byteregs[regdl] - 126 : cpu->regs.byteregs[regdl], 0x0000, 0x7C00, 0, 1, 0, 1);
 	cpu->segregs[regcs] = 0x0000;
 	cpu->ip = 0x7C00;
 }
 
-void biosdisk_int13h(CPU_t* cpu, uint8_t intnum) {
-	static uint8_t lastah = 0, lastcf = 0;
+void biosdisk_int13h(CPU_t* cpu, uint8_t intnum, BIOSDISK_t* biosdisk) {
 	uint8_t curdisk;
 
 	if (intnum != 0x13) return;
@@ -157,12 +204,12 @@ void biosdisk_int13h(CPU_t* cpu, uint8_t intnum) {
 		cpu->cf = 0; //useless function in an emulator. say success and return.
 		break;
 	case 1: //return last status
-		cpu->regs.byteregs[regah] = lastah;
-		cpu->cf = lastcf;
+		cpu->regs.byteregs[regah] = biosdisk->lastah;
+		cpu->cf = biosdisk->lastcf;
 		return;
 	case 2: //read sector(s) into memory
-		if (biosdisk[curdisk].inserted) {
-			biosdisk_read(cpu, curdisk, cpu->segregs[reges], getreg16(cpu, regbx), (uint16_t)cpu->regs.byteregs[regch] + ((uint16_t)cpu->regs.byteregs[regcl] / 64) * 256, (uint16_t)cpu->regs.byteregs[regcl] & 63, (uint16_t)cpu->regs.byteregs[regdh], (uint16_t)cpu->regs.byteregs[regal]);
+		if (biosdisk->disk[curdisk].inserted) {
+			biosdisk_read(biosdisk, cpu, curdisk, cpu->segregs[reges], getreg16(cpu, regbx), (uint16_t)cpu->regs.byteregs[regch] + ((uint16_t)cpu->regs.byteregs[regcl] / 64) * 256, (uint16_t)cpu->regs.byteregs[regcl] & 63, (uint16_t)cpu->regs.byteregs[regdh], (uint16_t)cpu->regs.byteregs[regal]);
 			cpu->cf = 0;
 			cpu->regs.byteregs[regah] = 0;
 		}
@@ -172,8 +219,8 @@ void biosdisk_int13h(CPU_t* cpu, uint8_t intnum) {
 		}
 		break;
 	case 3: //write sector(s) from memory
-		if (biosdisk[curdisk].inserted) {
-			biosdisk_write(cpu, curdisk, cpu->segregs[reges], getreg16(cpu, regbx), (uint16_t)cpu->regs.byteregs[regch] + ((uint16_t)cpu->regs.byteregs[regcl] / 64) * 256, (uint16_t)cpu->regs.byteregs[regcl] & 63, (uint16_t)cpu->regs.byteregs[regdh], (uint16_t)cpu->regs.byteregs[regal]);
+		if (biosdisk->disk[curdisk].inserted) {
+			biosdisk_write(biosdisk, cpu, curdisk, cpu->segregs[reges], getreg16(cpu, regbx), (uint16_t)cpu->regs.byteregs[regch] + ((uint16_t)cpu->regs.byteregs[regcl] / 64) * 256, (uint16_t)cpu->regs.byteregs[regcl] & 63, (uint16_t)cpu->regs.byteregs[regdh], (uint16_t)cpu->regs.byteregs[regal]);
 			cpu->cf = 0;
 			cpu->regs.byteregs[regah] = 0;
 		}
@@ -188,18 +235,18 @@ void biosdisk_int13h(CPU_t* cpu, uint8_t intnum) {
 		cpu->regs.byteregs[regah] = 0;
 		break;
 	case 8: //get drive parameters
-		if (biosdisk[curdisk].inserted) {
+		if (biosdisk->disk[curdisk].inserted) {
 			cpu->cf = 0;
 			cpu->regs.byteregs[regah] = 0;
-			cpu->regs.byteregs[regch] = biosdisk[curdisk].cyls - 1;
-			cpu->regs.byteregs[regcl] = biosdisk[curdisk].sects & 63;
-			cpu->regs.byteregs[regcl] = cpu->regs.byteregs[regcl] + (biosdisk[curdisk].cyls / 256) * 64;
-			cpu->regs.byteregs[regdh] = biosdisk[curdisk].heads - 1;
+			cpu->regs.byteregs[regch] = biosdisk->disk[curdisk].cyls - 1;
+			cpu->regs.byteregs[regcl] = biosdisk->disk[curdisk].sects & 63;
+			cpu->regs.byteregs[regcl] = cpu->regs.byteregs[regcl] + (biosdisk->disk[curdisk].cyls / 256) * 64;
+			cpu->regs.byteregs[regdh] = biosdisk->disk[curdisk].heads - 1;
 			if (curdisk < 2) {
 				cpu->regs.byteregs[regbl] = 4; //else regs.byteregs[regbl] = 0;
 				cpu->regs.byteregs[regdl] = 2;
 			}
-			else cpu->regs.byteregs[regdl] = biosdisk_gethdcount();
+			else cpu->regs.byteregs[regdl] = biosdisk_gethdcount(biosdisk);
 		}
 		else {
 			cpu->cf = 1;
@@ -209,21 +256,21 @@ void biosdisk_int13h(CPU_t* cpu, uint8_t intnum) {
 	default:
 		cpu->cf = 1;
 	}
-	lastah = cpu->regs.byteregs[regah];
-	lastcf = cpu->cf;
+	biosdisk->lastah = cpu->regs.byteregs[regah];
+	biosdisk->lastcf = cpu->cf;
 	if (cpu->regs.byteregs[regdl] & 0x80) cpu_write(cpu, 0x474, cpu->regs.byteregs[regah]);
 }
 
-uint8_t biosdisk_gethdcount() {
+uint8_t biosdisk_gethdcount(BIOSDISK_t* biosdisk) {
 	uint8_t ret = 0, i;
 
 	for (i = 2; i < 4; i++) {
-		if (biosdisk[i].inserted) ret++;
+		if (biosdisk->disk[i].inserted) ret++;
 	}
 	return ret;
 }
 
-void biosdisk_init(CPU_t* cpu) {
-	cpu_registerIntCallback(cpu, 0x13, biosdisk_int13h);
-	cpu_registerIntCallback(cpu, 0x19, biosdisk_int19h);
+void biosdisk_init(BIOSDISK_t* biosdisk, CPU_t* cpu) {
+	cpu_registerIntCallback(cpu, 0x13, (void*)biosdisk_int13h, biosdisk);
+	cpu_registerIntCallback(cpu, 0x19, (void*)biosdisk_int19h, biosdisk);
 }
@@ -13,16 +13,24 @@ typedef struct {
 	uint16_t heads;
 	uint8_t inserted;
 	char* filename;
+	FILE* overlay; //when set, sector writes go here instead of the image
+	uint8_t* written; //bitmap of sectors that have been written to the overlay
 } DISK_t;
 
-uint8_t biosdisk_insert(CPU_t* cpu, uint8_t drivenum, char* filename);
-void biosdisk_eject(CPU_t* cpu, uint8_t drivenum);
-void biosdisk_int13h(CPU_t* cpu, uint8_t intnum);
-void biosdisk_int19h(CPU_t* cpu, uint8_t intnum);
-uint8_t biosdisk_gethdcount();
-void biosdisk_init(CPU_t* cpu);
+typedef struct {
+	DISK_t disk[4];
+	uint8_t sectbuf[512];
+	uint8_t bootdrive;
+	uint8_t lastah;
+	uint8_t lastcf;
+} BIOSDISK_t;
 
-extern uint8_t bootdrive;
-extern DISK_t biosdisk[4];
+uint8_t biosdisk_insert(BIOSDISK_t* biosdisk, CPU_t* cpu, uint8_t drivenum, char* filename);
+void biosdisk_eject(BIOSDISK_t* biosdisk, CPU_t* cpu, uint8_t drivenum);
+uint8_t biosdisk_overlay(BIOSDISK_t* biosdisk, uint8_t drivenum, char* filename);
+void biosdisk_int13h(CPU_t* cpu, uint8_t intnum, BIOSDISK_t* biosdisk);
+void biosdisk_int19h(CPU_t* cpu, uint8_t intnum, BIOSDISK_t* biosdisk);
+uint8_t biosdisk_gethdcount(BIOSDISK_t* biosdisk);
+void biosdisk_init(BIOSDISK_t* biosdisk, CPU_t* cpu);
 
 #endif
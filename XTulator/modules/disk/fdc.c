@@ -418,7 +418,7 @@ int fdc_insert(FDC_t* fdc, uint8_t num, char* dfile) {
 	return 0;
 }
 
-int fdc_init(FDC_t* fdc, CPU_t* cpu, I8259_t* i8259, I8237_t* i8237) {
+int fdc_init(FDC_t* fdc, CPU_t* cpu, I8259_t* i8259, I8237_t* i8237, PORTS_t* ports, TIMING_t* timing) {
 	memset(fdc, 0, sizeof(FDC_t));
 
 	fdc->st[0] = FDC_ST0_NR;
@@ -429,9 +429,9 @@ int fdc_init(FDC_t* fdc, CPU_t* cpu, I8259_t* i8259, I8237_t* i8237) {
 	fdc->irq = 6;
 	fdc->dma = 2;
 
-	fdc->timerseek = timing_addTimer(fdc_move, fdc, 50, TIMING_ENABLED);
-	fdc->timerread = timing_addTimer(fdc_transfersector, fdc, 500000 / 8, TIMING_ENABLED);
-	ports_cbRegister(0x3F0, 8, (void*)fdc_read, NULL, (void*)fdc_write, NULL, fdc);
+	fdc->timerseek = timing_addTimer(timing, fdc_move, fdc, 50, TIMING_ENABLED);
+	fdc->timerread = timing_addTimer(timing, fdc_transfersector, fdc, 500000 / 8, TIMING_ENABLED);
+	ports_cbRegister(ports, 0x3F0, 8, (void*)fdc_read, NULL, (void*)fdc_write, NULL, fdc);
 
 	return 0;
 }
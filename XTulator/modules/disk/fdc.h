@@ -6,6 +6,7 @@
 #include "../../cpu/cpu.h"
 #include "../../chipset/i8259.h"
 #include "../../chipset/i8237.h"
+#include "../../timing.h"
 
 #define FDC_FIFO_LEN					1024
 
@@ -104,6 +105,6 @@ void fdc_fifoadd(FDC_t* fdc, uint8_t value);
 void fdc_fifoclear(FDC_t* fdc);
 void fdc_reset(FDC_t* fdc);
 int fdc_insert(FDC_t* fdc, uint8_t num, char* dfile);
-int fdc_init(FDC_t* fdc, CPU_t* cpu, I8259_t* i8259, I8237_t* i8237);
+int fdc_init(FDC_t* fdc, CPU_t* cpu, I8259_t* i8259, I8237_t* i8237, PORTS_t* ports, TIMING_t* timing);
 
 #endif
@@ -30,57 +30,52 @@
 #include "../../chipset/uart.h"
 #include "mouse.h"
 
-MOUSE_t mouse_state;
-UART_t* mouse_uart = NULL;
-uint8_t mouse_buf[MOUSE_BUFFER_LEN]; //room for six events
-uint8_t mouse_bufpos = 0;
-uint8_t mouse_lasttoggle = 0;
+void mouse_addbuf(MOUSE_t* mouse, uint8_t value) {
+	if (mouse->bufpos == MOUSE_BUFFER_LEN) return;
 
-void mouse_addbuf(uint8_t value) {
-	if (mouse_bufpos == MOUSE_BUFFER_LEN) return;
-
-	mouse_buf[mouse_bufpos++] = value;
+	mouse->buf[mouse->bufpos++] = value;
 }
 
-void mouse_togglereset(void* dummy, uint8_t value) { //reset mouse, allows detection, is a callback for the UART module
-	if ((mouse_lasttoggle != 0x03) && ((value & 0x03) == 0x03)) {
-		mouse_bufpos = 0;
-		mouse_addbuf('M');
+void mouse_togglereset(MOUSE_t* mouse, uint8_t value) { //reset mouse, allows detection, is a callback for the UART module
+	if ((mouse->lasttoggle != 0x03) && ((value & 0x03) == 0x03)) {
+		mouse->bufpos = 0;
+		mouse_addbuf(mouse, 'M');
 		//printf("toggle DTR ");
 	}
-	mouse_lasttoggle = value & 0x03;
+	mouse->lasttoggle = value & 0x03;
 }
 
-void mouse_action(uint8_t action, uint8_t state, int32_t xrel, int32_t yrel) {
-	if (mouse_uart == NULL) return;
+void mouse_action(MOUSE_t* mouse, uint8_t action, uint8_t state, int32_t xrel, int32_t yrel) {
+	if (mouse->uart == NULL) return;
 	switch (action) {
 	case MOUSE_ACTION_MOVE:
 		//printf("X: %ld, Y: %ld\r\n", xrel, yrel);
 		break;
 	case MOUSE_ACTION_LEFT:
-		mouse_state.left = (state == MOUSE_PRESSED) ? 1 : 0;
+		mouse->left = (state == MOUSE_PRESSED) ? 1 : 0;
 		break;
 	case MOUSE_ACTION_RIGHT:
-		mouse_state.right = (state == MOUSE_PRESSED) ? 1 : 0;
+		mouse->right = (state == MOUSE_PRESSED) ? 1 : 0;
 		break;
 	}
 
-	mouse_addbuf(0x40 | ((yrel & 0xC0) >> 4) | ((xrel & 0xC0) >> 6) | (mouse_state.left ? 0x20 : 0x00) | (mouse_state.right ? 0x10 : 0x00));
-	mouse_addbuf(xrel & 0x3F);
-	mouse_addbuf(yrel & 0x3F);
+	mouse_addbuf(mouse, 0x40 | ((yrel & 0xC0) >> 4) | ((xrel & 0xC0) >> 6) | (mouse->left ? 0x20 : 0x00) | (mouse->right ? 0x10 : 0x00));
+	mouse_addbuf(mouse, xrel & 0x3F);
+	mouse_addbuf(mouse, yrel & 0x3F);
 }
 
-void mouse_rxpoll(void* dummy) {
-	if (mouse_uart == NULL) return;
-	if (mouse_uart->rxnew) return;
-	if (mouse_bufpos == 0) return;
+void mouse_rxpoll(MOUSE_t* mouse) {
+	if (mouse->uart == NULL) return;
+	if (mouse->uart->rxnew) return;
+	if (mouse->bufpos == 0) return;
 
-	uart_rxdata(mouse_uart, mouse_buf[0]);
-	memmove(mouse_buf, mouse_buf + 1, MOUSE_BUFFER_LEN - 1);
-	mouse_bufpos--;
+	uart_rxdata(mouse->uart, mouse->buf[0]);
+	memmove(mouse->buf, mouse->buf + 1, MOUSE_BUFFER_LEN - 1);
+	mouse->bufpos--;
 }
 
-void mouse_init(UART_t* uart) {
+void mouse_init(MOUSE_t* mouse, UART_t* uart) {
 	debug_log(DEBUG_INFO, "[MOUSE] Initializing Microsoft-compatible serial mouse\r\n");
-	mouse_uart = uart;
+	memset(mouse, 0, sizeof(MOUSE_t));
+	mouse->uart = uart;
 }
@@ -17,11 +17,15 @@
 typedef struct {
 	uint8_t left;
 	uint8_t right;
+	UART_t* uart;
+	uint8_t buf[MOUSE_BUFFER_LEN]; //room for six events
+	uint8_t bufpos;
+	uint8_t lasttoggle;
 } MOUSE_t;
 
-void mouse_togglereset(void* dummy, uint8_t value);
-void mouse_action(uint8_t action, uint8_t state, int32_t xrel, int32_t yrel);
-void mouse_rxpoll(void* dummy);
-void mouse_init(UART_t* uart);
+void mouse_togglereset(MOUSE_t* mouse, uint8_t value);
+void mouse_action(MOUSE_t* mouse, uint8_t action, uint8_t state, int32_t xrel, int32_t yrel);
+void mouse_rxpoll(MOUSE_t* mouse);
+void mouse_init(MOUSE_t* mouse, UART_t* uart);
 
 #endif
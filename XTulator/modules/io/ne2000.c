@@ -1172,7 +1172,7 @@ void ne2000_rx_frame(NE2000_t* ne2000, const void* buf, int io_len)
 
 void NE2000_tx_timer(NE2000_t* ne2000)
 {
-    timing_timerDisable(ne2000->tx_timer);
+    timing_timerDisable(ne2000->timing, ne2000->tx_timer);
 
 #ifdef DEBUG_NE2000
     debug_log(DEBUG_DETAIL, "[NE2000] tx_timer\n");
@@ -1191,25 +1191,26 @@ void NE2000_tx_timer(NE2000_t* ne2000)
 
 void NE2000_tx_event(NE2000_t* ne2000, uint64_t interval)
 {
-    timing_updateInterval(ne2000->tx_timer, interval);
-    timing_timerEnable(ne2000->tx_timer);
+    timing_updateInterval(ne2000->timing, ne2000->tx_timer, interval);
+    timing_timerEnable(ne2000->timing, ne2000->tx_timer);
 }
 
-void ne2000_init(NE2000_t* ne2000, I8259_t* i8259, uint32_t baseport, uint8_t irq, uint8_t* macaddr) {
+void ne2000_init(NE2000_t* ne2000, I8259_t* i8259, PORTS_t* ports, TIMING_t* timing, uint32_t baseport, uint8_t irq, uint8_t* macaddr) {
 #ifdef DEBUG_NE2000
     debug_log(DEBUG_INFO, "[NE2000] Initializing NE2000 Ethernet adapter at 0x%03X, IRQ %u\r\n", baseport, irq);
 #endif
     ne2000->i8259 = i8259;
+    ne2000->timing = timing;
 
-    ports_cbRegister(baseport, 0x10, ne2000_read, NULL, ne2000_write, NULL, ne2000);
-    ports_cbRegister(baseport + 0x10, 0x10, ne2000_asic_read_b, ne2000_asic_read_w, ne2000_asic_write_b, ne2000_asic_write_w, ne2000);
-    ports_cbRegister(baseport + 0x1F, 0x01, ne2000_reset_read, NULL, ne2000_reset_write, NULL, ne2000);
+    ports_cbRegister(ports, baseport, 0x10, ne2000_read, NULL, ne2000_write, NULL, ne2000);
+    ports_cbRegister(ports, baseport + 0x10, 0x10, ne2000_asic_read_b, ne2000_asic_read_w, ne2000_asic_write_b, ne2000_asic_write_w, ne2000);
+    ports_cbRegister(ports, baseport + 0x1F, 0x01, ne2000_reset_read, NULL, ne2000_reset_write, NULL, ne2000);
 
     ne2000_setirq(ne2000, irq);
     memcpy(ne2000->physaddr, macaddr, 6);
     ne2000_reset(ne2000, NE2K_RESET_HARDWARE);
     
-    ne2000->tx_timer = timing_addTimer(NE2000_tx_timer, ne2000, 1000, TIMING_DISABLED);
+    ne2000->tx_timer = timing_addTimer(timing, NE2000_tx_timer, ne2000, 1000, TIMING_DISABLED);
 }
 
 #endif
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include "../../chipset/i8259.h"
+#include "../../ports.h"
+#include "../../timing.h"
 
 #define  NE2K_MEMSIZ    (32*1024)
 #define  NE2K_MEMSTART  (16*1024)
@@ -165,11 +167,12 @@ typedef struct
 
     //XTulator stuff
     I8259_t* i8259;
+    TIMING_t* timing;
     uint32_t tx_timer;
 
 } NE2000_t;
 
-void ne2000_init(NE2000_t* ne2000, I8259_t* i8259, uint32_t baseport, uint8_t irq, uint8_t* macaddr);
+void ne2000_init(NE2000_t* ne2000, I8259_t* i8259, PORTS_t* ports, TIMING_t* timing, uint32_t baseport, uint8_t irq, uint8_t* macaddr);
 void ne2000_rx_frame(NE2000_t* ne2000, const void* buf, int io_len);
 void NE2000_tx_event(NE2000_t* ne2000, uint64_t interval);
 void NE2000_tx_timer(NE2000_t* ne2000);
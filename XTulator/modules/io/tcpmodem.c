@@ -205,7 +205,7 @@ void tcpmodem_parseAT(TCPMODEM_t* tcpmodem) {
 
 	if (tcpmodem->txbuf[2] == 'A') {
 		if (tcpmodem->ringing) {
-			timing_timerDisable(tcpmodem->ringtimer);
+			timing_timerDisable(tcpmodem->timing, tcpmodem->ringtimer);
 			tcpmodem->ringing = 0;
 			tcpmodem->escaped = 0;
 			tcpmodem->uart->msr |= 0x80; //data carrier detect
@@ -303,7 +303,7 @@ void tcpmodem_rxpoll(TCPMODEM_t* tcpmodem) {
 				tcpmodem->listening = 0;
 				tcpmodem->ringing = 1;
 				tcpmodem->ringstate = 0;
-				timing_timerEnable(tcpmodem->ringtimer);
+				timing_timerEnable(tcpmodem->timing, tcpmodem->ringtimer);
 			}
 		}
 	}
@@ -385,18 +385,19 @@ void tcpmodem_ringer(TCPMODEM_t* tcpmodem) {
 	tcpmodem_setringmsr(tcpmodem, tcpmodem->ringstate);
 }
 
-int tcpmodem_init(TCPMODEM_t* tcpmodem, UART_t* uart, uint16_t port) {
+int tcpmodem_init(TCPMODEM_t* tcpmodem, UART_t* uart, TIMING_t* timing, uint16_t port) {
 	debug_log(DEBUG_INFO, "[TCPMODEM] Initializing TCP serial modem emulator (listen on port %u)\r\n", port);
 
 	memset(tcpmodem, 0, sizeof(TCPMODEM_t));
 	tcpmodem->uart = uart;
+	tcpmodem->timing = timing;
 	tcpmodem->escaped = 1;
 	tcpmodem->echocmd = 1;
 	tcpmodem->listenport = port;
 
 	WSAStartup(MAKEWORD(2, 2), &tcpmodem->wsa);
 	tcpmodem_listen(tcpmodem, tcpmodem->listenport);
-	tcpmodem->ringtimer = timing_addTimer(tcpmodem_ringer, tcpmodem, 1, TIMING_DISABLED);
+	tcpmodem->ringtimer = timing_addTimer(timing, tcpmodem_ringer, tcpmodem, 1, TIMING_DISABLED);
 
 	return 0;
 }
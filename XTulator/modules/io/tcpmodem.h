@@ -6,6 +6,7 @@
 #ifdef ENABLE_TCP_MODEM
 #include <stdint.h>
 #include "../../chipset/uart.h"
+#include "../../timing.h"
 
 #ifdef _WIN32
 #include <WinSock2.h>
@@ -30,13 +31,14 @@ typedef struct {
 	SOCKET serversocket;
 	SOCKADDR_IN server;
 	UART_t* uart;
+	TIMING_t* timing;
 } TCPMODEM_t;
 
 int tcpmodem_connect(TCPMODEM_t* tcpmodem, char* host, uint16_t port);
 void tcpmodem_offline(TCPMODEM_t* tcpmodem);
 void tcpmodem_rxpoll(TCPMODEM_t* tcpmodem);
 void tcpmodem_tx(TCPMODEM_t* tcpmodem, uint8_t value);
-int tcpmodem_init(TCPMODEM_t* tcpmodem, UART_t* uart, uint16_t port);
+int tcpmodem_init(TCPMODEM_t* tcpmodem, UART_t* uart, TIMING_t* timing, uint16_t port);
 
 #else
 
@@ -19,12 +19,13 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stddef.h>
 #ifdef _WIN32
 #include <process.h>
 #else
 #include <pthread.h>
-pthread_t cga_renderThreadID;
 #endif
 #include "cga.h"
 #include "../../config.h"
@@ -65,35 +66,34 @@ const uint8_t cga_gfxpal[2][2][4] = { //palettes for 320x200 graphics mode
 	}
 };
 
-uint8_t cga_font[4096];
-uint32_t cga_framebuffer[400][640];
-uint16_t cga_cursorloc = 0;
-uint8_t cga_indexreg = 0, cga_datareg[256], cga_regs[16];
-uint8_t cga_cursor_blink_state = 0;
-uint8_t *cga_RAM = NULL;
-
-volatile uint8_t cga_doDraw = 1;
-
-int cga_init() {
+int cga_init(CGA_t* cga, PORTS_t* ports, MEMORY_t* memory, TIMING_t* timing) {
 	int x, y;
 
 	debug_log(DEBUG_INFO, "[CGA] Initializing CGA video device\r\n");
+	memset(cga, 0, sizeof(CGA_t));
+	cga->doDraw = 1;
 
-	if (utility_loadFile(cga_font, 4096, "roms/video/cgachar.bin")) {
+	if (utility_loadFile(cga->font, 4096, "roms/video/cgachar.bin")) {
 		debug_log(DEBUG_ERROR, "[CGA] Failed to load character generator ROM\r\n");
 		return -1;
 	}
 
+	cga->framebuffer = (uint32_t(*)[640])malloc(400 * sizeof(*cga->framebuffer));
+	if (cga->framebuffer == NULL) {
+		debug_log(DEBUG_ERROR, "[CGA] Failed to allocate frame buffer\r\n");
+		return -1;
+	}
+
 	for (y = 0; y < 400; y++) {
 		for (x = 0; x < 640; x++) {
-			cga_framebuffer[y][x] = cga_color(CGA_BLACK);
+			cga->framebuffer[y][x] = cga_color(CGA_BLACK);
 		}
 	}
-	sdlconsole_blit((uint32_t *)cga_framebuffer, 640, 400, 640 * sizeof(uint32_t));
+	sdlconsole_blit((uint32_t *)cga->framebuffer, 640, 400, 640 * sizeof(uint32_t));
 
-	timing_addTimer(cga_blinkCallback, NULL, 3, TIMING_ENABLED);
-	timing_addTimer(cga_scanlineCallback, NULL, 62800, TIMING_ENABLED);
-	timing_addTimer(cga_drawCallback, NULL, 60, TIMING_ENABLED);
+	timing_addTimer(timing, cga_blinkCallback, cga, 3, TIMING_ENABLED);
+	timing_addTimer(timing, cga_scanlineCallback, cga, 62800, TIMING_ENABLED);
+	timing_addTimer(timing, cga_drawCallback, cga, 60, TIMING_ENABLED);
 	/*
 		NOTE: CGA scanlines are clocked at 15.7 KHz. We are breaking each scanline into
 		four parts and using the last part as a very approximate horizontal retrace period.
@@ -103,67 +103,67 @@ int cga_init() {
 		See cga_scanlineCallback function for more details.
 	*/
 
-	cga_RAM = (uint8_t*)malloc(16384);
-	if (cga_RAM == NULL) {
+	cga->RAM = (uint8_t*)malloc(16384);
+	if (cga->RAM == NULL) {
 		debug_log(DEBUG_ERROR, "[CGA] Failed to allocate video memory\r\n");
 		return -1;
 	}
 
 	//TODO: error checking below
 #ifdef _WIN32
-	_beginthread(cga_renderThread, 0, NULL);
+	_beginthread(cga_renderThread, 0, cga);
 #else
-	pthread_create(&cga_renderThreadID, NULL, cga_renderThread, NULL);
+	pthread_create(&cga->renderThreadID, NULL, cga_renderThread, cga);
 #endif
 
-	ports_cbRegister(0x3D0, 16, (void*)cga_readport, NULL, (void*)cga_writeport, NULL, NULL);
-	memory_mapCallbackRegister(0xB8000, 0x4000, (void*)cga_readmemory, (void*)cga_writememory, NULL);
+	ports_cbRegister(ports, 0x3D0, 16, (void*)cga_readport, NULL, (void*)cga_writeport, NULL, cga);
+	memory_mapCallbackRegister(memory, 0xB8000, 0x4000, (void*)cga_readmemory, (void*)cga_writememory, cga);
 
 	return 0;
 }
 
-void cga_update(uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end_y) {
+void cga_update(CGA_t* cga, uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end_y) {
 	uint32_t addr, startaddr, cursorloc, cursor_x, cursor_y;
 	uint32_t scx, scy, x, y;
 	uint8_t cc, attr, fontdata, blink, mode, colorset, intensity, blinkenable;
 
-	if (cga_regs[0x8] & 0x02) { //graphics modes
-		mode = (cga_regs[0x8] & 0x10) ? CGA_MODE_GRAPHICS_HI : CGA_MODE_GRAPHICS_LO;
-		intensity = (cga_regs[0x9] & 0x10) ? 1 : 0;
-		colorset = (cga_regs[0x9] & 0x20) ? 1 : 0;
+	if (cga->regs[0x8] & 0x02) { //graphics modes
+		mode = (cga->regs[0x8] & 0x10) ? CGA_MODE_GRAPHICS_HI : CGA_MODE_GRAPHICS_LO;
+		intensity = (cga->regs[0x9] & 0x10) ? 1 : 0;
+		colorset = (cga->regs[0x9] & 0x20) ? 1 : 0;
 	} else { //text modes
-		mode = (cga_regs[0x8] & 0x01) ? CGA_MODE_TEXT_80X25 : CGA_MODE_TEXT_40X25;
-		blinkenable = (cga_regs[0x8] & 0x20) ? 1 : 0;
+		mode = (cga->regs[0x8] & 0x01) ? CGA_MODE_TEXT_80X25 : CGA_MODE_TEXT_40X25;
+		blinkenable = (cga->regs[0x8] & 0x20) ? 1 : 0;
 	}
-	startaddr = (((uint32_t)cga_datareg[0x12] & 0x3F) << 8) | (uint32_t)cga_datareg[0x13];
-	cursorloc = (((uint32_t)cga_datareg[0xE] << 8) & 0xFF00) | (uint32_t)cga_datareg[0xF];
+	startaddr = (((uint32_t)cga->datareg[0x12] & 0x3F) << 8) | (uint32_t)cga->datareg[0x13];
+	cursorloc = (((uint32_t)cga->datareg[0xE] << 8) & 0xFF00) | (uint32_t)cga->datareg[0xF];
 
 	switch (mode) {
 	case CGA_MODE_TEXT_80X25:
 		cursor_x = cursorloc % 80;
 		cursor_y = cursorloc / 80;
 		for (scy = start_y; scy <= end_y; scy++) {
-			y = scy / (((cga_datareg[0x09] & 0x1F) + 1) * 2);
+			y = scy / (((cga->datareg[0x09] & 0x1F) + 1) * 2);
 			for (scx = start_x; scx <= end_x; scx++) {
 				x = scx / 8;
 				addr = startaddr + ((y * 80) + x) * 2;
-				cc = cga_RAM[addr];
-				attr = cga_RAM[addr + 1];
+				cc = cga->RAM[addr];
+				attr = cga->RAM[addr + 1];
 				blink = attr >> 7;
 				if (blinkenable) attr &= 0x7F; //enabling text mode blink attribute limits background color selection
-				fontdata = cga_font[2048 + (cc * 8) + ((scy % 16) / 2)];
+				fontdata = cga->font[2048 + (cc * 8) + ((scy % 16) / 2)];
 				fontdata = (fontdata >> (7 - (scx % 8))) & 1;
 				if ((y == cursor_y) && (x == cursor_x) &&
-					((uint8_t)(scy % 16) >= (cga_datareg[CGA_REG_DATA_CURSOR_BEGIN] & 31) * 2) &&
-					((uint8_t)(scy % 16) <= (cga_datareg[CGA_REG_DATA_CURSOR_END] & 31) * 2) &&
-					cga_cursor_blink_state && blinkenable) { //cursor should be displayed
-					cga_framebuffer[scy][scx] = cga_color(attr & 0x0F);
+					((uint8_t)(scy % 16) >= (cga->datareg[CGA_REG_DATA_CURSOR_BEGIN] & 31) * 2) &&
+					((uint8_t)(scy % 16) <= (cga->datareg[CGA_REG_DATA_CURSOR_END] & 31) * 2) &&
+					cga->cursor_blink_state && blinkenable) { //cursor should be displayed
+					cga->framebuffer[scy][scx] = cga_color(attr & 0x0F);
 				}
 				else {
-					if (blinkenable && blink && !cga_cursor_blink_state) {
+					if (blinkenable && blink && !cga->cursor_blink_state) {
 						fontdata = 0; //all pixels in character get background color if blink attribute set and blink visible state is false
 					}
-					cga_framebuffer[scy][scx] = cga_color(fontdata ? (attr & 0x0F) : (attr >> 4));
+					cga->framebuffer[scy][scx] = cga_color(fontdata ? (attr & 0x0F) : (attr >> 4));
 				}
 			}
 		}
@@ -176,25 +176,25 @@ void cga_update(uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end
 			for (scx = start_x; scx <= end_x; scx += 2) {
 				x = scx / 16;
 				addr = startaddr + ((y * 40) + x) * 2;
-				cc = cga_RAM[addr];
-				attr = cga_RAM[addr + 1];
+				cc = cga->RAM[addr];
+				attr = cga->RAM[addr + 1];
 				blink = attr >> 7;
 				if (blinkenable) attr &= 0x7F; //enabling text mode blink attribute limits background color selection
-				fontdata = cga_font[2048 + (cc * 8) + ((scy % 16) / 2)];
+				fontdata = cga->font[2048 + (cc * 8) + ((scy % 16) / 2)];
 				fontdata = (fontdata >> (7 - ((scx / 2) % 8))) & 1;
 				if ((y == cursor_y) && (x == cursor_x) &&
-					((uint8_t)(scy % 16) >= (cga_datareg[CGA_REG_DATA_CURSOR_BEGIN] & 31) * 2) &&
-					((uint8_t)(scy % 16) <= (cga_datareg[CGA_REG_DATA_CURSOR_END] & 31) * 2) &&
-					cga_cursor_blink_state && blinkenable) {
-					cga_framebuffer[scy][scx] = cga_color(attr & 0x0F);
+					((uint8_t)(scy % 16) >= (cga->datareg[CGA_REG_DATA_CURSOR_BEGIN] & 31) * 2) &&
+					((uint8_t)(scy % 16) <= (cga->datareg[CGA_REG_DATA_CURSOR_END] & 31) * 2) &&
+					cga->cursor_blink_state && blinkenable) {
+					cga->framebuffer[scy][scx] = cga_color(attr & 0x0F);
 				}
 				else {
-					if (blinkenable && blink && !cga_cursor_blink_state) {
+					if (blinkenable && blink && !cga->cursor_blink_state) {
 						fontdata = 0;
 					}
-					cga_framebuffer[scy][scx] = cga_color(fontdata ? (attr & 0x0F) : (attr >> 4));
+					cga->framebuffer[scy][scx] = cga_color(fontdata ? (attr & 0x0F) : (attr >> 4));
 				}
-				cga_framebuffer[scy][scx + 1] = cga_framebuffer[scy][scx]; //double pixels horizontally
+				cga->framebuffer[scy][scx + 1] = cga->framebuffer[scy][scx]; //double pixels horizontally
 			}
 		}
 		break;
@@ -206,12 +206,12 @@ void cga_update(uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end
 			for (scx = start_x; scx <= end_x; scx += 2) {
 				x = scx >> 1;
 				addr = (isodd ? 0x2000 : 0x0000) + (y * 80) + (x >> 2);
-				cc = cga_RAM[addr];
+				cc = cga->RAM[addr];
 				cc = cga_gfxpal[intensity][colorset][(cc >> ((3 - (x & 3)) << 1)) & 3];
-				cga_framebuffer[scy][scx] = cga_color(cc);
-				cga_framebuffer[scy][scx + 1] = cga_framebuffer[scy][scx];
-				cga_framebuffer[scy + 1][scx + 1] = cga_framebuffer[scy][scx];
-				cga_framebuffer[scy + 1][scx] = cga_framebuffer[scy][scx];
+				cga->framebuffer[scy][scx] = cga_color(cc);
+				cga->framebuffer[scy][scx + 1] = cga->framebuffer[scy][scx];
+				cga->framebuffer[scy + 1][scx + 1] = cga->framebuffer[scy][scx];
+				cga->framebuffer[scy + 1][scx] = cga->framebuffer[scy][scx];
 			}
 		}
 		break;
@@ -225,23 +225,25 @@ void cga_update(uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end
 			for (scx = start_x; scx <= end_x; scx++) {
 				x = scx;
 				addr = (isodd ? 0x2000 : 0x0000) + (y * 80) + (x >> 3);
-				cc = cga_RAM[addr];
+				cc = cga->RAM[addr];
 				cc = ((cc >> (7 - (x & 7))) & 1) * 15;
-				cga_framebuffer[scy][scx] = cga_color(cc);
-				cga_framebuffer[scy + 1][scx] = cga_framebuffer[scy][scx];
+				cga->framebuffer[scy][scx] = cga_color(cc);
+				cga->framebuffer[scy + 1][scx] = cga->framebuffer[scy][scx];
 			}
 		}
 		break;
 	}
 
-	sdlconsole_blit((uint32_t *)cga_framebuffer, 640, 400, 640 * sizeof(uint32_t));
+	sdlconsole_blit((uint32_t *)cga->framebuffer, 640, 400, 640 * sizeof(uint32_t));
 }
 
-void cga_renderThread(void* dummy) {
+void cga_renderThread(void* udata) {
+	CGA_t* cga = (CGA_t*)udata;
+
 	while (running) {
-		if (cga_doDraw == 1) {
-			cga_update(0, 0, 639, 399);
-			cga_doDraw = 0;
+		if (cga->doDraw == 1) {
+			cga_update(cga, 0, 0, 639, 399);
+			cga->doDraw = 0;
 		}
 		else {
 			utility_sleep(1);
@@ -254,59 +256,59 @@ void cga_renderThread(void* dummy) {
 #endif
 }
 
-void cga_writeport(void* dummy, uint16_t port, uint8_t value) {
+void cga_writeport(CGA_t* cga, uint16_t port, uint8_t value) {
 #ifdef DEBUG_CGA
-	debug_log(DEBUG_DETAIL, "Write CGA port: %02X -> %03X (indexreg = %02X)\r\n", value, port, cga_indexreg);
+	debug_log(DEBUG_DETAIL, "Write CGA port: %02X -> %03X (indexreg = %02X)\r\n", value, port, cga->indexreg);
 #endif
 	switch (port) {
 	case 0x3D4:
-		cga_indexreg = value;
+		cga->indexreg = value;
 		break;
 	case 0x3D5:
-		cga_datareg[cga_indexreg] = value;
+		cga->datareg[cga->indexreg] = value;
 		break;
 	case 0x3DA:
 		break;
 	default:
-		cga_regs[port - 0x3D0] = value;
+		cga->regs[port - 0x3D0] = value;
 	}
 }
 
-uint8_t cga_readport(void* dummy, uint16_t port) {
+uint8_t cga_readport(CGA_t* cga, uint16_t port) {
 #ifdef DEBUG_CGA
-	debug_log(DEBUG_DETAIL, "Read CGA port: %03X (indexreg = %02X)\r\n", port, cga_indexreg);
+	debug_log(DEBUG_DETAIL, "Read CGA port: %03X (indexreg = %02X)\r\n", port, cga->indexreg);
 #endif
 	switch (port) {
 	case 0x3D4:
-		return cga_indexreg;
+		return cga->indexreg;
 	case 0x3D5:
-		//if ((cga_indexreg < 0x0E) || (cga_indexreg > 0x0F)) return 0xFF;
-		return cga_datareg[cga_indexreg];
+		//if ((cga->indexreg < 0x0E) || (cga->indexreg > 0x0F)) return 0xFF;
+		return cga->datareg[cga->indexreg];
 	case 0x3DA:
-		return cga_regs[0xA]; //rand() & 0xF;
+		return cga->regs[0xA]; //rand() & 0xF;
 	}
-	return cga_regs[port - 0x3D0]; //0xFF;
+	return cga->regs[port - 0x3D0]; //0xFF;
 }
 
-void cga_writememory(void* dummy, uint32_t addr, uint8_t value) {
+void cga_writememory(CGA_t* cga, uint32_t addr, uint8_t value) {
 	addr -= 0xB8000;
 	if (addr >= 16384) return;
 
-	cga_RAM[addr] = value;
+	cga->RAM[addr] = value;
 }
 
-uint8_t cga_readmemory(void* dummy, uint32_t addr) {
+uint8_t cga_readmemory(CGA_t* cga, uint32_t addr) {
 	addr -= 0xB8000;
 	if (addr >= 16384) return 0xFF;
 
-	return cga_RAM[addr];
+	return cga->RAM[addr];
 }
 
-void cga_blinkCallback(void* dummy) {
-	cga_cursor_blink_state ^= 1;
+void cga_blinkCallback(CGA_t* cga) {
+	cga->cursor_blink_state ^= 1;
 }
 
-void cga_scanlineCallback(void* dummy) {
+void cga_scanlineCallback(CGA_t* cga) {
 	/*
 		NOTE: We are only doing very approximate CGA timing. Breaking the horizontal scan into
 		four parts and setting the display inactive bit on 3DAh on the last quarter of it. Being
@@ -314,25 +316,23 @@ void cga_scanlineCallback(void* dummy) {
 
 		TODO: Look into whether this is true? So far, things are working fine.
 	*/
-	static uint16_t scanline = 0, hpart = 0;
-
-	cga_regs[0xA] = 6; //light pen bits always high
-	cga_regs[0xA] |= (hpart == 3) ? 1 : 0;
-	cga_regs[0xA] |= (scanline >= 224) ? 8 : 0;
+	cga->regs[0xA] = 6; //light pen bits always high
+	cga->regs[0xA] |= (cga->hpart == 3) ? 1 : 0;
+	cga->regs[0xA] |= (cga->scanline >= 224) ? 8 : 0;
 	
-	hpart++;
-	if (hpart == 4) {
-		/*if (scanline < 200) {
-			cga_update(0, (scanline<<1), 639, (scanline<<1)+1);
+	cga->hpart++;
+	if (cga->hpart == 4) {
+		/*if (cga->scanline < 200) {
+			cga_update(cga, 0, (cga->scanline<<1), 639, (cga->scanline<<1)+1);
 		}*/
-		hpart = 0;
-		scanline++;
+		cga->hpart = 0;
+		cga->scanline++;
 	}
-	if (scanline == 256) {
-		scanline = 0;
+	if (cga->scanline == 256) {
+		cga->scanline = 0;
 	}
 }
 
-void cga_drawCallback(void* dummy) {
-	cga_doDraw = 1;
+void cga_drawCallback(CGA_t* cga) {
+	cga->doDraw = 1;
 }
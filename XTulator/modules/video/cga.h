@@ -2,20 +2,43 @@
 #define _CGA_H_
 
 #include <stdint.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 #include "../../cpu/cpu.h"
+#include "../../memory.h"
+#include "../../ports.h"
+#include "../../timing.h"
+
+typedef struct {
+	uint8_t font[4096];
+	uint32_t (*framebuffer)[640];
+	uint16_t cursorloc;
+	uint8_t indexreg;
+	uint8_t datareg[256];
+	uint8_t regs[16];
+	uint8_t cursor_blink_state;
+	uint8_t* RAM;
+	volatile uint8_t doDraw;
+	uint16_t scanline;
+	uint16_t hpart;
+#ifndef _WIN32
+	pthread_t renderThreadID;
+#endif
+} CGA_t;
 
 extern const uint8_t cga_palette[16][3];
 
-int cga_init();
-void cga_update(uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end_y);
-void cga_writeport(void* dummy, uint16_t port, uint8_t value);
-uint8_t cga_readport(void* dummy, uint16_t port);
-void cga_blinkCallback(void* dummy);
-void cga_scanlineCallback(void* dummy);
-void cga_renderThread(void* cpu);
-void cga_writememory(void* dummy, uint32_t addr, uint8_t value);
-uint8_t cga_readmemory(void* dummy, uint32_t addr);
-void cga_drawCallback(void* dummy);
+int cga_init(CGA_t* cga, PORTS_t* ports, MEMORY_t* memory, TIMING_t* timing);
+void cga_update(CGA_t* cga, uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end_y);
+void cga_writeport(CGA_t* cga, uint16_t port, uint8_t value);
+uint8_t cga_readport(CGA_t* cga, uint16_t port);
+void cga_blinkCallback(CGA_t* cga);
+void cga_scanlineCallback(CGA_t* cga);
+void cga_renderThread(void* udata);
+void cga_writememory(CGA_t* cga, uint32_t addr, uint8_t value);
+uint8_t cga_readmemory(CGA_t* cga, uint32_t addr);
+void cga_drawCallback(CGA_t* cga);
 
 //#define cga_color(c) ((uint32_t)cga_palette[c][0] | ((uint32_t)cga_palette[c][1]<<8) | ((uint32_t)cga_palette[c][2]<<16))
 #define cga_color(c) ((uint32_t)cga_palette[c][2] | ((uint32_t)cga_palette[c][1]<<8) | ((uint32_t)cga_palette[c][0]<<16))
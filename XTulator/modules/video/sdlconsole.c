@@ -33,6 +33,7 @@
 #include "../input/mouse.h"
 #include "../../timing.h"
 #include "../../menus.h"
+#include "../../machine.h"
 
 SDL_Window *sdlconsole_window = NULL;
 SDL_Renderer *sdlconsole_renderer = NULL;
@@ -45,12 +46,14 @@ int sdlconsole_curw, sdlconsole_curh;
 
 char* sdlconsole_title;
 
+MACHINE_t* sdlconsole_useMachine = NULL;
+
 void sdlconsole_keyRepeat(void* dummy) {
 	sdlconsole_doRepeat = 1;
-	timing_updateIntervalFreq(sdlconsole_keyTimer, 15);
+	timing_updateIntervalFreq(&sdlconsole_useMachine->timing, sdlconsole_keyTimer, 15);
 }
 
-int sdlconsole_init(char *title) {
+int sdlconsole_init(char *title, MACHINE_t* machine) {
 #ifdef _WIN32
 	HWND hwnd;
 	SDL_SysWMinfo wmInfo;
@@ -59,6 +62,7 @@ int sdlconsole_init(char *title) {
 	if (SDL_Init(SDL_INIT_VIDEO)) return -1;
 
 	sdlconsole_title = title;
+	sdlconsole_useMachine = machine;
 
 	sdlconsole_window = SDL_CreateWindow(sdlconsole_title,
 		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
@@ -70,7 +74,7 @@ int sdlconsole_init(char *title) {
 		return -1;
 	}
 
-	sdlconsole_keyTimer = timing_addTimer(sdlconsole_keyRepeat, NULL, 2, TIMING_DISABLED);
+	sdlconsole_keyTimer = timing_addTimer(&machine->timing, sdlconsole_keyRepeat, NULL, 2, TIMING_DISABLED);
 
 #ifdef _WIN32
 	SDL_VERSION(&wmInfo.version);
@@ -173,7 +177,7 @@ int sdlconsole_loop() {
 		case SDL_KEYDOWN:
 #ifdef DEBUG_VGA
 			if (event.key.keysym.sym == SDLK_F12) {
-				vga_dumpregs();
+				vga_dumpregs(&sdlconsole_useMachine->vga);
 			}
 #endif
 			if (event.key.repeat) return SDLCONSOLE_EVENT_NONE;
@@ -193,8 +197,8 @@ int sdlconsole_loop() {
 					return SDLCONSOLE_EVENT_NONE;
 				} else {
 					sdlconsole_lastKey = sdlconsole_curkey;
-					timing_updateIntervalFreq(sdlconsole_keyTimer, 2);
-					timing_timerEnable(sdlconsole_keyTimer);
+					timing_updateIntervalFreq(&sdlconsole_useMachine->timing, sdlconsole_keyTimer, 2);
+					timing_timerEnable(&sdlconsole_useMachine->timing, sdlconsole_keyTimer);
 					return SDLCONSOLE_EVENT_KEY;
 				}
 			}
@@ -204,7 +208,7 @@ int sdlconsole_loop() {
 			if (event.key.keysym.sym == SDLK_LALT) sdlconsole_alt = 0;
 			sdlconsole_curkey = sdlconsole_translateScancode(event.key.keysym.sym) | 0x80;
 			if ((sdlconsole_curkey & 0x7F) == sdlconsole_lastKey) {
-				timing_timerDisable(sdlconsole_keyTimer);
+				timing_timerDisable(&sdlconsole_useMachine->timing, sdlconsole_keyTimer);
 			}
 			return (sdlconsole_curkey == 0x80) ? SDLCONSOLE_EVENT_NONE : SDLCONSOLE_EVENT_KEY;
 		case SDL_MOUSEMOTION:
@@ -213,7 +217,7 @@ int sdlconsole_loop() {
 			yrel = (event.motion.yrel < -128) ? -128 : (int8_t)event.motion.yrel;
 			yrel = (event.motion.yrel > 127) ? 127 : (int8_t)event.motion.yrel;
 			if (sdlconsole_grabbed) {
-				mouse_action(MOUSE_ACTION_MOVE, MOUSE_NEITHER, xrel, yrel);
+				mouse_action(&sdlconsole_useMachine->mouse, MOUSE_ACTION_MOVE, MOUSE_NEITHER, xrel, yrel);
 			}
 			return SDLCONSOLE_EVENT_NONE;
 		case SDL_MOUSEBUTTONDOWN:
@@ -229,7 +233,7 @@ int sdlconsole_loop() {
 				action = MOUSE_ACTION_RIGHT;
 			}
 			if (sdlconsole_grabbed) {
-				mouse_action(action, (event.button.state == SDL_PRESSED) ? MOUSE_PRESSED : MOUSE_UNPRESSED, 0, 0);
+				mouse_action(&sdlconsole_useMachine->mouse, action, (event.button.state == SDL_PRESSED) ? MOUSE_PRESSED : MOUSE_UNPRESSED, 0, 0);
 			}
 			return SDLCONSOLE_EVENT_NONE;
 		case SDL_QUIT:
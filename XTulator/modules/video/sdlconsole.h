@@ -6,6 +6,7 @@
 #else
 #include <SDL.h>
 #endif
+#include "../../machine.h"
 
 #define SDLCONSOLE_EVENT_NONE		0
 #define SDLCONSOLE_EVENT_KEY		1
@@ -13,7 +14,7 @@
 #define SDLCONSOLE_EVENT_DEBUG_1	3
 #define SDLCONSOLE_EVENT_DEBUG_2	4
 
-int sdlconsole_init(char *title);
+int sdlconsole_init(char *title, MACHINE_t* machine);
 void sdlconsole_blit(uint32_t* pixels, int w, int h, int stride);
 int sdlconsole_loop();
 uint8_t sdlconsole_getScancode();
@@ -2,7 +2,13 @@
 #define _VGA_H_
 
 #include <stdint.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 #include "../../cpu/cpu.h"
+#include "../../memory.h"
+#include "../../ports.h"
+#include "../../timing.h"
 
 typedef struct {
 	uint8_t state;
@@ -11,27 +17,60 @@ typedef struct {
 	uint8_t pal[256][3];
 } VGADAC_t;
 
-extern uint8_t vga_palette[256][3];
+typedef struct {
+	uint8_t VBIOS[32768];
+	uint8_t palette[256][3]; //R, G, B
+	VGADAC_t DAC;
+	uint32_t (*framebuffer)[1024];
+	uint32_t dots;
+	volatile uint32_t w, h;
+	uint32_t membase, memmask;
+	uint16_t cursorloc;
+	uint8_t dbl;
+	uint8_t crtci, crtcd[0x19];
+	uint8_t attri, attrd[0x15], attrflipflop, attrpal;
+	uint8_t gfxi, gfxd[0x09];
+	uint8_t seqi, seqd[0x05];
+	uint8_t misc, status0, status1;
+	uint8_t cursor_blink_state;
+	volatile uint8_t wmode, rmode, shiftmode, rotate, logicop, enableplane, readmap, scandbl, hdbl, bpp, latch[4];
+	uint8_t* RAM[4]; //4 planes
+
+	volatile uint64_t hblankstart, hblankend, hblanklen, dispinterval, hblankinterval, htotal;
+	volatile uint64_t vblankstart, vblankend, vblanklen, vblankinterval, frameinterval;
+	volatile uint8_t doRender, doBlit;
+	volatile double targetFPS;
+
+	TIMING_t* timing;
+	volatile uint32_t hblankTimer, hblankEndTimer, drawTimer;
+	volatile uint16_t curScanline;
+	uint32_t lastw, lasth;
+	double lastFPS;
+#ifndef _WIN32
+	pthread_t renderThreadID;
+#endif
+} VGA_t;
+
 extern volatile double vga_lockFPS;
 
-int vga_init();
-void vga_updateScanlineTiming();
-void vga_update(uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end_y);
-void vga_writeport(void* dummy, uint16_t port, uint8_t value);
-uint8_t vga_readport(void* dummy, uint16_t port);
-void vga_blinkCallback(void* dummy);
-void vga_hblankCallback(void* dummy);
-void vga_hblankEndCallback(void* dummy);
-void vga_drawCallback(void* dummy);
-void vga_renderThread(void* cpu);
-void vga_writememory(void* dummy, uint32_t addr, uint8_t value);
-uint8_t vga_readmemory(void* dummy, uint32_t addr);
-void vga_dumpregs();
+int vga_init(VGA_t* vga, PORTS_t* ports, MEMORY_t* memory, TIMING_t* timing);
+void vga_updateScanlineTiming(VGA_t* vga);
+void vga_update(VGA_t* vga, uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end_y);
+void vga_writeport(VGA_t* vga, uint16_t port, uint8_t value);
+uint8_t vga_readport(VGA_t* vga, uint16_t port);
+void vga_blinkCallback(VGA_t* vga);
+void vga_hblankCallback(VGA_t* vga);
+void vga_hblankEndCallback(VGA_t* vga);
+void vga_drawCallback(VGA_t* vga);
+void vga_renderThread(void* udata);
+void vga_writememory(VGA_t* vga, uint32_t addr, uint8_t value);
+uint8_t vga_readmemory(VGA_t* vga, uint32_t addr);
+void vga_dumpregs(VGA_t* vga);
 
 //#define cga_color(c) ((uint32_t)cga_palette[c][0] | ((uint32_t)cga_palette[c][1]<<8) | ((uint32_t)cga_palette[c][2]<<16))
-#define vga_color(c) ((uint32_t)vga_palette[c][2] | ((uint32_t)vga_palette[c][1]<<8) | ((uint32_t)vga_palette[c][0]<<16))
+#define vga_color(vga, c) ((uint32_t)(vga)->palette[c][2] | ((uint32_t)(vga)->palette[c][1]<<8) | ((uint32_t)(vga)->palette[c][0]<<16))
 
-#define vga_dorotate(v) ((uint8_t)((v >> vga_rotate) | (v << (8 - vga_rotate))))
+#define vga_dorotate(vga, v) ((uint8_t)((v >> (vga)->rotate) | (v << (8 - (vga)->rotate))))
 
 #define VGA_DAC_MODE_READ	0x00
 #define VGA_DAC_MODE_WRITE	0x03
@@ -34,14 +34,6 @@
 #include "modules/video/cga.h"
 #include "modules/video/vga.h"
 
-uint8_t (*ports_cbReadB[PORTS_COUNT])(void* udata, uint32_t portnum);
-uint16_t (*ports_cbReadW[PORTS_COUNT])(void* udata, uint32_t portnum);
-void (*ports_cbWriteB[PORTS_COUNT])(void* udata, uint32_t portnum, uint8_t value);
-void (*ports_cbWriteW[PORTS_COUNT])(void* udata, uint32_t portnum, uint16_t value);
-void* ports_udata[PORTS_COUNT];
-
-extern MACHINE_t machine;
-
 void port_write(CPU_t* cpu, uint16_t portnum, uint8_t value) {
 #ifdef DEBUG_PORTS
 	debug_log(DEBUG_DETAIL, "port_write @ %03X <- %02X\r\n", portnum, value);
@@ -50,8 +42,8 @@ void port_write(CPU_t* cpu, uint16_t portnum, uint8_t value) {
 	if (portnum == 0x80) {
 		debug_log(DEBUG_DETAIL, "Diagnostic port out: %02X\r\n", value);
 	}
-	if (ports_cbWriteB[portnum] != NULL) {
-		(*ports_cbWriteB[portnum])(ports_udata[portnum], portnum, value);
+	if (cpu->ports->cbWriteB[portnum] != NULL) {
+		(*cpu->ports->cbWriteB[portnum])(cpu->ports->udata[portnum], portnum, value);
 		return;
 	}
 }
@@ -61,8 +53,8 @@ void port_writew(CPU_t* cpu, uint16_t portnum, uint16_t value) {
 	if (portnum == 0x80) {
 		debug_log(DEBUG_DETAIL, "Diagnostic port out: %04X\r\n", value);
 	}
-	if (ports_cbWriteW[portnum] != NULL) {
-		(*ports_cbWriteW[portnum])(ports_udata[portnum], portnum, value);
+	if (cpu->ports->cbWriteW[portnum] != NULL) {
+		(*cpu->ports->cbWriteW[portnum])(cpu->ports->udata[portnum], portnum, value);
 		return;
 	}
 	port_write(cpu, portnum, (uint8_t)value);
@@ -74,8 +66,8 @@ uint8_t port_read(CPU_t* cpu, uint16_t portnum) {
 	debug_log(DEBUG_DETAIL, "port_read @ %03X\r\n", portnum);
 #endif
 	portnum &= 0x0FFF;
-	if (ports_cbReadB[portnum] != NULL) {
-		return (*ports_cbReadB[portnum])(ports_udata[portnum], portnum);
+	if (cpu->ports->cbReadB[portnum] != NULL) {
+		return (*cpu->ports->cbReadB[portnum])(cpu->ports->udata[portnum], portnum);
 	}
 
 	return 0xFF;
@@ -84,35 +76,35 @@ uint8_t port_read(CPU_t* cpu, uint16_t portnum) {
 uint16_t port_readw(CPU_t* cpu, uint16_t portnum) {
 	uint16_t ret;
 	portnum &= 0x0FFF;
-	if (ports_cbReadW[portnum] != NULL) {
-		return (*ports_cbReadW[portnum])(ports_udata[portnum], portnum);
+	if (cpu->ports->cbReadW[portnum] != NULL) {
+		return (*cpu->ports->cbReadW[portnum])(cpu->ports->udata[portnum], portnum);
 	}
 	ret = port_read(cpu, portnum);
 	ret |= (uint16_t)port_read(cpu, portnum + 1) << 8;
 	return ret;
 }
 
-void ports_cbRegister(uint32_t start, uint32_t count, uint8_t (*readb)(void*, uint32_t), uint16_t (*readw)(void*, uint32_t), void (*writeb)(void*, uint32_t, uint8_t), void (*writew)(void*, uint32_t, uint16_t), void* udata) {
+void ports_cbRegister(PORTS_t* ports, uint32_t start, uint32_t count, uint8_t (*readb)(void*, uint32_t), uint16_t (*readw)(void*, uint32_t), void (*writeb)(void*, uint32_t, uint8_t), void (*writew)(void*, uint32_t, uint16_t), void* udata) {
 	uint32_t i;
 	for (i = 0; i < count; i++) {
 		if ((start + i) >= PORTS_COUNT) {
 			break;
 		}
-		ports_cbReadB[start + i] = readb;
-		ports_cbReadW[start + i] = readw;
-		ports_cbWriteB[start + i] = writeb;
-		ports_cbWriteW[start + i] = writew;
-		ports_udata[start + i] = udata;
+		ports->cbReadB[start + i] = readb;
+		ports->cbReadW[start + i] = readw;
+		ports->cbWriteB[start + i] = writeb;
+		ports->cbWriteW[start + i] = writew;
+		ports->udata[start + i] = udata;
 	}
 }
 
-void ports_init() {
+void ports_init(PORTS_t* ports) {
 	uint32_t i;
 	for (i = 0; i < PORTS_COUNT; i++) {
-		ports_cbReadB[i] = NULL;
-		ports_cbReadW[i] = NULL;
-		ports_cbWriteB[i] = NULL;
-		ports_cbWriteW[i] = NULL;
-		ports_udata[i] = NULL;
+		ports->cbReadB[i] = NULL;
+		ports->cbReadW[i] = NULL;
+		ports->cbWriteB[i] = NULL;
+		ports->cbWriteW[i] = NULL;
+		ports->udata[i] = NULL;
 	}
 }
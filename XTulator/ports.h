@@ -5,13 +5,15 @@
 
 #define PORTS_COUNT 0x1000
 
-extern uint8_t(*ports_cbReadB[PORTS_COUNT])(void* udata, uint32_t portnum);
-extern uint16_t(*ports_cbReadW[PORTS_COUNT])(void* udata, uint32_t portnum);
-extern void (*ports_cbWriteB[PORTS_COUNT])(void* udata, uint32_t portnum, uint8_t value);
-extern void (*ports_cbWriteW[PORTS_COUNT])(void* udata, uint32_t portnum, uint16_t value);
-extern void* ports_udata[PORTS_COUNT];
+typedef struct {
+	uint8_t(*cbReadB[PORTS_COUNT])(void* udata, uint32_t portnum);
+	uint16_t(*cbReadW[PORTS_COUNT])(void* udata, uint32_t portnum);
+	void (*cbWriteB[PORTS_COUNT])(void* udata, uint32_t portnum, uint8_t value);
+	void (*cbWriteW[PORTS_COUNT])(void* udata, uint32_t portnum, uint16_t value);
+	void* udata[PORTS_COUNT];
+} PORTS_t;
 
-void ports_cbRegister(uint32_t start, uint32_t count, uint8_t(*readb)(void*, uint32_t), uint16_t(*readw)(void*, uint32_t), void (*writeb)(void*, uint32_t, uint8_t), void (*writew)(void*, uint32_t, uint16_t), void* udata);
-void ports_init();
+void ports_cbRegister(PORTS_t* ports, uint32_t start, uint32_t count, uint8_t(*readb)(void*, uint32_t), uint16_t(*readw)(void*, uint32_t), void (*writeb)(void*, uint32_t, uint8_t), void (*writew)(void*, uint32_t, uint16_t), void* udata);
+void ports_init(PORTS_t* ports);
 
 #endif
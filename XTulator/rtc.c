@@ -130,7 +130,7 @@ void rtc_write(void* dummy, uint16_t addr, uint8_t value) {
 
 }
 
-void rtc_init() {
+void rtc_init(PORTS_t* ports) {
 	debug_log(DEBUG_INFO, "[RTC] Initializing real time clock\r\n");
-	ports_cbRegister(0x240, 0x18, (void*)rtc_read, NULL, (void*)rtc_write, NULL, NULL);
+	ports_cbRegister(ports, 0x240, 0x18, (void*)rtc_read, NULL, (void*)rtc_write, NULL, NULL);
 }
@@ -21,6 +21,7 @@
 #include <Windows.h>
 #else
 #include <sys/time.h>
+#include <unistd.h>
 #endif
 #include <stdio.h>
 #include <stdint.h>
@@ -29,12 +30,9 @@
 #include "timing.h"
 #include "debuglog.h"
 
-uint64_t timing_cur;
-uint64_t timing_freq;
-TIMER* timers = NULL;
-uint32_t timers_count = 0;
+uint64_t timing_freq; //rate of the host clock, the same for every machine
 
-int timing_init() {
+int timing_init(TIMING_t* timing) {
 #ifdef _WIN32
 	LARGE_INTEGER freq;
 	//TODO: error handling
@@ -43,124 +41,133 @@ int timing_init() {
 #else
 	timing_freq = 1000000;
 #endif
+	timing->timers = NULL;
+	timing->count = 0;
+	timing->cur = timing_getCur();
 	return 0;
 }
 
-void timing_loop() {
+void timing_loop(TIMING_t* timing) {
+	TIMER* timer;
 	uint32_t i;
-#ifdef _WIN32
-	LARGE_INTEGER cur;
-	//TODO: error handling
-	QueryPerformanceCounter(&cur);
-	timing_cur = (uint64_t)cur.QuadPart;
-#else
-	struct timeval tv;
-	gettimeofday(&tv, NULL);
-	timing_cur = (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
-#endif
-	for (i = 0; i < timers_count; i++) {
-		if (timing_cur >= (timers[i].previous + timers[i].interval)) {
-			if (timers[i].enabled != TIMING_DISABLED) {
-				if (timers[i].callback != NULL) {
-					(*timers[i].callback)(timers[i].data);
+
+	timing->cur = timing_getCur();
+	for (i = 0; i < timing->count; i++) {
+		timer = &timing->timers[i];
+		if (timing->cur >= (timer->previous + timer->interval)) {
+			if (timer->enabled != TIMING_DISABLED) {
+				if (timer->callback != NULL) {
+					(*timer->callback)(timer->data);
+					timer = &timing->timers[i]; //the callback could have added a timer and moved the array
 				}
-				timers[i].previous += timers[i].interval;
-				if ((timing_cur - timers[i].previous) >= (timers[i].interval * 100)) {
-					timers[i].previous = timing_cur;
+				timer->previous += timer->interval;
+				if ((timing->cur - timer->previous) >= (timer->interval * 100)) {
+					timer->previous = timing->cur;
 				}
 			}
 		}
 	}
 }
 
+//Sleep the host for up to maxus microseconds, unless a timer is already due. Called while the emulated CPU is halted,
+//after the sleep the timers that came due are caught up on by the following passes through timing_loop.
+void timing_idle(TIMING_t* timing, uint32_t maxus) {
+	uint64_t cur;
+	uint32_t i;
+
+	cur = timing_getCur();
+	for (i = 0; i < timing->count; i++) {
+		if ((timing->timers[i].enabled != TIMING_DISABLED) && ((timing->timers[i].previous + timing->timers[i].interval) <= cur)) {
+			return;
+		}
+	}
+
+#ifdef _WIN32
+	Sleep((maxus + 999) / 1000);
+#else
+	usleep(maxus);
+#endif
+}
+
 //Just some code for performance testing
 void timing_speedTest() {
 #ifdef _WIN32
-	uint64_t start, i;
-	LARGE_INTEGER cur;
+	uint64_t start, cur, i;
+	LARGE_INTEGER qpc;
 	//TODO: error handling
-	QueryPerformanceCounter(&cur);
-	start = (uint64_t)cur.QuadPart;
+	QueryPerformanceCounter(&qpc);
+	start = (uint64_t)qpc.QuadPart;
 
 	i = 0;
 	while (1) {
-		QueryPerformanceCounter(&cur);
-		timing_cur = (uint64_t)cur.QuadPart;
+		QueryPerformanceCounter(&qpc);
+		cur = (uint64_t)qpc.QuadPart;
 		i++;
-		if ((timing_cur - start) >= timing_freq) break;
+		if ((cur - start) >= timing_freq) break;
 	}
 	printf("%llu calls to QPC in 1 second\r\n", i);
 #endif
 }
 
-uint32_t timing_addTimerUsingInterval(void* callback, void* data, uint64_t interval, uint8_t enabled) {
+uint32_t timing_addTimerUsingInterval(TIMING_t* timing, void* callback, void* data, uint64_t interval, uint8_t enabled) {
 	TIMER* temp;
 	uint32_t ret;
-#ifdef _WIN32
-	LARGE_INTEGER cur;
 
-	//TODO: error handling
-	QueryPerformanceCounter(&cur);
-	timing_cur = (uint64_t)cur.QuadPart;
-#else
-	struct timeval tv;
-	gettimeofday(&tv, NULL);
-	timing_cur = (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
-#endif
-	temp = (TIMER*)realloc(timers, (size_t)sizeof(TIMER) * (timers_count + 1));
+	timing->cur = timing_getCur();
+	temp = (TIMER*)realloc(timing->timers, (size_t)sizeof(TIMER) * (timing->count + 1));
 	if (temp == NULL) {
 		//TODO: error handling
 		return TIMING_ERROR; //NULL;
 	}
-	timers = temp;
+	timing->timers = temp;
 
-	timers[timers_count].previous = timing_cur;
-	timers[timers_count].interval = interval;
-	timers[timers_count].callback = callback;
-	timers[timers_count].data = data;
-	timers[timers_count].enabled = enabled;
+	timing->timers[timing->count].previous = timing->cur;
+	timing->timers[timing->count].interval = interval;
+	timing->timers[timing->count].callback = callback;
+	timing->timers[timing->count].data = data;
+	timing->timers[timing->count].enabled = enabled;
 
-	ret = timers_count;
-	timers_count++;
+	ret = timing->count;
+	timing->count++;
 
 	return ret;
 }
 
-uint32_t timing_addTimer(void* callback, void* data, double frequency, uint8_t enabled) {
-	return timing_addTimerUsingInterval(callback, data, (uint64_t)((double)timing_freq / frequency), enabled);
+uint32_t timing_addTimer(TIMING_t* timing, void* callback, void* data, double frequency, uint8_t enabled) {
+	return timing_addTimerUsingInterval(timing, callback, data, (uint64_t)((double)timing_freq / frequency), enabled);
 }
 
-void timing_updateInterval(uint32_t tnum, uint64_t interval) {
-	if (tnum >= timers_count) {
+void timing_updateInterval(TIMING_t* timing, uint32_t tnum, uint64_t interval) {
+	if (tnum >= timing->count) {
 		debug_log(DEBUG_ERROR, "[ERROR] timing_updateInterval() asked to operate on invalid timer\r\n");
 		return;
 	}
-	timers[tnum].interval = interval;
+	timing->timers[tnum].interval = interval;
 }
 
-void timing_updateIntervalFreq(uint32_t tnum, double frequency) {
-	if (tnum >= timers_count) {
+void timing_updateIntervalFreq(TIMING_t* timing, uint32_t tnum, double frequency) {
+	if (tnum >= timing->count) {
 		debug_log(DEBUG_ERROR, "[ERROR] timing_updateIntervalFreq() asked to operate on invalid timer\r\n");
 		return;
 	}
-	timers[tnum].interval = (uint64_t)((double)timing_freq / frequency);
+	timing->timers[tnum].interval = (uint64_t)((double)timing_freq / frequency);
 }
 
-void timing_timerEnable(uint32_t tnum) {
-	if (tnum >= timers_count) {
+void timing_timerEnable(TIMING_t* timing, uint32_t tnum) {
+	if (tnum >= timing->count) {
 		debug_log(DEBUG_ERROR, "[ERROR] timing_timerEnable() asked to operate on invalid timer\r\n");
 		return;
 	}
-	timers[tnum].enabled = TIMING_ENABLED;
-	timers[tnum].previous = timing_getCur();
+	timing->timers[tnum].enabled = TIMING_ENABLED;
+	timing->timers[tnum].previous = timing_getCur();
 }
 
-void timing_timerDisable(uint32_t tnum) {
-	if (tnum >= timers_count) {
+void timing_timerDisable(TIMING_t* timing, uint32_t tnum) {
+	if (tnum >= timing->count) {
 		debug_log(DEBUG_ERROR, "[ERROR] timing_timerDisable() asked to operate on invalid timer\r\n");
 		return;
 	}
-	timers[tnum].enabled = TIMING_DISABLED;
+	timing->timers[tnum].enabled = TIMING_DISABLED;
 }
 
 uint64_t timing_getFreq() {
@@ -173,12 +180,10 @@ uint64_t timing_getCur() {
 
 	//TODO: error handling
 	QueryPerformanceCounter(&cur);
-	timing_cur = (uint64_t)cur.QuadPart;
+	return (uint64_t)cur.QuadPart;
 #else
 	struct timeval tv;
 	gettimeofday(&tv, NULL);
-	timing_cur = (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+	return (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
 #endif
-
-	return timing_cur;
 }
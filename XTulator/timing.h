@@ -11,24 +11,30 @@ typedef struct TIMER_s {
 	void* data;
 } TIMER;
 
+typedef struct {
+	TIMER* timers;
+	uint32_t count;
+	uint64_t cur; //host time as of the last pass through timing_loop
+} TIMING_t;
+
 #define TIMING_ENABLED	1
 #define TIMING_DISABLED	0
 #define TIMING_ERROR 0xFFFFFFFF
 
 #define TIMING_RINGSIZE	1024
 
-int timing_init();
-void timing_loop();
-uint32_t timing_addTimer(void* callback, void* data, double frequency, uint8_t enabled);
-void timing_updateIntervalFreq(uint32_t tnum, double frequency);
-void timing_updateInterval(uint32_t tnum, uint64_t interval);
+int timing_init(TIMING_t* timing);
+void timing_loop(TIMING_t* timing);
+uint32_t timing_addTimer(TIMING_t* timing, void* callback, void* data, double frequency, uint8_t enabled);
+void timing_updateIntervalFreq(TIMING_t* timing, uint32_t tnum, double frequency);
+void timing_updateInterval(TIMING_t* timing, uint32_t tnum, uint64_t interval);
 void timing_speedTest();
-void timing_timerEnable(uint32_t tnum);
-void timing_timerDisable(uint32_t tnum);
+void timing_idle(TIMING_t* timing, uint32_t maxus);
+void timing_timerEnable(TIMING_t* timing, uint32_t tnum);
+void timing_timerDisable(TIMING_t* timing, uint32_t tnum);
 uint64_t timing_getFreq();
 uint64_t timing_getCur();
 
-extern uint64_t timing_cur;
 extern uint64_t timing_freq;
 
 #endif